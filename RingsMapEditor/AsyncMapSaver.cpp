@@ -0,0 +1,176 @@
+#include "pch.h"
+#include <algorithm>
+#include "AsyncMapSaver.h"
+#include "JsonMapWriter.h"
+
+#include <chrono>
+
+AsyncMapSaver::AsyncMapSaver()
+{
+	m_worker = std::thread(&AsyncMapSaver::WorkerLoop, this);
+}
+
+AsyncMapSaver::~AsyncMapSaver()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_requestsMutex);
+		m_stopping = true;
+	}
+	m_requestsCondition.notify_one();
+
+	// Pending saves are still written before unloading
+	if (m_worker.joinable())
+		m_worker.join();
+}
+
+//Plain data copies of the scene objects.
+//Object::Clone() can't be used here: it respawns mesh instances, and a copied Mesh still owning the
+//actor pointer would destroy the live actor when the snapshot is released on the worker thread.
+std::vector<std::shared_ptr<Object>> AsyncMapSaver::TakeSnapshot(const std::vector<std::shared_ptr<Object>>& _objects)
+{
+	std::vector<std::shared_ptr<Object>> snapshot;
+	snapshot.reserve(_objects.size());
+
+	for (const std::shared_ptr<Object>& object : _objects)
+	{
+		if (!object)
+			continue;
+
+		switch (object->objectType)
+		{
+		case ObjectType::Mesh:
+		{
+			std::shared_ptr<Mesh> mesh = MakePooled<Mesh>(static_cast<const Mesh&>(*object));
+			mesh->instance = nullptr;
+			snapshot.push_back(mesh);
+			break;
+		}
+		case ObjectType::TriggerVolume:
+		{
+			std::shared_ptr<TriggerVolume> triggerVolume = nullptr;
+			if (static_cast<const TriggerVolume&>(*object).triggerVolumeType == TriggerVolumeType::Box)
+				triggerVolume = MakePooled<TriggerVolume_Box>(static_cast<const TriggerVolume_Box&>(*object));
+			else if (static_cast<const TriggerVolume&>(*object).triggerVolumeType == TriggerVolumeType::Cylinder)
+				triggerVolume = MakePooled<TriggerVolume_Cylinder>(static_cast<const TriggerVolume_Cylinder&>(*object));
+			else
+				break;
+
+			triggerVolume->onTouchCallback = CloneCallback(triggerVolume->onTouchCallback);
+			snapshot.push_back(triggerVolume);
+			break;
+		}
+		case ObjectType::Checkpoint:
+		{
+			std::shared_ptr<Checkpoint> checkpoint = MakePooled<Checkpoint>(static_cast<const Checkpoint&>(*object));
+			checkpoint->triggerVolume.onTouchCallback = CloneCallback(checkpoint->triggerVolume.onTouchCallback);
+			snapshot.push_back(checkpoint);
+			break;
+		}
+		case ObjectType::Ring:
+		{
+			// Copies don't take the mesh actor and copy the ring's own parts, the shared ones are never edited in place
+			snapshot.push_back(MakePooled<Ring>(static_cast<const Ring&>(*object)));
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	return snapshot;
+}
+
+void AsyncMapSaver::Save(MapSaveRequest _request)
+{
+	m_inFlight++;
+
+	{
+		std::lock_guard<std::mutex> lock(m_requestsMutex);
+
+		// A newer snapshot for a file that hasn't been written yet replaces the queued one
+		auto it = std::find_if(m_requests.begin(), m_requests.end(), [&_request](const MapSaveRequest& _queued) {
+			return _queued.filePath == _request.filePath;
+			});
+
+		if (it != m_requests.end())
+		{
+			*it = std::move(_request);
+			m_inFlight--;
+		}
+		else
+		{
+			m_requests.push_back(std::move(_request));
+		}
+	}
+
+	m_requestsCondition.notify_one();
+}
+
+bool AsyncMapSaver::PollResult(MapSaveResult& _out)
+{
+	return m_results.Pop(_out);
+}
+
+bool AsyncMapSaver::IsBusy() const
+{
+	return m_inFlight.load() > 0;
+}
+
+void AsyncMapSaver::WorkerLoop()
+{
+	while (true)
+	{
+		MapSaveRequest request;
+		{
+			std::unique_lock<std::mutex> lock(m_requestsMutex);
+			m_requestsCondition.wait(lock, [this]() { return m_stopping || !m_requests.empty(); });
+
+			if (m_requests.empty())
+				return;
+
+			request = std::move(m_requests.front());
+			m_requests.pop_front();
+		}
+
+		MapSaveResult result = Write(request);
+
+		// The snapshot is released here, on the worker, so freeing a large scene doesn't hitch the game thread either
+		request.snapshot.clear();
+
+		if (!m_results.Push(std::move(result)))
+			LOG("[ERROR]Save result queue is full, result for {} dropped", request.filePath.string());
+
+		m_inFlight--;
+	}
+}
+
+MapSaveResult AsyncMapSaver::Write(const MapSaveRequest& _request)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	MapSaveResult result;
+	result.filePath = _request.filePath;
+	result.objectCount = _request.snapshot.size();
+
+	std::filesystem::path tempPath = _request.filePath;
+	tempPath += ".tmp";
+
+	bool written = (_request.format == MapFileFormat::Binary)
+		? BinaryMap::Save(tempPath, _request.snapshot, _request.parents)
+		: JsonMapWriter::Save(tempPath, _request.snapshot, _request.parents, _request.prettyJson);
+
+	std::error_code error;
+	if (written)
+	{
+		std::filesystem::rename(tempPath, _request.filePath, error);
+		result.success = !error;
+		if (error)
+			LOG("[ERROR]Could not move {} into place: {}", tempPath.string(), error.message());
+	}
+
+	if (!result.success)
+		std::filesystem::remove(tempPath, error);
+
+	result.durationMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
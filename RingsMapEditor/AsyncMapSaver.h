@@ -0,0 +1,88 @@
+#pragma once
+#include "BinaryMap.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+//Single-producer single-consumer ring buffer, Push() and Pop() never block or lock
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+public:
+	bool Push(T _value) {
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		size_t next = (tail + 1) % Capacity;
+		if (next == m_head.load(std::memory_order_acquire))
+			return false;
+
+		m_items[tail] = std::move(_value);
+		m_tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	bool Pop(T& _out) {
+		size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+			return false;
+
+		_out = std::move(m_items[head]);
+		m_head.store((head + 1) % Capacity, std::memory_order_release);
+		return true;
+	}
+
+private:
+	std::array<T, Capacity> m_items;
+	std::atomic<size_t> m_head = 0;
+	std::atomic<size_t> m_tail = 0;
+};
+
+struct MapSaveRequest
+{
+	std::filesystem::path filePath;
+	MapFileFormat format = MapFileFormat::Json;
+	bool prettyJson = true;
+	std::vector<std::shared_ptr<Object>> snapshot;
+	std::vector<int32_t> parents; // by index in snapshot, empty when no object has a parent
+};
+
+struct MapSaveResult
+{
+	std::filesystem::path filePath;
+	bool success = false;
+	size_t objectCount = 0;
+	float durationMs = 0.f;
+};
+
+//Writes maps on a worker thread.
+//The caller hands over detached objects (ObjectManager::GetSnapshot() or TakeSnapshot()), so the scene can keep being edited while a save is in flight.
+//Files are written to "<name>.tmp" then renamed over the target, a crash mid-save never leaves a truncated map.
+//Results come back through a lock-free queue drained by PollResult() on the UI side.
+class AsyncMapSaver
+{
+public:
+	AsyncMapSaver();
+	~AsyncMapSaver();
+
+	static std::vector<std::shared_ptr<Object>> TakeSnapshot(const std::vector<std::shared_ptr<Object>>& _objects);
+
+	void Save(MapSaveRequest _request);
+	bool PollResult(MapSaveResult& _out);
+	bool IsBusy() const;
+
+private:
+	void WorkerLoop();
+	MapSaveResult Write(const MapSaveRequest& _request);
+
+	std::thread m_worker;
+	std::mutex m_requestsMutex;
+	std::condition_variable m_requestsCondition;
+	std::deque<MapSaveRequest> m_requests;
+	bool m_stopping = false;
+
+	std::atomic<int> m_inFlight = 0;
+	SpscQueue<MapSaveResult, 16> m_results;
+};
@@ -0,0 +1,800 @@
+#include "pch.h"
+#include <algorithm>
+#include "BinaryMap.h"
+#include "FieldCodec.h"
+#include "MappedFile.h"
+#include "PrefabLibrary.h"
+
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+namespace
+{
+	constexpr uint64_t PrefabField = GetFieldMask<Ring>({ "prefab" });
+	constexpr uint64_t ObjectTypeField = GetFieldMask<Ring>({ "objectType" });
+	constexpr uint64_t NameField = GetFieldMask<Ring>({ "name" });
+	constexpr uint64_t ScaleField = GetFieldMask<Ring>({ "scale" });
+
+	Vector ReadVector(const float _in[3])
+	{
+		return Vector(_in[0], _in[1], _in[2]);
+	}
+
+	Rotator ReadRotator(const int32_t _in[3])
+	{
+		return Rotator(_in[0], _in[1], _in[2]);
+	}
+
+	template <typename T>
+	void AppendRecord(std::vector<uint8_t>& _buffer, ObjectType _objectType, uint8_t _subType, const T& _record)
+	{
+		RmeRecordHeader header{ static_cast<uint8_t>(_objectType), _subType, static_cast<uint16_t>(sizeof(T)) };
+		size_t start = _buffer.size();
+		_buffer.resize(start + sizeof(RmeRecordHeader) + sizeof(T));
+		std::memcpy(_buffer.data() + start, &header, sizeof(RmeRecordHeader));
+		std::memcpy(_buffer.data() + start + sizeof(RmeRecordHeader), &_record, sizeof(T));
+	}
+
+	//Header, then what _writeBody writes with the string table, the size is filled in once the body is written
+	template <typename WriteBody>
+	void AppendFieldRecord(std::vector<uint8_t>& _buffer, ObjectType _objectType, uint8_t _subType, RmeStringTable& _strings, WriteBody&& _writeBody)
+	{
+		size_t start = _buffer.size();
+		_buffer.resize(start + sizeof(RmeRecordHeader));
+
+		FieldWriter writer(_buffer, &_strings);
+		_writeBody(writer);
+
+		RmeRecordHeader header{ static_cast<uint8_t>(_objectType), _subType, static_cast<uint16_t>(_buffer.size() - start - sizeof(RmeRecordHeader)) };
+		std::memcpy(_buffer.data() + start, &header, sizeof(RmeRecordHeader));
+	}
+
+	bool AppendObjectRecord(std::vector<uint8_t>& _buffer, const Object& _object, RmeStringTable& _strings)
+	{
+		return VisitObject(_object, [&](const auto& _concreteObject) {
+			using T = std::remove_cvref_t<decltype(_concreteObject)>;
+
+			uint8_t subType = 0;
+			if constexpr (std::is_base_of_v<TriggerVolume, T>)
+				subType = static_cast<uint8_t>(_concreteObject.triggerVolumeType);
+			else if constexpr (std::is_same_v<T, Ring>)
+				subType = static_cast<uint8_t>(RmeRingRecord::Full);
+
+			AppendFieldRecord(_buffer, _object.objectType, subType, _strings, [&](FieldWriter& _writer) {
+				_writer.WriteFields(_concreteObject, AllFieldsMask<T>);
+				});
+			return true;
+			}, false);
+	}
+
+	//LEB128 : 7 bits per byte, low bits first, the high bit is set on every byte but the last
+	void WriteVarint(FieldWriter& _writer, uint64_t _value)
+	{
+		do
+		{
+			uint8_t byte = static_cast<uint8_t>(_value & 0x7F);
+			_value >>= 7;
+			if (_value)
+				byte |= 0x80;
+			_writer.Write(byte);
+		} while (_value);
+	}
+
+	bool ReadVarint(FieldReader& _reader, uint64_t& _out)
+	{
+		_out = 0;
+		for (uint32_t shift = 0; shift < 64; shift += 7)
+		{
+			uint8_t byte = 0;
+			if (!_reader.Read(byte))
+				return false;
+
+			_out |= static_cast<uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	//Writes consecutive rings made from the same prefab into one PrefabInstance record (see RmeRingRecord).
+	//Like in the JSON maps, a ring only stores its instance fields and its overrides, the name and scale only when they aren't the template's
+	class InstanceRunWriter
+	{
+	public:
+		InstanceRunWriter(std::vector<uint8_t>& _buffer, RmeStringTable& _strings) : m_buffer(_buffer), m_strings(_strings) {}
+
+		// Returns true when _ring opened a new record
+		bool Append(const Ring& _ring) {
+			const bool opened = _ring.prefab != m_prefab;
+			if (opened)
+				Open(_ring.prefab);
+
+			size_t ringStart = m_buffer.size();
+			WriteRing(_ring);
+			if (m_buffer.size() - m_bodyStart <= UINT16_MAX)
+				return opened;
+
+			// The body size is 16 bits, the ring starts the next record
+			m_buffer.resize(ringStart);
+			Open(_ring.prefab);
+			WriteRing(_ring);
+			return true;
+		}
+
+		// Writes the body size of the open record, the next ring opens a new one
+		void Close() {
+			if (!m_prefab)
+				return;
+
+			RmeRecordHeader header{ static_cast<uint8_t>(ObjectType::Ring), static_cast<uint8_t>(RmeRingRecord::PrefabInstance), static_cast<uint16_t>(m_buffer.size() - m_bodyStart) };
+			std::memcpy(m_buffer.data() + m_bodyStart - sizeof(RmeRecordHeader), &header, sizeof(RmeRecordHeader));
+			m_prefab = nullptr;
+		}
+
+	private:
+		void Open(const std::shared_ptr<const RingPrefab>& _prefab) {
+			Close();
+			m_prefab = _prefab;
+			m_buffer.resize(m_buffer.size() + sizeof(RmeRecordHeader));
+			m_bodyStart = m_buffer.size();
+
+			FieldWriter(m_buffer, &m_strings).WriteString(_prefab->id);
+		}
+
+		void WriteRing(const Ring& _ring) {
+			uint64_t fieldMask = (PrefabLibrary::GetInstanceFields() | PrefabLibrary::GetOverrides(_ring)) & ~(PrefabField | ObjectTypeField);
+			if (_ring.name == m_prefab->ring.name)
+				fieldMask &= ~NameField;
+			if (_ring.scale == m_prefab->ring.scale)
+				fieldMask &= ~ScaleField;
+
+			FieldWriter writer(m_buffer, &m_strings);
+			WriteVarint(writer, fieldMask);
+			writer.WriteFields(_ring, fieldMask);
+		}
+
+		std::vector<uint8_t>& m_buffer;
+		RmeStringTable& m_strings;
+		std::shared_ptr<const RingPrefab> m_prefab;  // of the open record, nullptr when none is open
+		size_t m_bodyStart = 0;
+	};
+
+
+
+	//Fields are assigned directly so stored world transforms are kept as-is, ring parts are put back at the origin (see RingParts)
+	class RecordDecoder
+	{
+	public:
+		RecordDecoder(const BinaryMapView& _view, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions)
+			: m_view(_view), m_triggerFunctions(_triggerFunctions) {}
+
+		// Appends the objects of _record in order, nullptr for the ones that aren't loaded (definitions, unknown types and prefabs).
+		// Parent links count them all (see RmeParentLink)
+		void DecodeRecord(const BinaryMapView::Record& _record, std::vector<std::shared_ptr<Object>>& _outObjects) {
+			if (m_view.GetHeader().version < RmeFieldRecordsVersion)
+			{
+				_outObjects.push_back(DecodeLegacyRecord(_record));
+				return;
+			}
+
+			ObjectType objectType = _record.GetObjectType();
+			FieldReader reader(_record.body, _record.header->size, m_view.GetHeader().fieldsVersion, m_triggerFunctions,
+				[this](const std::string& _id) { return FindPrefab(_id); }, &m_view);
+
+			if (objectType == ObjectType::Ring)
+			{
+				DecodeRingFields(_record, reader, _outObjects);
+				return;
+			}
+
+			std::shared_ptr<Object> object = CreateObject(objectType, static_cast<TriggerVolumeType>(_record.header->subType));
+			if (!object)
+			{
+				if (objectType == ObjectType::TriggerVolume)
+					LOG("[ERROR]Unknown trigger volume type: {}", std::to_string(_record.header->subType));
+				else
+					LOG("[ERROR]Unknown object type: {}", std::to_string(_record.header->objectType));
+				_outObjects.push_back(nullptr);
+				return;
+			}
+
+			RequireFields(VisitObject(*object, [&](auto& _concreteObject) { return reader.ReadFields(_concreteObject, ~uint64_t(0)); }, false), _record);
+			_outObjects.push_back(object);
+		}
+
+		void DecodeObjectBase(Object& _object, const RmeObjectBase& _record) const {
+			_object.name = std::string(m_view.GetString(_record.name));
+			_object.location = ReadVector(_record.location);
+			_object.rotation = ReadRotator(_record.rotation);
+			_object.scale = _record.scale;
+		}
+
+		void DecodeCallback(TriggerVolume& _volume, const RmeTriggerCallback& _record) const {
+			if (_record.name == RmeNoString)
+				return;
+
+			std::string callbackName = std::string(m_view.GetString(_record.name));
+			auto it = m_triggerFunctions.find(callbackName);
+			if (it == m_triggerFunctions.end() || !it->second)
+			{
+				LOG("[ERROR]Unknown trigger function \"{}\" on {}, callback dropped", callbackName, _volume.name);
+				return;
+			}
+
+			TriggerFunctionParams params;
+			params.flag = _record.flag != 0;
+			std::memcpy(params.floats, _record.floats, sizeof(params.floats));
+			std::memcpy(params.ints, _record.ints, sizeof(params.ints));
+
+			std::shared_ptr<TriggerFunction> callback = it->second->Clone();
+			callback->ReadParams(params);
+			_volume.SetOnTouchCallback(callback);
+		}
+
+		void DecodeMesh(Mesh& _mesh, const RmeMesh& _record) const {
+			DecodeObjectBase(_mesh, _record.base);
+			_mesh.meshInfos = MeshInfos(std::string(m_view.GetString(_record.meshName)), std::string(m_view.GetString(_record.meshPath)));
+			_mesh.enableCollisions = _record.enableCollisions != 0;
+			_mesh.enablePhysics = _record.enablePhysics != 0;
+			_mesh.enableStickyWalls = _record.enableStickyWalls != 0;
+		}
+
+		void DecodeTriggerVolumeBox(TriggerVolume_Box& _volume, const RmeTriggerVolumeBox& _record) const {
+			DecodeObjectBase(_volume, _record.base);
+			_volume.size = ReadVector(_record.size);
+			DecodeCallback(_volume, _record.callback);
+		}
+
+		void DecodeTriggerVolumeCylinder(TriggerVolume_Cylinder& _volume, const RmeTriggerVolumeCylinder& _record) const {
+			DecodeObjectBase(_volume, _record.base);
+			_volume.radius = _record.radius;
+			_volume.height = _record.height;
+			DecodeCallback(_volume, _record.callback);
+		}
+
+		void DecodeCheckpoint(Checkpoint& _checkpoint, const RmeCheckpoint& _record) const {
+			DecodeObjectBase(_checkpoint, _record.base);
+			_checkpoint.checkpointId = _record.checkpointId;
+			_checkpoint.checkpointType = static_cast<CheckpointType>(_record.checkpointType);
+			DecodeTriggerVolumeBox(_checkpoint.triggerVolume, _record.triggerVolume);
+			_checkpoint.spawnLocation_offset = ReadVector(_record.spawnLocationOffset);
+			_checkpoint.spawnRotation = ReadRotator(_record.spawnRotation);
+		}
+
+		// The parts were stored placed in the world, they are put back at the origin
+		void DecodeRing(Ring& _ring, const RmeRing& _record) const {
+			DecodeObjectBase(_ring, _record.base);
+			_ring.ringId = _record.ringId;
+
+			RingParts& parts = _ring.EditParts();
+			DecodeMesh(parts.mesh, _record.mesh);
+			DecodeTriggerVolumeCylinder(parts.triggerVolumeIn, _record.triggerVolumeIn);
+			parts.triggerVolumeIn_offset_location = ReadVector(_record.triggerVolumeInOffsetLocation);
+			parts.triggerVolumeIn_offset_rotation = ReadRotator(_record.triggerVolumeInOffsetRotation);
+			DecodeTriggerVolumeBox(parts.triggerVolumeOut, _record.triggerVolumeOut);
+			parts.triggerVolumeOut_offset_location = ReadVector(_record.triggerVolumeOutOffsetLocation);
+			parts.triggerVolumeOut_offset_rotation = ReadRotator(_record.triggerVolumeOutOffsetRotation);
+			parts.ClearTransforms();
+		}
+
+		std::shared_ptr<Object> DecodeLegacyRecord(const BinaryMapView::Record& _record) {
+			ObjectType objectType = _record.GetObjectType();
+
+			if (objectType == ObjectType::Mesh)
+			{
+				std::shared_ptr<Mesh> mesh = MakePooled<Mesh>();
+				DecodeMesh(*mesh, Require<RmeMesh>(_record));
+				return mesh;
+			}
+			else if (objectType == ObjectType::TriggerVolume)
+			{
+				TriggerVolumeType triggerVolumeType = static_cast<TriggerVolumeType>(_record.header->subType);
+				if (triggerVolumeType == TriggerVolumeType::Box)
+				{
+					std::shared_ptr<TriggerVolume_Box> volume = MakePooled<TriggerVolume_Box>();
+					DecodeTriggerVolumeBox(*volume, Require<RmeTriggerVolumeBox>(_record));
+					return volume;
+				}
+				else if (triggerVolumeType == TriggerVolumeType::Cylinder)
+				{
+					std::shared_ptr<TriggerVolume_Cylinder> volume = MakePooled<TriggerVolume_Cylinder>();
+					DecodeTriggerVolumeCylinder(*volume, Require<RmeTriggerVolumeCylinder>(_record));
+					return volume;
+				}
+
+				LOG("[ERROR]Unknown trigger volume type: {}", std::to_string(_record.header->subType));
+				return nullptr;
+			}
+			else if (objectType == ObjectType::Checkpoint)
+			{
+				std::shared_ptr<Checkpoint> checkpoint = MakePooled<Checkpoint>();
+				DecodeCheckpoint(*checkpoint, Require<RmeCheckpoint>(_record));
+				return checkpoint;
+			}
+			else if (objectType == ObjectType::Ring)
+			{
+				return DecodeLegacyRingRecord(_record);
+			}
+
+			LOG("[ERROR]Unknown object type: {}", std::to_string(_record.header->objectType));
+			return nullptr;
+		}
+
+		void GetPrefabs(std::vector<std::shared_ptr<const RingPrefab>>& _outPrefabs) const {
+			for (const auto& [id, prefab] : m_prefabs)
+				_outPrefabs.push_back(prefab);
+		}
+
+	private:
+		// Definitions of this map first, they are only registered once the whole map is decoded
+		std::shared_ptr<const RingPrefab> FindPrefab(const std::string& _id) const {
+			auto it = m_prefabs.find(_id);
+			return it != m_prefabs.end() ? it->second : PrefabLibrary::Get().Find(_id);
+		}
+
+		void DecodeRingFields(const BinaryMapView::Record& _record, FieldReader& _reader, std::vector<std::shared_ptr<Object>>& _outObjects) {
+			RmeRingRecord recordType = static_cast<RmeRingRecord>(_record.header->subType);
+
+			if (recordType == RmeRingRecord::Full)
+			{
+				std::shared_ptr<Ring> ring = MakePooled<Ring>();
+				RequireFields(_reader.ReadFields(*ring, ~uint64_t(0)), _record);
+				ring->ClearPartTransforms();
+				_outObjects.push_back(ring);
+				return;
+			}
+
+			if (recordType != RmeRingRecord::PrefabInstance && recordType != RmeRingRecord::PrefabDefinition)
+			{
+				LOG("[ERROR]Unknown ring record type: {}", std::to_string(_record.header->subType));
+				_outObjects.push_back(nullptr);
+				return;
+			}
+
+			std::string prefabId;
+			RequireFields(_reader.ReadString(prefabId), _record);
+
+			if (recordType == RmeRingRecord::PrefabDefinition)
+			{
+				Ring ring;
+				RequireFields(_reader.ReadFields(ring, ~uint64_t(0)), _record);
+				AddDefinition(prefabId, ring);
+				_outObjects.push_back(nullptr);
+				return;
+			}
+
+			std::shared_ptr<const RingPrefab> prefab = FindPrefab(prefabId);
+			if (!prefab)
+				LOG("[ERROR]Unknown prefab \"{}\", its rings are dropped", prefabId);
+
+			// A record holds one ring and a uint64 mask before version 5, a run of rings each with a varint mask since
+			const bool isRun = m_view.GetHeader().version >= RmeInstanceRunsVersion;
+			do
+			{
+				uint64_t fieldMask = 0;
+				RequireFields(isRun ? ReadVarint(_reader, fieldMask) : _reader.Read(fieldMask), _record);
+
+				// The rings of an unknown prefab are still read, the next ones start after them
+				std::shared_ptr<Ring> ring = prefab ? PrefabLibrary::Instantiate(prefab, -1) : MakePooled<Ring>();
+				RequireFields(_reader.ReadFields(*ring, fieldMask), _record);
+				if (!prefab)
+				{
+					_outObjects.push_back(nullptr);
+					continue;
+				}
+
+				ring->ClearPartTransforms();
+				PrefabLibrary::ShareUnchangedParts(*ring);
+				_outObjects.push_back(ring);
+			} while (isRun && !_reader.IsAtEnd());
+		}
+
+		void AddDefinition(const std::string& _prefabId, const Ring& _ring) {
+			std::shared_ptr<const RingPrefab> existing = PrefabLibrary::Get().Find(_prefabId);
+			if (existing && existing->builtIn)
+				LOG("[ERROR]{} is a built-in prefab, the map's definition is ignored", _prefabId);
+			else
+				m_prefabs[_prefabId] = PrefabLibrary::MakePrefab(_prefabId, _ring);
+		}
+
+		std::shared_ptr<Ring> DecodeLegacyRingRecord(const BinaryMapView::Record& _record) {
+			RmeRingRecord recordType = static_cast<RmeRingRecord>(_record.header->subType);
+
+			if (recordType == RmeRingRecord::PrefabInstance)
+			{
+				const RmeRingInstance& body = Require<RmeRingInstance>(_record);
+				std::string prefabId = std::string(m_view.GetString(body.prefab));
+				std::shared_ptr<const RingPrefab> prefab = FindPrefab(prefabId);
+				if (!prefab)
+				{
+					LOG("[ERROR]Unknown prefab \"{}\", ring {} dropped", prefabId, body.ringId);
+					return nullptr;
+				}
+
+				std::shared_ptr<Ring> ring = PrefabLibrary::Instantiate(prefab, body.ringId);
+				DecodeObjectBase(*ring, body.base);
+				return ring;
+			}
+
+			std::shared_ptr<Ring> ring = MakePooled<Ring>();
+
+			if (recordType == RmeRingRecord::Full)
+			{
+				DecodeRing(*ring, Require<RmeRing>(_record));
+				return ring;
+			}
+
+			if (recordType == RmeRingRecord::PrefabOverride || recordType == RmeRingRecord::PrefabDefinition)
+			{
+				const RmeRingPrefab& body = Require<RmeRingPrefab>(_record);
+				DecodeRing(*ring, body.ring);
+				std::string prefabId = std::string(m_view.GetString(body.prefab));
+
+				if (recordType == RmeRingRecord::PrefabDefinition)
+				{
+					AddDefinition(prefabId, *ring);
+					return nullptr;
+				}
+
+				ring->prefab = FindPrefab(prefabId);
+				if (!ring->prefab)
+					LOG("[ERROR]Unknown prefab \"{}\" on {}, the ring is loaded unlinked", prefabId, ring->name);
+				PrefabLibrary::ShareUnchangedParts(*ring);
+				return ring;
+			}
+
+			LOG("[ERROR]Unknown ring record type: {}", std::to_string(_record.header->subType));
+			return nullptr;
+		}
+
+		static void RequireFields(bool _read, const BinaryMapView::Record& _record) {
+			if (!_read)
+				throw std::runtime_error("record is smaller than its fields (" + std::to_string(_record.header->size) + " bytes)");
+		}
+
+		template <typename T>
+		static const T& Require(const BinaryMapView::Record& _record) {
+			const T* body = _record.As<T>();
+			if (!body)
+				throw std::runtime_error("record is smaller than expected (" + std::to_string(_record.header->size) + " < " + std::to_string(sizeof(T)) + ")");
+			return *body;
+		}
+
+		const BinaryMapView& m_view;
+		std::map<std::string, std::shared_ptr<TriggerFunction>>& m_triggerFunctions;
+		std::map<std::string, std::shared_ptr<const RingPrefab>> m_prefabs;
+	};
+}
+
+
+
+std::vector<uint8_t> BinaryMap::Encode(const std::vector<std::shared_ptr<Object>>& _objects, const std::vector<int32_t>& _parents)
+{
+	RmeStringTable strings;
+	std::vector<uint8_t> records;
+	records.reserve(_objects.size() * (sizeof(RmeRecordHeader) + sizeof(RmeMesh)));
+	uint32_t recordCount = 0;
+	uint32_t objectCount = 0; // decoded objects, definitions included : what parent links index
+
+	// Definitions come before the records of their instances, the decoder reads records in order
+	std::vector<std::shared_ptr<const RingPrefab>> prefabs;
+	PrefabLibrary::GetUserPrefabs(_objects, prefabs);
+	for (const std::shared_ptr<const RingPrefab>& prefab : prefabs)
+	{
+		AppendFieldRecord(records, ObjectType::Ring, static_cast<uint8_t>(RmeRingRecord::PrefabDefinition), strings, [&](FieldWriter& _writer) {
+			_writer.WriteString(prefab->id);
+			_writer.WriteFields(prefab->ring, AllFieldsMask<Ring>);
+			});
+		recordCount++;
+		objectCount++;
+	}
+
+	// Decoded index of each object, for the parent links
+	std::vector<uint32_t> objectIndices(_parents.empty() ? 0 : _objects.size(), RmeNoString);
+	InstanceRunWriter instanceRuns(records, strings);
+
+	for (size_t i = 0; i < _objects.size(); i++)
+	{
+		const std::shared_ptr<Object>& object = _objects[i];
+		if (!object)
+			continue;
+
+		if (object->objectType == ObjectType::Ring && static_cast<const Ring&>(*object).prefab)
+		{
+			if (instanceRuns.Append(static_cast<const Ring&>(*object)))
+				recordCount++;
+		}
+		else
+		{
+			instanceRuns.Close();
+			if (!AppendObjectRecord(records, *object, strings))
+			{
+				LOG("[ERROR]Skipping object with unknown type: {}", object->name);
+				continue;
+			}
+			recordCount++;
+		}
+
+		if (!objectIndices.empty())
+			objectIndices[i] = objectCount;
+		objectCount++;
+	}
+	instanceRuns.Close();
+
+	// Written last, every object they point to is decoded by the time they're read
+	for (size_t i = 0; i < std::min(_parents.size(), _objects.size()); i++)
+	{
+		if (_parents[i] < 0 || static_cast<size_t>(_parents[i]) >= _objects.size()
+			|| objectIndices[i] == RmeNoString || objectIndices[_parents[i]] == RmeNoString)
+			continue;
+
+		AppendRecord(records, static_cast<ObjectType>(RmeParentLinkRecord), 0, RmeParentLink{ objectIndices[i], objectIndices[_parents[i]] });
+		recordCount++;
+	}
+
+	std::vector<uint8_t> buffer(sizeof(RmeHeader));
+	strings.WriteTo(buffer);
+	size_t stringTableEnd = buffer.size();
+	buffer.insert(buffer.end(), records.begin(), records.end());
+
+	RmeHeader header{};
+	std::memcpy(header.magic, RmeMagic, sizeof(header.magic));
+	header.version = RmeVersion;
+	header.headerSize = sizeof(RmeHeader);
+	header.objectCount = recordCount;
+	header.stringCount = strings.GetCount();
+	header.stringTableOffset = sizeof(RmeHeader);
+	header.stringTableSize = static_cast<uint32_t>(stringTableEnd - sizeof(RmeHeader));
+	header.recordsOffset = static_cast<uint32_t>(stringTableEnd);
+	header.recordsSize = static_cast<uint32_t>(records.size());
+	header.fieldsVersion = ObjectFieldsVersion;
+	std::memcpy(buffer.data(), &header, sizeof(RmeHeader));
+
+	return buffer;
+}
+
+RmeStringTable::RmeStringTable()
+{
+	Intern("");
+}
+
+uint32_t RmeStringTable::Intern(const std::string& _value)
+{
+	auto it = m_indices.find(_value);
+	if (it != m_indices.end())
+		return it->second;
+
+	uint32_t index = static_cast<uint32_t>(m_offsets.size());
+	m_offsets.push_back(static_cast<uint32_t>(m_bytes.size()));
+	m_bytes.insert(m_bytes.end(), _value.begin(), _value.end());
+	m_indices.emplace(_value, index);
+	return index;
+}
+
+void RmeStringTable::WriteTo(std::vector<uint8_t>& _buffer) const
+{
+	size_t start = _buffer.size();
+	_buffer.resize(start + (m_offsets.size() + 1) * sizeof(uint32_t));
+	std::memcpy(_buffer.data() + start, m_offsets.data(), m_offsets.size() * sizeof(uint32_t));
+
+	uint32_t end = static_cast<uint32_t>(m_bytes.size());
+	std::memcpy(_buffer.data() + start + m_offsets.size() * sizeof(uint32_t), &end, sizeof(uint32_t));
+
+	_buffer.insert(_buffer.end(), m_bytes.begin(), m_bytes.end());
+}
+
+
+
+bool BinaryMapView::Open(const uint8_t* _data, size_t _size)
+{
+	m_header = nullptr;
+	m_records.clear();
+
+	if (_size < RmeHeaderSizeV3)
+	{
+		LOG("[ERROR]Binary map is too small to contain a header ({} bytes)", _size);
+		return false;
+	}
+
+	const RmeHeader* header = reinterpret_cast<const RmeHeader*>(_data);
+
+	if (std::memcmp(header->magic, RmeMagic, sizeof(header->magic)) != 0)
+	{
+		LOG("[ERROR]Not a binary map (bad magic)");
+		return false;
+	}
+
+	if (header->version > RmeVersion)
+	{
+		LOG("[ERROR]Binary map version {} is newer than the supported version {}", header->version, RmeVersion);
+		return false;
+	}
+
+	// Headers before version 4 end before fieldsVersion
+	const size_t headerSize = (header->version >= RmeFieldRecordsVersion) ? sizeof(RmeHeader) : RmeHeaderSizeV3;
+	if (header->headerSize < headerSize || _size < headerSize)
+	{
+		LOG("[ERROR]Binary map header is truncated");
+		return false;
+	}
+
+	if (header->version >= RmeFieldRecordsVersion && header->fieldsVersion > ObjectFieldsVersion)
+	{
+		LOG("[ERROR]Binary map fields version {} is newer than the supported version {}", header->fieldsVersion, ObjectFieldsVersion);
+		return false;
+	}
+
+	size_t stringOffsetsSize = (static_cast<size_t>(header->stringCount) + 1) * sizeof(uint32_t);
+	if (static_cast<uint64_t>(header->stringTableOffset) + header->stringTableSize > _size
+		|| static_cast<uint64_t>(header->recordsOffset) + header->recordsSize > _size
+		|| header->stringCount == 0 || header->stringTableSize < stringOffsetsSize)
+	{
+		LOG("[ERROR]Binary map sections point outside the file");
+		return false;
+	}
+
+	m_stringOffsets = _data + header->stringTableOffset;
+	m_stringBytes = reinterpret_cast<const char*>(m_stringOffsets + stringOffsetsSize);
+	m_stringBytesSize = header->stringTableSize - stringOffsetsSize;
+
+	const uint8_t* cursor = _data + header->recordsOffset;
+	const uint8_t* end = cursor + header->recordsSize;
+	m_records.reserve(header->objectCount);
+
+	for (uint32_t i = 0; i < header->objectCount; i++)
+	{
+		if (end - cursor < static_cast<ptrdiff_t>(sizeof(RmeRecordHeader)))
+		{
+			LOG("[ERROR]Binary map record {} header is truncated", i);
+			return false;
+		}
+
+		Record record;
+		record.header = reinterpret_cast<const RmeRecordHeader*>(cursor);
+		record.body = cursor + sizeof(RmeRecordHeader);
+
+		if (end - record.body < record.header->size)
+		{
+			LOG("[ERROR]Binary map record {} body is truncated", i);
+			return false;
+		}
+
+		m_records.push_back(record);
+		cursor = record.body + record.header->size;
+	}
+
+	m_header = header;
+	return true;
+}
+
+std::string_view BinaryMapView::GetString(uint32_t _index) const
+{
+	if (_index >= m_header->stringCount)
+		throw std::runtime_error("string index out of range: " + std::to_string(_index));
+
+	uint32_t begin = GetStringOffset(_index);
+	uint32_t end = GetStringOffset(_index + 1);
+	if (begin > end || end > m_stringBytesSize)
+		throw std::runtime_error("string " + std::to_string(_index) + " points outside the string table");
+
+	return std::string_view(m_stringBytes + begin, end - begin);
+}
+
+uint32_t BinaryMapView::GetStringOffset(uint32_t _index) const
+{
+	uint32_t offset;
+	std::memcpy(&offset, m_stringOffsets + _index * sizeof(uint32_t), sizeof(uint32_t));
+	return offset;
+}
+
+
+
+bool BinaryMap::Decode(const uint8_t* _data, size_t _size, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects, MapExtras& _outExtras)
+{
+	BinaryMapView view;
+	if (!view.Open(_data, _size))
+		return false;
+
+	return Decode(view, _triggerFunctions, _outObjects, _outExtras);
+}
+
+bool BinaryMap::Decode(const BinaryMapView& _view, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects, MapExtras& _outExtras)
+{
+	RecordDecoder decoder(_view, _triggerFunctions);
+
+	// Objects of the records in order, nullptr for definitions and dropped objects : what parent links index
+	std::vector<std::shared_ptr<Object>> decodedObjects;
+	decodedObjects.reserve(_view.GetRecordCount());
+	std::vector<RmeParentLink> links;
+
+	for (size_t i = 0; i < _view.GetRecordCount(); i++)
+	{
+		try
+		{
+			const BinaryMapView::Record& record = _view.GetRecord(i);
+			if (record.header->objectType == RmeParentLinkRecord)
+			{
+				const RmeParentLink* link = record.As<RmeParentLink>();
+				if (!link)
+					throw std::runtime_error("parent link record is smaller than expected");
+				links.push_back(*link);
+				continue;
+			}
+
+			decoder.DecodeRecord(record, decodedObjects);
+		}
+		catch (const std::exception& e)
+		{
+			LOG("[ERROR]Failed to decode binary map record {}: {}", i, e.what());
+			return false;
+		}
+	}
+
+	// Index in _outObjects of each decoded object, -1 for the ones that weren't loaded
+	std::vector<int32_t> objectIndices(decodedObjects.size(), -1);
+	_outObjects.reserve(_outObjects.size() + decodedObjects.size());
+	for (size_t i = 0; i < decodedObjects.size(); i++)
+	{
+		if (!decodedObjects[i])
+			continue;
+
+		objectIndices[i] = static_cast<int32_t>(_outObjects.size());
+		_outObjects.push_back(std::move(decodedObjects[i]));
+	}
+
+	for (const RmeParentLink& link : links)
+	{
+		if (link.child >= objectIndices.size() || link.parent >= objectIndices.size() || objectIndices[link.child] < 0 || objectIndices[link.parent] < 0)
+		{
+			LOG("[ERROR]Binary map parent link {} -> {} doesn't point to loaded objects, dropped", link.child, link.parent);
+			continue;
+		}
+
+		if (_outExtras.parents.size() < _outObjects.size())
+			_outExtras.parents.resize(_outObjects.size(), -1);
+		_outExtras.parents[objectIndices[link.child]] = objectIndices[link.parent];
+	}
+
+	decoder.GetPrefabs(_outExtras.prefabs);
+	return true;
+}
+
+bool BinaryMap::Save(const std::filesystem::path& _filePath, const std::vector<std::shared_ptr<Object>>& _objects, const std::vector<int32_t>& _parents)
+{
+	std::vector<uint8_t> buffer = Encode(_objects, _parents);
+
+	std::ofstream file = std::ofstream(_filePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG("[ERROR]Could not open binary map for writing: {}", _filePath.string());
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+	if (!file)
+	{
+		LOG("[ERROR]Failed to write binary map: {}", _filePath.string());
+		return false;
+	}
+
+	return true;
+}
+
+bool BinaryMap::Load(const std::filesystem::path& _filePath, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects, MapExtras& _outExtras)
+{
+	// Objects are built straight from the mapped records, the file is never copied into an intermediate buffer
+	MappedFile file;
+	if (!file.Open(_filePath))
+	{
+		LOG("[ERROR]Could not open binary map: {}", _filePath.string());
+		return false;
+	}
+
+	return Decode(file.Data(), file.Size(), _triggerFunctions, _outObjects, _outExtras);
+}
+
+bool BinaryMap::IsBinaryMap(const std::filesystem::path& _filePath)
+{
+	return _filePath.extension() == RmeExtension;
+}
@@ -0,0 +1,247 @@
+#pragma once
+#include "ObjectManager.h"
+
+#include <bit>
+#include <filesystem>
+#include <string_view>
+#include <unordered_map>
+
+static_assert(std::endian::native == std::endian::little, "The .rme format is stored little-endian and read with plain memcpy");
+
+enum class MapFileFormat : uint8_t
+{
+	Json = 0,
+	Binary = 1
+};
+
+//.rme layout :
+//  RmeHeader
+//  string table : uint32 offsets[stringCount + 1] followed by the UTF-8 bytes (no terminators), string 0 is always ""
+//  records      : RmeRecordHeader followed by a body picked from objectType/subType,
+//                 then one RmeParentLink record per object that has a parent
+//Since version 4 a body holds the fields of the object's ObjectFields<T> that exist in RmeHeader::fieldsVersion,
+//written by FieldWriter with the string table (see RmeRingRecord for rings made from a prefab).
+//Since version 5 a record may hold several objects, a run of rings made from the same prefab.
+//Bodies of earlier versions are the fixed layouts below, they are still read.
+#pragma pack(push, 1)
+
+struct RmeHeader
+{
+	char magic[4];
+	uint16_t version;
+	uint16_t headerSize;
+	uint32_t objectCount;       // records, prefab definitions and parent links included
+	uint32_t stringCount;
+	uint32_t stringTableOffset;
+	uint32_t stringTableSize;
+	uint32_t recordsOffset;
+	uint32_t recordsSize;
+	uint16_t fieldsVersion;     // ObjectFieldsVersion of the record bodies, since version 4
+	uint16_t padding;
+};
+
+struct RmeRecordHeader
+{
+	uint8_t objectType;
+	uint8_t subType;    // TriggerVolumeType for trigger volumes, RmeRingRecord for rings, 0 otherwise
+	uint16_t size;      // body size in bytes, not counting this header
+};
+
+//Objects are referred to by their index in decoding order, prefab definitions included.
+//Before version 5 each record held one object, it's the index of its record
+struct RmeParentLink
+{
+	uint32_t child;
+	uint32_t parent;
+};
+
+//Record bodies before version 4, only read
+struct RmeObjectBase
+{
+	uint32_t name;      // string table index
+	float location[3];
+	int32_t rotation[3];
+	float scale;
+};
+
+struct RmeTriggerCallback
+{
+	uint32_t name;      // string table index, RmeNoString when the volume has no callback
+	uint8_t flag;
+	uint8_t padding[3];
+	float floats[3];
+	int32_t ints[3];
+};
+
+struct RmeMesh
+{
+	RmeObjectBase base;
+	uint32_t meshName;
+	uint32_t meshPath;
+	uint8_t enableCollisions;
+	uint8_t enablePhysics;
+	uint8_t enableStickyWalls;
+	uint8_t padding;
+};
+
+struct RmeTriggerVolumeBox
+{
+	RmeObjectBase base;
+	float size[3];
+	RmeTriggerCallback callback;
+};
+
+struct RmeTriggerVolumeCylinder
+{
+	RmeObjectBase base;
+	float radius;
+	float height;
+	RmeTriggerCallback callback;
+};
+
+struct RmeCheckpoint
+{
+	RmeObjectBase base;
+	int32_t checkpointId;
+	uint8_t checkpointType;
+	uint8_t padding[3];
+	RmeTriggerVolumeBox triggerVolume;
+	float spawnLocationOffset[3];
+	int32_t spawnRotation[3];
+};
+
+struct RmeRing
+{
+	RmeObjectBase base;
+	int32_t ringId;
+	RmeMesh mesh;
+	RmeTriggerVolumeCylinder triggerVolumeIn;
+	float triggerVolumeInOffsetLocation[3];
+	int32_t triggerVolumeInOffsetRotation[3];
+	RmeTriggerVolumeBox triggerVolumeOut;
+	float triggerVolumeOutOffsetLocation[3];
+	int32_t triggerVolumeOutOffsetRotation[3];
+};
+
+//Ring made from a prefab without overrides, everything else comes from the template
+struct RmeRingInstance
+{
+	RmeObjectBase base;
+	int32_t ringId;
+	uint32_t prefab;    // string table index of the prefab id
+};
+
+struct RmeRingPrefab
+{
+	RmeRing ring;
+	uint32_t prefab;    // string table index of the prefab id
+};
+
+#pragma pack(pop)
+
+//Since version 4 a prefab id (string index) comes first in PrefabInstance and PrefabDefinition bodies.
+//An instance then stores a mask of the Ring fields that follow : its instance fields and its overrides.
+//In version 4 the mask is a uint64 and the record holds one ring. Since version 5 the record holds consecutive rings of the prefab
+//until the body ends, each one a LEB128 varint mask then its fields. The name and scale are left out when they are the template's
+enum class RmeRingRecord : uint8_t
+{
+	Full = 0,             // RmeRing, a ring that isn't linked to a prefab
+	PrefabInstance = 1,   // RmeRingInstance before version 4
+	PrefabOverride = 2,   // RmeRingPrefab : a prefab instance with overrides, stored in full. Only before version 4
+	PrefabDefinition = 3  // RmeRingPrefab : a user prefab, before its instances. Decoded into MapExtras::prefabs instead of the scene
+};
+
+static_assert(sizeof(RmeHeader) == 36);
+static_assert(sizeof(RmeRecordHeader) == 4);
+static_assert(sizeof(RmeObjectBase) == 32);
+static_assert(sizeof(RmeTriggerCallback) == 32);
+static_assert(sizeof(RmeMesh) == 44);
+static_assert(sizeof(RmeTriggerVolumeBox) == 76);
+static_assert(sizeof(RmeTriggerVolumeCylinder) == 72);
+static_assert(sizeof(RmeCheckpoint) == 140);
+static_assert(sizeof(RmeRing) == 276);
+static_assert(sizeof(RmeRingInstance) == 40);
+static_assert(sizeof(RmeRingPrefab) == 280);
+static_assert(sizeof(RmeParentLink) == 8);
+static_assert(alignof(RmeRing) == 1, "Records are read in place at unaligned offsets");
+
+constexpr char RmeMagic[4] = { 'R', 'M', 'E', 'B' };
+constexpr uint16_t RmeVersion = 5;
+constexpr uint16_t RmeFieldRecordsVersion = 4; // first version whose record bodies are written from ObjectFields
+constexpr uint16_t RmeInstanceRunsVersion = 5; // first version whose PrefabInstance records hold runs of rings
+constexpr uint16_t RmeHeaderSizeV3 = 32;       // before fieldsVersion was added
+constexpr uint32_t RmeNoString = 0xFFFFFFFF;
+constexpr uint8_t RmeParentLinkRecord = 0xFF; // objectType of RmeParentLink records, no ObjectType uses it
+constexpr const char* RmeExtension = ".rme";
+
+//Interns strings so repeated names and mesh paths are only stored once
+class RmeStringTable
+{
+public:
+	RmeStringTable();
+
+	uint32_t Intern(const std::string& _value);
+	uint32_t GetCount() const { return static_cast<uint32_t>(m_offsets.size()); }
+	void WriteTo(std::vector<uint8_t>& _buffer) const;
+
+private:
+	std::unordered_map<std::string, uint32_t> m_indices;
+	std::vector<uint32_t> m_offsets;
+	std::vector<char> m_bytes;
+};
+
+//Read-only typed view over an encoded .rme buffer.
+//Open() validates the header and record framing once, records and strings are then read in place without copies.
+//The view doesn't own the bytes, they must outlive it (see MappedFile).
+class BinaryMapView
+{
+public:
+	struct Record
+	{
+		const RmeRecordHeader* header = nullptr;
+		const uint8_t* body = nullptr;
+
+		ObjectType GetObjectType() const { return static_cast<ObjectType>(header->objectType); }
+
+		// Returns nullptr when the record is too small for T, larger records come from newer versions and only their prefix is read
+		template <typename T>
+		const T* As() const {
+			return header->size >= sizeof(T) ? reinterpret_cast<const T*>(body) : nullptr;
+		}
+	};
+
+	bool Open(const uint8_t* _data, size_t _size);
+
+	const RmeHeader& GetHeader() const { return *m_header; }
+	size_t GetRecordCount() const { return m_records.size(); }
+	const Record& GetRecord(size_t _index) const { return m_records[_index]; }
+	const std::vector<Record>& GetRecords() const { return m_records; }
+
+	// Throws std::runtime_error on an invalid index, the string table is not validated eagerly
+	std::string_view GetString(uint32_t _index) const;
+
+private:
+	uint32_t GetStringOffset(uint32_t _index) const;
+
+	const RmeHeader* m_header = nullptr;
+	const uint8_t* m_stringOffsets = nullptr;
+	const char* m_stringBytes = nullptr;
+	size_t m_stringBytesSize = 0;
+	std::vector<Record> m_records;
+};
+
+//Compact binary map format, stored next to the JSON configs with the .rme extension.
+//A 50k object map is about 8x smaller than its pretty JSON and loads in tens of milliseconds instead of most of a second.
+class BinaryMap
+{
+public:
+	// _parents holds the parent of each object as an index in _objects, -1 for none (see SceneGraph::GetParentIndices)
+	static std::vector<uint8_t> Encode(const std::vector<std::shared_ptr<Object>>& _objects, const std::vector<int32_t>& _parents = {});
+	static bool Decode(const uint8_t* _data, size_t _size, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects, MapExtras& _outExtras);
+	static bool Decode(const BinaryMapView& _view, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects, MapExtras& _outExtras);
+
+	static bool Save(const std::filesystem::path& _filePath, const std::vector<std::shared_ptr<Object>>& _objects, const std::vector<int32_t>& _parents);
+	static bool Load(const std::filesystem::path& _filePath, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects, MapExtras& _outExtras);
+
+	static bool IsBinaryMap(const std::filesystem::path& _filePath);
+};
@@ -124,6 +124,7 @@ void BuildMode::OnTick(float _deltaTime)
 
         m_previewObject->SetLocation(CalculatePreviewActorLocation(camera));
         m_previewObject->SetRotation(m_previewObjectRotation);
+        m_previewObject->UpdateChildren();
     }
 }
 
@@ -133,76 +134,76 @@ void BuildMode::RenderCanvas(CanvasWrapper _canvas)
 
     RenderObjectsCanvas(_canvas);
 
-    _canvas.SetColor(255, 255, 255, 255);
-
-    float stringScale = 2.f;
-    float newLinePaddingY = 15.f * stringScale;
-    Vector2 pos = Vector2{ 20, 80 };
+    if (m_hud.Update(ComputeHudKey()))
+    {
+        BuildHud();
+    }
 
-    auto newLine = [&]() {
-        pos.Y += newLinePaddingY;
-        _canvas.SetPosition(pos);
-        };
+    m_hud.Render(_canvas);
+}
 
-    _canvas.SetPosition(pos);
-    _canvas.DrawString("Build Mode", stringScale, stringScale);
-    newLine();
+uint64_t BuildMode::ComputeHudKey()
+{
+    uint64_t key = reinterpret_cast<uintptr_t>(m_previewObject.get());
 
     if (m_previewObject)
     {
-        if (m_previewObject->objectType == ObjectType::Mesh)
-        {
-            newLine();
-            _canvas.DrawString("Mesh", stringScale, stringScale);
+        key = HudText::Combine(key, static_cast<uint64_t>(m_previewObject->objectType));
+        key = HudText::Combine(key, static_cast<uint64_t>(m_availableMeshesIndex));
+        key = HudText::Combine(key, reinterpret_cast<uintptr_t>(&GetCurrentEditingProperty()));
+    }
 
-            newLine();
-            newLine();
-            std::string meshIndexText = "Mesh Index : " + std::to_string(m_availableMeshesIndex);
-            _canvas.DrawString(meshIndexText, stringScale, stringScale);
+    return key;
+}
 
-            newLine();
-            std::string meshText = "Mesh : " + GetCurrentMesh().name;
-            _canvas.DrawString(meshText, stringScale, stringScale);
-        }
-        else if (m_previewObject->objectType == ObjectType::TriggerVolume)
-        {
-            newLine();
-            _canvas.DrawString("Trigger Volume", stringScale, stringScale);
-
-            newLine();
-            newLine();
-            std::string triggerVolumeTypeText = "Trigger Volume Type : ";
-            if (std::static_pointer_cast<TriggerVolume>(m_previewObject)->triggerVolumeType == TriggerVolumeType::Box)
-                triggerVolumeTypeText += "Box";
-            else if (std::static_pointer_cast<TriggerVolume>(m_previewObject)->triggerVolumeType == TriggerVolumeType::Cylinder)
-                triggerVolumeTypeText += "Cylinder";
-            else
-                triggerVolumeTypeText += "Unknown";
-
-            _canvas.DrawString(triggerVolumeTypeText, stringScale, stringScale);
-        }
-        else if (m_previewObject->objectType == ObjectType::Checkpoint)
-        {
-            newLine();
-            _canvas.DrawString("Checkpoint", stringScale, stringScale);
-        }
-        else if (m_previewObject->objectType == ObjectType::Ring)
-        {
-            newLine();
-            _canvas.DrawString("Ring", stringScale, stringScale);
-        }
+void BuildMode::BuildHud()
+{
+    m_hud.SetLine(0, "Build Mode");
+
+    if (!m_previewObject)
+        return;
 
-        newLine();
-        newLine();
-        newLine();
-        std::string editingText = "Editing : ";
-        editingText += GetCurrentEditingProperty().name;
-        _canvas.DrawString(editingText, stringScale, stringScale);
+    int editingRow = 0;
+
+    if (m_previewObject->objectType == ObjectType::Mesh)
+    {
+        m_hud.SetLine(2, "Mesh");
+        m_hud.SetLine(4, "Mesh Index : {}", m_availableMeshesIndex);
+        m_hud.SetLine(5, "Mesh : {}", GetCurrentMesh().name);
+        editingRow = 8;
     }
+    else if (m_previewObject->objectType == ObjectType::TriggerVolume)
+    {
+        m_hud.SetLine(2, "Trigger Volume");
+        m_hud.SetLine(4, "Trigger Volume Type : {}", GetTriggerVolumeTypeName(m_previewObject));
+        editingRow = 7;
+    }
+    else if (m_previewObject->objectType == ObjectType::Checkpoint)
+    {
+        m_hud.SetLine(2, "Checkpoint");
+        editingRow = 5;
+    }
+    else if (m_previewObject->objectType == ObjectType::Ring)
+    {
+        m_hud.SetLine(2, "Ring");
+        editingRow = 5;
+    }
+    else
+    {
+        editingRow = 4;
+    }
+
+    m_hud.SetLine(editingRow, "Editing : {}", GetCurrentEditingProperty().name);
 }
 
 void BuildMode::PlaceObject()
 {
+    // The preview is cloned for the next placement, each placed checkpoint or ring takes a new id
+    if (m_previewObject->objectType == ObjectType::Checkpoint)
+        std::static_pointer_cast<Checkpoint>(m_previewObject)->checkpointId = m_objectManager->AllocateCheckpointId();
+    else if (m_previewObject->objectType == ObjectType::Ring)
+        std::static_pointer_cast<Ring>(m_previewObject)->ringId = m_objectManager->AllocateRingId();
+
     m_objectManager->AddObject(m_previewObject);
     LOG("Placed object : {}", m_previewObject->name);
     m_previewObject = m_previewObject->Clone();
@@ -229,7 +230,7 @@ void BuildMode::SetPreviewObjectType(ObjectType _objectType)
 {
     if (_objectType == ObjectType::Mesh)
     {
-        m_previewObject = std::make_shared<Mesh>(GetCurrentMesh());
+        m_previewObject = MakePooled<Mesh>(GetCurrentMesh());
         std::static_pointer_cast<Mesh>(m_previewObject)->SpawnInstance();
         SetCurrentObjectEditingProperties(OBJECT_EDITING_PROPERTIES_MESH);
         LOG("Set preview object type to Mesh");
@@ -238,27 +239,27 @@ void BuildMode::SetPreviewObjectType(ObjectType _objectType)
     {
         if (m_previewObject_triggerVolumeType == TriggerVolumeType::Box)
         {
-            m_previewObject = std::make_shared<TriggerVolume_Box>();
+            m_previewObject = MakePooled<TriggerVolume_Box>();
             SetCurrentObjectEditingProperties(OBJECT_EDITING_PROPERTIES_TRIGGER_VOLUME_BOX);
             LOG("Set preview object type to TriggerVolume Box");
         }
         else if(m_previewObject_triggerVolumeType == TriggerVolumeType::Cylinder)
         {
-            m_previewObject = std::make_shared<TriggerVolume_Cylinder>();
+            m_previewObject = MakePooled<TriggerVolume_Cylinder>();
             SetCurrentObjectEditingProperties(OBJECT_EDITING_PROPERTIES_TRIGGER_VOLUME_CYLINDER);
             LOG("Set preview object type to TriggerVolume Cylinder");
         }
     }
     else if (_objectType == ObjectType::Checkpoint)
     {
-        m_previewObject = std::make_shared<Checkpoint>();
+        m_previewObject = MakePooled<Checkpoint>();
 		SetCurrentObjectEditingProperties(OBJECT_EDITING_PROPERTIES_CHECKPOINT);
         LOG("Set preview object type to Checkpoint");
     }
     else if (_objectType == ObjectType::Ring)
     {
-        m_previewObject = std::make_shared<Ring_Small>(m_objectManager->GetRings().size());
-        std::static_pointer_cast<Ring>(m_previewObject)->mesh.SpawnInstance();
+        m_previewObject = PrefabLibrary::Get().Instantiate(RingSmallPrefab, m_objectManager->AllocateRingId());
+        std::static_pointer_cast<Ring>(m_previewObject)->SpawnMesh();
         SetCurrentObjectEditingProperties(OBJECT_EDITING_PROPERTIES_RING);
         LOG("Set preview object type to Ring");
     }
@@ -359,12 +360,12 @@ void BuildMode::SetPreviewObjectTriggerVolumeType(const TriggerVolumeType& _trig
 {
     if (m_previewObject_triggerVolumeType == TriggerVolumeType::Box)
     {
-        m_previewObject = std::make_shared<TriggerVolume_Box>(*std::static_pointer_cast<TriggerVolume>(m_previewObject)); //convert trigger volume
+        m_previewObject = MakePooled<TriggerVolume_Box>(*std::static_pointer_cast<TriggerVolume>(m_previewObject)); //convert trigger volume
         SetCurrentObjectEditingProperties(OBJECT_EDITING_PROPERTIES_TRIGGER_VOLUME_BOX);
     }
     else if (m_previewObject_triggerVolumeType == TriggerVolumeType::Cylinder)
     {
-        m_previewObject = std::make_shared<TriggerVolume_Cylinder>(*std::static_pointer_cast<TriggerVolume>(m_previewObject)); //convert trigger volume
+        m_previewObject = MakePooled<TriggerVolume_Cylinder>(*std::static_pointer_cast<TriggerVolume>(m_previewObject)); //convert trigger volume
 		SetCurrentObjectEditingProperties(OBJECT_EDITING_PROPERTIES_TRIGGER_VOLUME_CYLINDER);
     }
     else
@@ -379,4 +380,11 @@ void BuildMode::SetPreviewObjectTriggerVolumeType(const TriggerVolumeType& _trig
 MeshInfos BuildMode::GetCurrentMesh()
 {
     return m_availableMeshes[m_availableMeshesIndex];
-}
\ No newline at end of file
+}
+
+void BuildMode::SetAvailableMeshes(const std::vector<MeshInfos>& _availableMeshes)
+{
+    m_availableMeshes = _availableMeshes;
+    if (m_availableMeshesIndex >= m_availableMeshes.size())
+        m_availableMeshesIndex = m_availableMeshes.empty() ? 0 : static_cast<int>(m_availableMeshes.size()) - 1;
+}
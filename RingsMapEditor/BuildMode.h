@@ -19,6 +19,8 @@ public:
 
 public:
     void RenderObjectsCanvas(CanvasWrapper _canvas);
+    uint64_t ComputeHudKey();
+    void BuildHud();
     void SetPreviewObjectType(ObjectType _objectType);
     void PreviousObjectType();
     void NextObjectType();
@@ -28,6 +30,7 @@ public:
     void NextTriggerVolume();
 	void SetPreviewObjectTriggerVolumeType(const TriggerVolumeType& _triggerVolumeType);
     MeshInfos GetCurrentMesh();
+    void SetAvailableMeshes(const std::vector<MeshInfos>& _availableMeshes);
 
 private:
     ObjectType m_previewObjectType = ObjectType::Mesh;
@@ -27,9 +27,12 @@ public:
 	~Checkpoint() {}
 
 	void Render(CanvasWrapper canvas, CameraWrapper camera) {
-        triggerVolume.Render(canvas, camera);
+        RT::Frustum frustum(canvas, camera);
+        Render(canvas, frustum);
+	}
 
-        RT::Frustum frustum(canvas, camera);  // Create frustum (use default constructor or initialize as needed)
+	void Render(CanvasWrapper canvas, RT::Frustum& frustum) {
+        triggerVolume.Render(canvas, frustum);
 
         //render spawn location
         canvas.SetColor(0, 255, 0, 255); // Green color for spawn location
@@ -44,6 +47,11 @@ public:
         }
 	}
 
+    float GetBoundingRadius() const override {
+        Vector spawnOffset = spawnLocation_offset;
+        return max(triggerVolume.GetBoundingRadius(), spawnOffset.magnitude());
+    }
+
     void SetLocation(const Vector& _newLocation) override {
         location = _newLocation;
         triggerVolume.SetLocation(_newLocation);
@@ -74,24 +82,9 @@ public:
 		return checkpointType == CheckpointType::End;
 	}
 
-    nlohmann::json to_json() const override {
-        return {
-            {"objectType", static_cast<uint8_t>(objectType)},
-            {"name", name},
-            {"location", location},
-            {"rotation", rotation},
-            {"scale", scale},
-            {"checkpointId", checkpointId},
-            {"checkpointType", static_cast<uint8_t>(checkpointType)},
-            {"triggerVolume", triggerVolume.to_json()},
-            {"spawnLocation_offset", spawnLocation_offset},
-            {"spawnRotation", spawnRotation},
-        };
-    }
-
     //Would be better if I Clone() for triggerVolume. But I would first need to store it as shared_ptr
     std::shared_ptr<Object> Clone() override {
-        std::shared_ptr<Checkpoint> clonedCheckpoint = std::make_shared<Checkpoint>(*this);
+        std::shared_ptr<Checkpoint> clonedCheckpoint = MakePooled<Checkpoint>(*this);
         clonedCheckpoint->triggerVolume.onTouchCallback = (clonedCheckpoint->triggerVolume.onTouchCallback ? clonedCheckpoint->triggerVolume.onTouchCallback->Clone() : nullptr);
         return clonedCheckpoint;
     }
@@ -0,0 +1,172 @@
+#include "pch.h"
+#include <algorithm>
+#include <cmath>
+#include "CoursePath.h"
+
+
+CoursePath::CoursePath()
+	: m_chevron(Vector(0.f, 0.f, 0.f), Quat(), 60.f, 40.f, 15.f, 0.f, 0.f)
+{
+}
+
+
+
+void CoursePath::Update(const std::vector<std::shared_ptr<Ring>>& _rings)
+{
+	uint64_t fingerprint = ComputeRingsFingerprint(_rings);
+	if (fingerprint != m_bakedFingerprint)
+	{
+		Bake(_rings);
+		m_bakedFingerprint = fingerprint;
+	}
+}
+
+void CoursePath::Bake(const std::vector<std::shared_ptr<Ring>>& _rings)
+{
+	m_segments.clear();
+	m_controlPoints.clear();
+	m_totalLength = 0.f;
+
+	std::vector<Ring*> sortedRings;
+	sortedRings.reserve(_rings.size());
+	for (const std::shared_ptr<Ring>& ring : _rings)
+	{
+		sortedRings.push_back(ring.get());
+	}
+
+	std::stable_sort(sortedRings.begin(), sortedRings.end(), [](const Ring* a, const Ring* b) {
+		return a->ringId < b->ringId;
+		});
+
+	for (const Ring* ring : sortedRings)
+	{
+		m_controlPoints.push_back(ring->location);
+	}
+
+	if (m_controlPoints.size() < 2)
+		return;
+
+	for (size_t i = 0; i + 1 < m_controlPoints.size(); i++)
+	{
+		//Duplicate the end points so the curve still goes through the first and last ring
+		const Vector& p0 = m_controlPoints[i == 0 ? i : i - 1];
+		const Vector& p1 = m_controlPoints[i];
+		const Vector& p2 = m_controlPoints[i + 1];
+		const Vector& p3 = m_controlPoints[min(i + 2, m_controlPoints.size() - 1)];
+
+		Vector chord = p2 - p1;
+		int samples = max(1, static_cast<int>(ceilf(chord.magnitude() / m_sampleSpacing)));
+
+		Vector previous = p1;
+		for (int s = 1; s <= samples; s++)
+		{
+			Vector current = CatmullRom(p0, p1, p2, p3, static_cast<float>(s) / samples);
+			AddSegment(previous, current);
+			previous = current;
+		}
+	}
+
+	LOG("Baked course path : {} rings, {} segments, {:.0f} units", sortedRings.size(), m_segments.size(), m_totalLength);
+}
+
+void CoursePath::Render(CanvasWrapper _canvas, RT::Frustum& _frustum, float _secondsElapsed)
+{
+	if (!m_enabled)
+		return;
+
+	_canvas.SetColor(255, 200, 0, 200);
+
+	for (const CoursePathSegment& segment : m_segments)
+	{
+		if (!_frustum.IsInFrustum(segment.boundsCenter, segment.boundsRadius))
+			continue;
+
+		//Shift the animation by the arc length so chevrons flow continuously from one segment to the next.
+		//DrawAlongLine only truncates toward zero, so wrap the phase into one animation period ourselves
+		float period = (segment.length + m_chevron.GetFullLength()) / m_chevronSpeed;
+		float segmentSeconds = fmodf(_secondsElapsed, period) - fmodf(segment.arcLengthStart / m_chevronSpeed, period);
+		if (segmentSeconds < 0.f)
+			segmentSeconds += period;
+
+		m_chevron.orientation = segment.orientation;
+		m_chevron.DrawAlongLine(_canvas, _frustum, segment.start, segment.end, m_chevronGap, m_chevronSpeed, segmentSeconds);
+	}
+}
+
+bool CoursePath::IsEnabled() const
+{
+	return m_enabled;
+}
+
+void CoursePath::SetEnabled(bool _enabled)
+{
+	m_enabled = _enabled;
+}
+
+float CoursePath::GetTotalLength() const
+{
+	return m_totalLength;
+}
+
+const std::vector<CoursePathSegment>& CoursePath::GetSegments() const
+{
+	return m_segments;
+}
+
+uint64_t CoursePath::ComputeRingsFingerprint(const std::vector<std::shared_ptr<Ring>>& _rings)
+{
+	//FNV-1a over the ring ids and locations, cheap enough to run every frame
+	uint64_t hash = 14695981039346656037ull;
+	auto hashBytes = [&hash](const void* _data, size_t _size) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(_data);
+		for (size_t i = 0; i < _size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		};
+
+	size_t count = _rings.size();
+	hashBytes(&count, sizeof(count));
+
+	for (const std::shared_ptr<Ring>& ring : _rings)
+	{
+		hashBytes(&ring->ringId, sizeof(ring->ringId));
+		hashBytes(&ring->location.X, sizeof(float) * 3);
+	}
+
+	return hash;
+}
+
+Vector CoursePath::CatmullRom(const Vector& _p0, const Vector& _p1, const Vector& _p2, const Vector& _p3, float _t)
+{
+	float t2 = _t * _t;
+	float t3 = t2 * _t;
+
+	Vector a = _p1 * 2.f;
+	Vector b = (_p2 - _p0) * _t;
+	Vector c = (_p0 * 2.f - _p1 * 5.f + _p2 * 4.f - _p3) * t2;
+	Vector d = (_p1 * 3.f - _p0 - _p2 * 3.f + _p3) * t3;
+
+	return (a + b + c + d) * 0.5f;
+}
+
+void CoursePath::AddSegment(const Vector& _start, const Vector& _end)
+{
+	Vector direction = _end - _start;
+	float length = direction.magnitude();
+	if (length < 0.001f)
+		return;
+
+	CoursePathSegment segment;
+	segment.start = _start;
+	segment.end = _end;
+	segment.length = length;
+	segment.arcLengthStart = m_totalLength;
+	segment.orientation = RT::LookAt(_start, _end, LookAtAxis::AXIS_FORWARD).ToQuat();
+	segment.boundsCenter = (_start + _end) * 0.5f;
+	segment.boundsRadius = length * 0.5f + m_chevron.GetFullLength();
+
+	m_segments.emplace_back(segment);
+	m_totalLength += length;
+}
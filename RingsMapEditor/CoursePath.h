@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Ring.h"
+
+struct CoursePathSegment
+{
+	Vector start;
+	Vector end;
+	Quat orientation;
+	float length = 0.f;
+	float arcLengthStart = 0.f; // distance along the whole path where this segment begins
+	Vector boundsCenter;
+	float boundsRadius = 0.f;
+};
+
+//Route going through the ring centres in ringId order, smoothed with a Catmull-Rom spline.
+//The polyline is only rebuilt when a ring is added, removed, moved or renumbered.
+class CoursePath
+{
+public:
+	CoursePath();
+	~CoursePath() = default;
+
+	void Update(const std::vector<std::shared_ptr<Ring>>& _rings);
+	void Bake(const std::vector<std::shared_ptr<Ring>>& _rings);
+	void Render(CanvasWrapper _canvas, RT::Frustum& _frustum, float _secondsElapsed);
+
+	bool IsEnabled() const;
+	void SetEnabled(bool _enabled);
+	float GetTotalLength() const;
+	const std::vector<CoursePathSegment>& GetSegments() const;
+
+private:
+	static uint64_t ComputeRingsFingerprint(const std::vector<std::shared_ptr<Ring>>& _rings);
+	static Vector CatmullRom(const Vector& _p0, const Vector& _p1, const Vector& _p2, const Vector& _p3, float _t);
+	void AddSegment(const Vector& _start, const Vector& _end);
+
+	bool m_enabled = true;
+	uint64_t m_bakedFingerprint = 0;
+	std::vector<CoursePathSegment> m_segments;
+	std::vector<Vector> m_controlPoints; //reused between bakes
+	float m_totalLength = 0.f;
+
+	//Settings
+	float m_sampleSpacing = 300.f; // approximate length of one polyline segment
+	float m_chevronGap = 150.f;
+	float m_chevronSpeed = 600.f; // cm/s
+	RT::Chevron m_chevron;
+};
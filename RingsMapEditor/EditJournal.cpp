@@ -0,0 +1,520 @@
+#include "pch.h"
+#include <algorithm>
+#include "EditJournal.h"
+#include "MappedFile.h"
+#include "ObjectDiff.h"
+#include "PrefabLibrary.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+	RmjTransform EncodeTransform(const Object& _object)
+	{
+		RmjTransform transform;
+		transform.location[0] = _object.location.X;
+		transform.location[1] = _object.location.Y;
+		transform.location[2] = _object.location.Z;
+		transform.rotation[0] = _object.rotation.Pitch;
+		transform.rotation[1] = _object.rotation.Yaw;
+		transform.rotation[2] = _object.rotation.Roll;
+		transform.scale = _object.scale;
+		return transform;
+	}
+
+	//A definition read later replaces the one with the same id, like PrefabLibrary::Register()
+	void AddPrefabs(std::vector<std::shared_ptr<const RingPrefab>>& _prefabs, const std::vector<std::shared_ptr<const RingPrefab>>& _newPrefabs)
+	{
+		for (const std::shared_ptr<const RingPrefab>& prefab : _newPrefabs)
+		{
+			auto it = std::find_if(_prefabs.begin(), _prefabs.end(), [&](const std::shared_ptr<const RingPrefab>& _prefab) { return _prefab->id == prefab->id; });
+			if (it != _prefabs.end())
+				*it = prefab;
+			else
+				_prefabs.push_back(prefab);
+		}
+	}
+
+	//A ring's user prefab is encoded with it, its definition goes to _prefabs
+	std::shared_ptr<Object> DecodeSingleObject(const uint8_t* _data, size_t _size, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<const RingPrefab>>& _prefabs)
+	{
+		std::vector<std::shared_ptr<Object>> objects;
+		MapExtras extras;
+		if (!BinaryMap::Decode(_data, _size, _triggerFunctions, objects, extras) || objects.size() != 1)
+			return nullptr;
+
+		AddPrefabs(_prefabs, extras.prefabs);
+		return objects[0];
+	}
+
+	//Parent indices follow the objects when they move by one place, children of a removed object are detached like in SceneGraph::OnRemoved()
+	void InsertParentIndex(std::vector<int32_t>& _parents, size_t _index)
+	{
+		for (int32_t& parent : _parents)
+		{
+			if (parent >= static_cast<int32_t>(_index))
+				parent++;
+		}
+
+		_parents.insert(_parents.begin() + _index, -1);
+	}
+
+	void RemoveParentIndex(std::vector<int32_t>& _parents, size_t _index)
+	{
+		for (int32_t& parent : _parents)
+		{
+			if (parent == static_cast<int32_t>(_index))
+				parent = -1;
+			else if (parent > static_cast<int32_t>(_index))
+				parent--;
+		}
+
+		_parents.erase(_parents.begin() + _index);
+	}
+
+	//Applies one record to the replayed scene, returns false when the record doesn't match the scene.
+	//_parents is empty until the scene has a link, then holds one parent index per object
+	bool ApplyRecord(const RmjRecordHeader& _record, const uint8_t* _body, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _objects,
+		std::vector<int32_t>& _parents, std::vector<std::shared_ptr<const RingPrefab>>& _prefabs)
+	{
+		const JournalOp op = static_cast<JournalOp>(_record.op);
+		const size_t index = _record.objectIndex;
+
+		if (op == JournalOp::Add)
+		{
+			std::shared_ptr<Object> object = DecodeSingleObject(_body, _record.size, _triggerFunctions, _prefabs);
+			if (!object || index > _objects.size())
+				return false;
+
+			_objects.insert(_objects.begin() + index, object);
+			if (!_parents.empty())
+				InsertParentIndex(_parents, index);
+			return true;
+		}
+
+		if (op == JournalOp::Prefab)
+		{
+			// The ring only carries the definition, it isn't part of the scene
+			std::shared_ptr<Object> object = DecodeSingleObject(_body, _record.size, _triggerFunctions, _prefabs);
+			return object && object->objectType == ObjectType::Ring && static_cast<const Ring&>(*object).prefab;
+		}
+
+		if (index >= _objects.size())
+			return false;
+
+		switch (op)
+		{
+		case JournalOp::Remove:
+			_objects.erase(_objects.begin() + index);
+			if (!_parents.empty())
+				RemoveParentIndex(_parents, index);
+			return true;
+
+		case JournalOp::Copy:
+		{
+			std::shared_ptr<Object> clonedObject = _objects[index]->Clone();
+			clonedObject->name += " (Copy)";
+			_objects.push_back(clonedObject);
+			if (!_parents.empty())
+				_parents.push_back(-1);
+			return true;
+		}
+
+		case JournalOp::Transform:
+		{
+			if (_record.size < sizeof(RmjTransform))
+				return false;
+
+			RmjTransform transform;
+			std::memcpy(&transform, _body, sizeof(RmjTransform));
+			_objects[index]->location = Vector(transform.location[0], transform.location[1], transform.location[2]);
+			_objects[index]->rotation = Rotator(transform.rotation[0], transform.rotation[1], transform.rotation[2]);
+			_objects[index]->scale = transform.scale;
+			return true;
+		}
+
+		case JournalOp::Property:
+		{
+			if (_record.size < sizeof(RmjProperty))
+				return false;
+
+			RmjProperty property;
+			std::memcpy(&property, _body, sizeof(RmjProperty));
+
+			Object& object = *_objects[index];
+			uint8_t subType = (object.objectType == ObjectType::TriggerVolume) ? static_cast<uint8_t>(static_cast<const TriggerVolume&>(object).triggerVolumeType) : 0;
+			if (property.objectType != static_cast<uint8_t>(object.objectType) || property.subType != subType)
+				return false;
+
+			// A ring linked to a prefab made since the snapshot finds it among the journaled definitions
+			return ObjectDiff::Apply(object, property.fieldMask, property.fieldsVersion, _body + sizeof(RmjProperty), _record.size - sizeof(RmjProperty), _triggerFunctions, &_prefabs);
+		}
+
+		case JournalOp::Convert:
+		{
+			if (_objects[index]->objectType != ObjectType::TriggerVolume)
+				return false;
+
+			const TriggerVolume& triggerVolume = static_cast<const TriggerVolume&>(*_objects[index]);
+			if (static_cast<TriggerVolumeType>(_record.subType) == TriggerVolumeType::Box)
+				_objects[index] = MakePooled<TriggerVolume_Box>(triggerVolume);
+			else if (static_cast<TriggerVolumeType>(_record.subType) == TriggerVolumeType::Cylinder)
+				_objects[index] = MakePooled<TriggerVolume_Cylinder>(triggerVolume);
+			else
+				return false;
+			return true;
+		}
+
+		case JournalOp::Parent:
+		{
+			int32_t parentIndex;
+			if (_record.size < sizeof(parentIndex))
+				return false;
+
+			std::memcpy(&parentIndex, _body, sizeof(parentIndex));
+			if (parentIndex < -1 || parentIndex >= static_cast<int32_t>(_objects.size()) || parentIndex == static_cast<int32_t>(index))
+				return false;
+
+			if (_parents.empty())
+				_parents.resize(_objects.size(), -1);
+			_parents[index] = parentIndex;
+			return true;
+		}
+
+		default:
+			return false;
+		}
+	}
+}
+
+
+
+EditJournal::EditJournal(const std::filesystem::path& _filePath, size_t _compactionThreshold)
+	: m_filePath(_filePath), m_compactionThreshold(_compactionThreshold)
+{
+	Rebase({});
+}
+
+EditJournal::~EditJournal()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_compaction.valid())
+		FinishCompaction();
+}
+
+bool EditJournal::Rebase(const std::vector<std::shared_ptr<Object>>& _objects, const std::vector<int32_t>& _parents)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// An in-flight compaction describes the previous scene, it's finished then thrown away
+	if (m_compaction.valid())
+		m_compaction.get();
+
+	m_file.close();
+	m_recordsSize = 0;
+	m_recordsSinceCompaction.clear();
+
+	std::filesystem::path tempPath = GetTempPath();
+	bool written = WriteSnapshotFile(tempPath, BinaryMap::Encode(_objects, _parents));
+
+	std::error_code error;
+	if (written)
+	{
+		std::filesystem::rename(tempPath, m_filePath, error);
+		if (error)
+			LOG("[ERROR]Could not move {} into place: {}", tempPath.string(), error.message());
+	}
+
+	if (!written || error)
+	{
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+
+	return OpenForAppend();
+}
+
+void EditJournal::RecordAdd(uint32_t _objectIndex, const std::shared_ptr<Object>& _object)
+{
+	std::vector<uint8_t> body = BinaryMap::Encode({ _object });
+	Append(JournalOp::Add, 0, _objectIndex, body.data(), static_cast<uint32_t>(body.size()));
+}
+
+void EditJournal::RecordRemove(uint32_t _objectIndex)
+{
+	Append(JournalOp::Remove, 0, _objectIndex, nullptr, 0);
+}
+
+void EditJournal::RecordCopy(uint32_t _objectIndex)
+{
+	Append(JournalOp::Copy, 0, _objectIndex, nullptr, 0);
+}
+
+void EditJournal::RecordTransform(uint32_t _objectIndex, const Object& _object)
+{
+	RmjTransform transform = EncodeTransform(_object);
+	Append(JournalOp::Transform, 0, _objectIndex, &transform, sizeof(RmjTransform));
+}
+
+void EditJournal::RecordProperty(uint32_t _objectIndex, const Object& _object, uint64_t _fieldMask)
+{
+	RmjProperty property;
+	property.objectType = static_cast<uint8_t>(_object.objectType);
+	property.subType = (_object.objectType == ObjectType::TriggerVolume) ? static_cast<uint8_t>(static_cast<const TriggerVolume&>(_object).triggerVolumeType) : 0;
+	property.fieldsVersion = ObjectFieldsVersion;
+	property.fieldMask = _fieldMask;
+
+	std::vector<uint8_t> body(sizeof(RmjProperty));
+	std::memcpy(body.data(), &property, sizeof(RmjProperty));
+	ObjectDiff::Encode(_object, _fieldMask, body);
+
+	Append(JournalOp::Property, 0, _objectIndex, body.data(), static_cast<uint32_t>(body.size()));
+}
+
+void EditJournal::RecordConvert(uint32_t _objectIndex, TriggerVolumeType _triggerVolumeType)
+{
+	Append(JournalOp::Convert, static_cast<uint8_t>(_triggerVolumeType), _objectIndex, nullptr, 0);
+}
+
+void EditJournal::RecordParent(uint32_t _objectIndex, int32_t _parentIndex)
+{
+	Append(JournalOp::Parent, 0, _objectIndex, &_parentIndex, sizeof(_parentIndex));
+}
+
+void EditJournal::RecordPrefab(const std::shared_ptr<const RingPrefab>& _prefab)
+{
+	// A ring made from the template is the smallest .rme buffer that stores it
+	std::vector<uint8_t> body = BinaryMap::Encode({ PrefabLibrary::Instantiate(_prefab, 0) });
+	Append(JournalOp::Prefab, 0, 0, body.data(), static_cast<uint32_t>(body.size()));
+}
+
+void EditJournal::Update(const std::shared_ptr<const SceneSnapshot>& _snapshot)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_compaction.valid())
+	{
+		if (m_compaction.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			FinishCompaction();
+		return;
+	}
+
+	if (m_recordsSize < m_compactionThreshold || !m_file.is_open())
+		return;
+
+	// Every record appended from now on lands in m_recordsSinceCompaction, the published snapshot is immutable so it's read on the worker
+	m_recordsSinceCompaction.clear();
+	m_compaction = std::async(std::launch::async, [tempPath = GetTempPath(), _snapshot]() {
+		std::vector<std::shared_ptr<Object>> objects;
+		std::vector<int32_t> parents;
+		_snapshot->GetObjects(objects);
+		_snapshot->GetParents(parents);
+		return WriteSnapshotFile(tempPath, BinaryMap::Encode(objects, parents));
+		});
+}
+
+bool EditJournal::Recover(const std::filesystem::path& _filePath, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects, MapExtras& _outExtras)
+{
+	MappedFile file;
+	if (!file.Open(_filePath))
+	{
+		LOG("[ERROR]Could not open edit journal: {}", _filePath.string());
+		return false;
+	}
+
+	const uint8_t* data = file.Data();
+	const size_t size = file.Size();
+
+	RmjHeader header;
+	if (size < sizeof(RmjHeader))
+	{
+		LOG("[ERROR]Edit journal is too small: {}", _filePath.string());
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(RmjHeader));
+
+	if (std::memcmp(header.magic, RmjMagic, sizeof(RmjMagic)) != 0 || header.version != RmjVersion || header.headerSize < sizeof(RmjHeader))
+	{
+		LOG("[ERROR]Not a supported edit journal: {}", _filePath.string());
+		return false;
+	}
+
+	size_t offset = header.headerSize;
+	if (header.snapshotSize > size - std::min<size_t>(offset, size))
+	{
+		LOG("[ERROR]Edit journal snapshot is truncated: {}", _filePath.string());
+		return false;
+	}
+
+	std::vector<std::shared_ptr<Object>> objects;
+	MapExtras extras;
+	if (!BinaryMap::Decode(data + offset, header.snapshotSize, _triggerFunctions, objects, extras))
+		return false;
+	offset += header.snapshotSize;
+
+	size_t replayedRecords = 0;
+	while (offset + sizeof(RmjRecordHeader) <= size)
+	{
+		RmjRecordHeader record;
+		std::memcpy(&record, data + offset, sizeof(RmjRecordHeader));
+
+		const uint8_t* body = data + offset + sizeof(RmjRecordHeader);
+		if (record.size > size - offset - sizeof(RmjRecordHeader))
+			break; // cut short by a crash
+
+		if (!ApplyRecord(record, body, _triggerFunctions, objects, extras.parents, extras.prefabs))
+		{
+			LOG("[ERROR]Edit journal record {} (op {}, object {}) doesn't match the scene, replay stopped there", replayedRecords, record.op, record.objectIndex);
+			break;
+		}
+
+		offset += sizeof(RmjRecordHeader) + record.size;
+		replayedRecords++;
+	}
+
+	if (offset != size)
+		LOG("Edit journal {} ends with {} unreadable bytes, they were ignored", _filePath.string(), size - offset);
+
+	LOG("Recovered {} objects from {} ({} edits replayed)", objects.size(), _filePath.string(), replayedRecords);
+
+	if (!extras.parents.empty())
+	{
+		const int32_t firstIndex = static_cast<int32_t>(_outObjects.size());
+		_outExtras.parents.resize(_outObjects.size(), -1);
+		for (int32_t parent : extras.parents)
+			_outExtras.parents.push_back(parent >= 0 ? parent + firstIndex : -1);
+	}
+	_outExtras.prefabs.insert(_outExtras.prefabs.end(), extras.prefabs.begin(), extras.prefabs.end());
+	_outObjects.insert(_outObjects.end(), objects.begin(), objects.end());
+	return true;
+}
+
+void EditJournal::Append(JournalOp _op, uint8_t _subType, uint32_t _objectIndex, const void* _body, uint32_t _bodySize)
+{
+	RmjRecordHeader record = {};
+	record.op = static_cast<uint8_t>(_op);
+	record.subType = _subType;
+	record.objectIndex = _objectIndex;
+	record.size = _bodySize;
+
+	// One write per record, a crash can only ever cut the last one
+	uint8_t stackBuffer[sizeof(RmjRecordHeader) + sizeof(RmjTransform)];
+	std::vector<uint8_t> heapBuffer;
+	uint8_t* buffer = stackBuffer;
+	size_t recordSize = sizeof(RmjRecordHeader) + _bodySize;
+	if (recordSize > sizeof(stackBuffer))
+	{
+		heapBuffer.resize(recordSize);
+		buffer = heapBuffer.data();
+	}
+
+	std::memcpy(buffer, &record, sizeof(RmjRecordHeader));
+	if (_bodySize > 0)
+		std::memcpy(buffer + sizeof(RmjRecordHeader), _body, _bodySize);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_file.is_open())
+		return;
+
+	m_file.write(reinterpret_cast<const char*>(buffer), recordSize);
+	m_file.flush();
+	if (!m_file)
+	{
+		LOG("[ERROR]Failed to append to edit journal: {}", m_filePath.string());
+		m_file.clear();
+		return;
+	}
+
+	m_recordsSize += recordSize;
+
+	if (m_compaction.valid())
+		m_recordsSinceCompaction.insert(m_recordsSinceCompaction.end(), buffer, buffer + recordSize);
+}
+
+//Called with m_mutex held, so no record can slip between the compacted file and m_recordsSinceCompaction
+void EditJournal::FinishCompaction()
+{
+	bool written = m_compaction.get();
+
+	std::filesystem::path tempPath = GetTempPath();
+	std::error_code error;
+
+	if (written)
+	{
+		std::ofstream tempFile = std::ofstream(tempPath, std::ios::binary | std::ios::app);
+		tempFile.write(reinterpret_cast<const char*>(m_recordsSinceCompaction.data()), m_recordsSinceCompaction.size());
+		written = static_cast<bool>(tempFile);
+	}
+
+	if (written)
+	{
+		m_file.close();
+		std::filesystem::rename(tempPath, m_filePath, error);
+		if (error)
+			LOG("[ERROR]Could not move {} into place: {}", tempPath.string(), error.message());
+		else
+			m_recordsSize = m_recordsSinceCompaction.size();
+
+		OpenForAppend();
+	}
+
+	if (!written || error)
+	{
+		// The current file still holds every edit, compaction is retried once it has grown twice as much
+		LOG("[ERROR]Edit journal compaction failed: {}", m_filePath.string());
+		std::filesystem::remove(tempPath, error);
+		m_compactionThreshold *= 2;
+	}
+
+	m_recordsSinceCompaction.clear();
+	m_recordsSinceCompaction.shrink_to_fit();
+}
+
+bool EditJournal::OpenForAppend()
+{
+	m_file.open(m_filePath, std::ios::binary | std::ios::app);
+	if (!m_file.is_open())
+	{
+		LOG("[ERROR]Could not open edit journal for writing: {}", m_filePath.string());
+		return false;
+	}
+
+	return true;
+}
+
+std::filesystem::path EditJournal::GetTempPath() const
+{
+	std::filesystem::path tempPath = m_filePath;
+	tempPath += ".tmp";
+	return tempPath;
+}
+
+bool EditJournal::WriteSnapshotFile(const std::filesystem::path& _filePath, const std::vector<uint8_t>& _snapshot)
+{
+	RmjHeader header;
+	std::memcpy(header.magic, RmjMagic, sizeof(RmjMagic));
+	header.version = RmjVersion;
+	header.headerSize = sizeof(RmjHeader);
+	header.snapshotSize = static_cast<uint32_t>(_snapshot.size());
+
+	std::ofstream file = std::ofstream(_filePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG("[ERROR]Could not open edit journal snapshot for writing: {}", _filePath.string());
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(RmjHeader));
+	file.write(reinterpret_cast<const char*>(_snapshot.data()), _snapshot.size());
+	if (!file)
+	{
+		LOG("[ERROR]Failed to write edit journal snapshot: {}", _filePath.string());
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include "BinaryMap.h"
+#include "SceneSnapshot.h"
+
+#include <fstream>
+#include <future>
+#include <mutex>
+
+enum class JournalOp : uint8_t
+{
+	Add = 1,        // body : the object encoded as a one-object .rme buffer, inserted at objectIndex
+	Remove = 2,     // no body, the objects after objectIndex move down one place
+	Copy = 3,       // no body, objectIndex is the copied object, the copy goes last
+	Transform = 4,  // body : RmjTransform
+	Property = 5,   // body : RmjProperty followed by an ObjectDiff of the changed fields
+	Convert = 6,    // no body, subType is the new TriggerVolumeType
+	Parent = 8,     // body : int32 index of the new parent of objectIndex, -1 to detach it
+	Prefab = 9      // body : a one-ring .rme buffer holding the definition of a user prefab, made or replaced since. objectIndex is unused
+};
+
+//.rmj layout :
+//  RmjHeader
+//  snapshot : a full .rme buffer of snapshotSize bytes, the scene and its parent links the records apply to
+//  records  : RmjRecordHeader followed by its body, appended one per edit
+//A record cut short by a crash is ignored, every complete record before it is replayed.
+#pragma pack(push, 1)
+
+struct RmjHeader
+{
+	char magic[4];
+	uint16_t version;
+	uint16_t headerSize;
+	uint32_t snapshotSize;
+};
+
+struct RmjRecordHeader
+{
+	uint8_t op;
+	uint8_t subType;
+	uint16_t padding;
+	uint32_t objectIndex; // index in ObjectManager::m_objects at the time of the edit
+	uint32_t size;        // body size in bytes, not counting this header
+};
+
+struct RmjTransform
+{
+	float location[3];
+	int32_t rotation[3];
+	float scale;
+};
+
+struct RmjProperty
+{
+	uint8_t objectType;
+	uint8_t subType;        // TriggerVolumeType for trigger volumes, 0 otherwise
+	uint16_t fieldsVersion; // ObjectFieldsVersion the field mask refers to
+	uint64_t fieldMask;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(RmjHeader) == 12);
+static_assert(sizeof(RmjRecordHeader) == 12);
+static_assert(sizeof(RmjTransform) == 28);
+static_assert(sizeof(RmjProperty) == 12);
+
+constexpr char RmjMagic[4] = { 'R', 'M', 'E', 'J' };
+constexpr uint16_t RmjVersion = 7;
+constexpr const char* RmjExtension = ".rmj";
+
+//Append-only autosave journal.
+//Every edit routed through ObjectManager appends a small record and flushes it, a transform edit costs 40 bytes
+//and other edits only store the fields that changed.
+//Once the records grow past the compaction threshold, Update() folds them into a fresh snapshot on a worker thread :
+//records keep going to the current file meanwhile and are copied over when the new file is swapped in,
+//so the file on disk always holds a snapshot plus every edit made since.
+class EditJournal
+{
+public:
+	EditJournal(const std::filesystem::path& _filePath, size_t _compactionThreshold = 256 * 1024);
+	~EditJournal();
+
+	// Synchronously replaces the journal with a snapshot of _objects and no records, used when a whole map is loaded
+	bool Rebase(const std::vector<std::shared_ptr<Object>>& _objects, const std::vector<int32_t>& _parents = {});
+
+	void RecordAdd(uint32_t _objectIndex, const std::shared_ptr<Object>& _object);
+	void RecordRemove(uint32_t _objectIndex);
+	void RecordCopy(uint32_t _objectIndex);
+	void RecordTransform(uint32_t _objectIndex, const Object& _object);
+	void RecordProperty(uint32_t _objectIndex, const Object& _object, uint64_t _fieldMask);
+	void RecordConvert(uint32_t _objectIndex, TriggerVolumeType _triggerVolumeType);
+	void RecordParent(uint32_t _objectIndex, int32_t _parentIndex);
+	void RecordPrefab(const std::shared_ptr<const RingPrefab>& _prefab);
+
+	// Starts a background compaction when needed and swaps in the compacted file once it's written.
+	// _snapshot has to hold every edit recorded so far, it's only read on the worker thread
+	void Update(const std::shared_ptr<const SceneSnapshot>& _snapshot);
+
+	const std::filesystem::path& GetFilePath() const { return m_filePath; }
+	size_t GetRecordsSize() const { return m_recordsSize; }
+
+	// Replays snapshot + records, stops at the first incomplete or invalid record
+	static bool Recover(const std::filesystem::path& _filePath, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects, MapExtras& _outExtras);
+
+private:
+	void Append(JournalOp _op, uint8_t _subType, uint32_t _objectIndex, const void* _body, uint32_t _bodySize);
+	void FinishCompaction();
+	bool OpenForAppend();
+	std::filesystem::path GetTempPath() const;
+
+	static bool WriteSnapshotFile(const std::filesystem::path& _filePath, const std::vector<uint8_t>& _snapshot);
+
+	std::filesystem::path m_filePath;
+	size_t m_compactionThreshold;
+
+	std::mutex m_mutex; // edits come from both the game thread and the ImGui render thread
+	std::ofstream m_file;
+	size_t m_recordsSize = 0;
+
+	std::future<bool> m_compaction;
+	std::vector<uint8_t> m_recordsSinceCompaction; // copied at the end of the compacted file when it's swapped in
+};
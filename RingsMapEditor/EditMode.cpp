@@ -28,6 +28,8 @@ void EditMode::Enable()
 
 void EditMode::Disable()
 {
+    m_objectManager->CommitEdit(m_edit);
+    m_edit = ObjectEdit();
     m_previewObject = nullptr;
     UnregisterCommands();
     UnhookEvents();
@@ -94,6 +96,10 @@ void EditMode::OnTick(float _deltaTime)
 
         m_previewObject->SetLocation(CalculatePreviewActorLocation(camera));
         m_previewObject->SetRotation(m_previewObjectRotation);
+        m_previewObject->UpdateChildren();
+
+        //Objects parented to it follow on the next tick
+        m_objectManager->MarkTransformDirty(m_objectManager->GetHandle(m_previewObject.get()));
     }
 }
 
@@ -103,116 +109,83 @@ void EditMode::RenderCanvas(CanvasWrapper _canvas)
 
 	RenderCrosshair(_canvas);
 
-    _canvas.SetColor(255, 255, 255, 255);
+    if (m_hud.Update(ComputeHudKey()))
+    {
+        BuildHud();
+    }
 
-    float stringScale = 2.f;
-    float newLinePaddingY = 15.f * stringScale;
-    Vector2 pos = Vector2{ 20, 80 };
+    m_hud.Render(_canvas);
+}
 
-    auto newLine = [&]() {
-        pos.Y += newLinePaddingY;
-        _canvas.SetPosition(pos);
-        };
+uint64_t EditMode::ComputeHudKey()
+{
+    std::shared_ptr<Object>& displayedObject = m_previewObject ? m_previewObject : m_objectUnderCursor;
 
-    _canvas.SetPosition(pos);
-    _canvas.DrawString("Edit Mode", stringScale, stringScale);
-    newLine();
+    uint64_t key = reinterpret_cast<uintptr_t>(m_previewObject.get());
+    key = HudText::Combine(key, reinterpret_cast<uintptr_t>(m_objectUnderCursor.get()));
 
-    if (m_previewObject)
+    if (displayedObject)
     {
-        std::string objectNameText = "Object : " + m_previewObject->name;
-        _canvas.DrawString(objectNameText, stringScale, stringScale);
+        key = HudText::Combine(key, HudText::Hash(displayedObject->name));
 
-        if (m_previewObject->objectType == ObjectType::Mesh)
-        {
-            newLine();
-            _canvas.DrawString("Mesh", stringScale, stringScale);
+        if (displayedObject->objectType == ObjectType::Mesh)
+            key = HudText::Combine(key, HudText::Hash(std::static_pointer_cast<Mesh>(displayedObject)->meshInfos.name));
+    }
 
-            newLine();
-            std::string meshText = "Mesh : " + std::static_pointer_cast<Mesh>(m_previewObject)->meshInfos.name;
-            _canvas.DrawString(meshText, stringScale, stringScale);
-        }
-        else if (m_previewObject->objectType == ObjectType::TriggerVolume)
-        {
-            newLine();
-            _canvas.DrawString("Trigger Volume", stringScale, stringScale);
-
-            newLine();
-            newLine();
-            std::string triggerVolumeTypeText = "Trigger Volume Type : ";
-            if (std::static_pointer_cast<TriggerVolume>(m_previewObject)->triggerVolumeType == TriggerVolumeType::Box)
-                triggerVolumeTypeText += "Box";
-            else if (std::static_pointer_cast<TriggerVolume>(m_previewObject)->triggerVolumeType == TriggerVolumeType::Cylinder)
-                triggerVolumeTypeText += "Cylinder";
-            else
-                triggerVolumeTypeText += "Unknown";
-
-            _canvas.DrawString(triggerVolumeTypeText, stringScale, stringScale);
-        }
-        else if (m_previewObject->objectType == ObjectType::Checkpoint)
-        {
-            newLine();
-            _canvas.DrawString("Checkpoint", stringScale, stringScale);
-        }
-        else if (m_previewObject->objectType == ObjectType::Ring)
-        {
-            newLine();
-            _canvas.DrawString("Ring", stringScale, stringScale);
-        }
+    if (m_previewObject)
+        key = HudText::Combine(key, reinterpret_cast<uintptr_t>(&GetCurrentEditingProperty()));
 
-        newLine();
-        newLine();
-        newLine();
-        std::string editingText = "Editing : ";
-        editingText += GetCurrentEditingProperty().name;
-        _canvas.DrawString(editingText, stringScale, stringScale);
-    }
-    else if (m_objectUnderCursor)
-    {
-        std::string objectNameText = "Object : " + m_objectUnderCursor->name;
-        _canvas.DrawString(objectNameText, stringScale, stringScale);
+    return key;
+}
 
-        if (m_objectUnderCursor->objectType == ObjectType::Mesh)
-        {
-            newLine();
-            _canvas.DrawString("Mesh", stringScale, stringScale);
+void EditMode::BuildHud()
+{
+    m_hud.SetLine(0, "Edit Mode");
 
-            newLine();
-            std::string meshText = "Mesh : " + std::static_pointer_cast<Mesh>(m_objectUnderCursor)->meshInfos.name;
-            _canvas.DrawString(meshText, stringScale, stringScale);
-        }
-        else if (m_objectUnderCursor->objectType == ObjectType::TriggerVolume)
-        {
-            newLine();
-            _canvas.DrawString("Trigger Volume", stringScale, stringScale);
-
-            newLine();
-            newLine();
-            std::string triggerVolumeTypeText = "Trigger Volume Type : ";
-            if (std::static_pointer_cast<TriggerVolume>(m_objectUnderCursor)->triggerVolumeType == TriggerVolumeType::Box)
-                triggerVolumeTypeText += "Box";
-            else if (std::static_pointer_cast<TriggerVolume>(m_objectUnderCursor)->triggerVolumeType == TriggerVolumeType::Cylinder)
-                triggerVolumeTypeText += "Cylinder";
-            else
-                triggerVolumeTypeText += "Unknown";
-
-            _canvas.DrawString(triggerVolumeTypeText, stringScale, stringScale);
-        }
-        else if (m_objectUnderCursor->objectType == ObjectType::Checkpoint)
-        {
-            newLine();
-            _canvas.DrawString("Checkpoint", stringScale, stringScale);
-        }
-        else if (m_objectUnderCursor->objectType == ObjectType::Ring)
-        {
-            newLine();
-            _canvas.DrawString("Ring", stringScale, stringScale);
-        }
+    std::shared_ptr<Object>& displayedObject = m_previewObject ? m_previewObject : m_objectUnderCursor;
+    if (!displayedObject)
+        return;
+
+    m_hud.SetLine(1, "Object : {}", displayedObject->name);
+
+    int editingRow = 0;
+
+    if (displayedObject->objectType == ObjectType::Mesh)
+    {
+        m_hud.SetLine(2, "Mesh");
+        m_hud.SetLine(3, "Mesh : {}", std::static_pointer_cast<Mesh>(displayedObject)->meshInfos.name);
+        editingRow = 6;
     }
+    else if (displayedObject->objectType == ObjectType::TriggerVolume)
+    {
+        m_hud.SetLine(2, "Trigger Volume");
+        m_hud.SetLine(4, "Trigger Volume Type : {}", GetTriggerVolumeTypeName(displayedObject));
+        editingRow = 7;
+    }
+    else if (displayedObject->objectType == ObjectType::Checkpoint)
+    {
+        m_hud.SetLine(2, "Checkpoint");
+        editingRow = 5;
+    }
+    else if (displayedObject->objectType == ObjectType::Ring)
+    {
+        m_hud.SetLine(2, "Ring");
+        editingRow = 5;
+    }
+    else
+    {
+        editingRow = 4;
+    }
+
+    //Only the selected object can be edited
+    if (m_previewObject)
+        m_hud.SetLine(editingRow, "Editing : {}", GetCurrentEditingProperty().name);
 }
 
 void EditMode::PlaceObject()
 {
+    m_objectManager->CommitEdit(m_edit);
+    m_edit = ObjectEdit();
 	m_previewObject = nullptr;
 }
 
@@ -257,6 +230,7 @@ void EditMode::SelectObject()
 	m_previewObject_distance = CalculateDistanceToObject(m_objectUnderCursor);
     m_previewObjectRotation = m_objectUnderCursor->GetRotation();
     m_previewObject = m_objectUnderCursor;
+    m_edit = m_objectManager->BeginEdit(m_previewObject);
     SetCurrentObjectEditingProperties(m_objectUnderCursor->objectType);
 	LOG("Selected object : {}", m_previewObject->name);
 }
@@ -364,7 +338,7 @@ std::shared_ptr<Object> EditMode::CheckForObjectUnderCursor()
 
         for (std::shared_ptr<Ring>& ring : m_objectManager->GetRings())
         {
-            if (ring->mesh.instance == rayCastResult.hitActor)
+            if (ring->GetMeshInstance() == rayCastResult.hitActor)
                 return ring;
         }
     }
@@ -26,6 +26,8 @@ public:
     void PlaceObject() override;
 
 	void RenderCrosshair(CanvasWrapper _canvas);
+	uint64_t ComputeHudKey();
+	void BuildHud();
 
     static float CalculateDistance(const Vector& pos1, const Vector& pos2);
 	float CalculateDistanceToObject(const std::shared_ptr<Object>& _object);
@@ -38,4 +40,5 @@ public:
 private:
 	float m_rayCast_distance = 5000.f;
 	std::shared_ptr<Object> m_objectUnderCursor;
+	ObjectEdit m_edit; // journaled when the selected object is placed back
 };
\ No newline at end of file
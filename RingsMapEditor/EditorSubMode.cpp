@@ -199,6 +199,18 @@ void EditorSubMode::OnLeftShoulderPressed(float _deltaTime)
 	GetCurrentEditingProperty().removeFunction(_deltaTime);
 }
 
+const char* EditorSubMode::GetTriggerVolumeTypeName(const std::shared_ptr<Object>& _object)
+{
+	TriggerVolumeType triggerVolumeType = std::static_pointer_cast<TriggerVolume>(_object)->triggerVolumeType;
+
+	if (triggerVolumeType == TriggerVolumeType::Box)
+		return "Box";
+	else if (triggerVolumeType == TriggerVolumeType::Cylinder)
+		return "Cylinder";
+	else
+		return "Unknown";
+}
+
 int EditorSubMode::NormalizeUnrealRotation(int _rot)
 {
 	// Wrap to [0, 65536)
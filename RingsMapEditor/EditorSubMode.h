@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ObjectManager.h"
+#include "HudText.h"
 
 struct EditingProperty
 {
@@ -77,6 +78,8 @@ public:
 	void OnRightShoulderPressed(float _deltaTime); //On R1 pressed
 	void OnLeftShoulderPressed(float _deltaTime); //On L1 pressed
 
+	static const char* GetTriggerVolumeTypeName(const std::shared_ptr<Object>& _object);
+
 	int NormalizeUnrealRotation(int _rot);
 	void RotatePreviewObjectAdd(const float& _pitch, const float& _yaw, const float& _roll);
 
@@ -88,6 +91,9 @@ protected:
 	std::shared_ptr<Object> m_previewObject;
 	Rotator m_previewObjectRotation = Rotator(0, 0, 0);
 
+	//HUD, only rebuilt when the key returned by the mode changes
+	HudText m_hud = HudText(Vector2{ 20, 80 }, 2.f, 10);
+
 	//Settings
 	float m_previewObject_distance = 1400.f;
 	float m_scalePerSec = 0.5f;
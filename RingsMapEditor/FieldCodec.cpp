@@ -0,0 +1,110 @@
+#include "pch.h"
+#include "FieldCodec.h"
+#include "BinaryMap.h"
+#include "PrefabLibrary.h"
+
+#include <cstring>
+
+void FieldWriter::WriteString(const std::string& _value)
+{
+	if (m_strings)
+	{
+		uint32_t index = m_strings->Intern(_value);
+		WriteRaw(&index, sizeof(index));
+		return;
+	}
+
+	uint32_t length = static_cast<uint32_t>(_value.size());
+	WriteRaw(&length, sizeof(length));
+	WriteRaw(_value.data(), _value.size());
+}
+
+
+
+bool FieldReader::ReadRaw(void* _out, size_t _size)
+{
+	if (m_size - m_offset < _size)
+		return false;
+
+	std::memcpy(_out, m_data + m_offset, _size);
+	m_offset += _size;
+	return true;
+}
+
+bool FieldReader::ReadString(std::string& _out)
+{
+	if (m_strings)
+	{
+		uint32_t index = 0;
+		if (!ReadRaw(&index, sizeof(index)))
+			return false;
+
+		_out = std::string(m_strings->GetString(index));
+		return true;
+	}
+
+	uint32_t length = 0;
+	if (!ReadRaw(&length, sizeof(length)) || m_size - m_offset < length)
+		return false;
+
+	_out.assign(reinterpret_cast<const char*>(m_data + m_offset), length);
+	m_offset += length;
+	return true;
+}
+
+bool FieldReader::ReadCallback(std::shared_ptr<TriggerFunction>& _out)
+{
+	std::string name;
+	if (!ReadString(name))
+		return false;
+
+	if (name.empty())
+	{
+		_out = nullptr;
+		return true;
+	}
+
+	TriggerFunctionParams params = {};
+	uint8_t flag = 0;
+	for (float& value : params.floats)
+	{
+		if (!Read(value))
+			return false;
+	}
+	for (int32_t& value : params.ints)
+	{
+		if (!Read(value))
+			return false;
+	}
+	if (!Read(flag))
+		return false;
+	params.flag = flag != 0;
+
+	auto it = m_triggerFunctions.find(name);
+	if (it == m_triggerFunctions.end() || !it->second)
+	{
+		LOG("[ERROR]Unknown trigger function \"{}\", callback dropped", name);
+		_out = nullptr;
+		return true;
+	}
+
+	_out = it->second->Clone();
+	_out->ReadParams(params);
+	return true;
+}
+
+bool FieldReader::ReadPrefab(std::shared_ptr<const RingPrefab>& _out)
+{
+	std::string id;
+	if (!ReadString(id))
+		return false;
+
+	_out = nullptr;
+	if (id.empty())
+		return true;
+
+	_out = m_findPrefab ? m_findPrefab(id) : PrefabLibrary::Get().Find(id);
+	if (!_out)
+		LOG("[ERROR]Unknown prefab \"{}\", the ring is loaded unlinked", id);
+	return true;
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include "ObjectFields.h"
+
+#include <functional>
+#include <map>
+#include <vector>
+
+class BinaryMapView;
+class RmeStringTable;
+
+//Binary encoding of reflected fields, shared by ObjectDiff and the .rme records (see BinaryMap).
+//Arithmetic and enum fields are stored raw, vectors as 3 floats, rotators as 3 int32, nested objects as all of their fields,
+//trigger callbacks as their name followed by their TriggerFunctionParams, and ring prefabs as their id.
+//Strings are stored inline as uint32 length + bytes, or as a uint32 index when a string table is given.
+class FieldWriter
+{
+public:
+	FieldWriter(std::vector<uint8_t>& _out, RmeStringTable* _strings = nullptr) : m_out(_out), m_strings(_strings) {}
+
+	template <typename T>
+	void Write(const T& _value) {
+		if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+		{
+			WriteRaw(&_value, sizeof(T));
+		}
+		else if constexpr (std::is_same_v<T, std::string>)
+		{
+			WriteString(_value);
+		}
+		else if constexpr (std::is_same_v<T, Vector>)
+		{
+			Write(_value.X);
+			Write(_value.Y);
+			Write(_value.Z);
+		}
+		else if constexpr (std::is_same_v<T, Rotator>)
+		{
+			Write(static_cast<int32_t>(_value.Pitch));
+			Write(static_cast<int32_t>(_value.Yaw));
+			Write(static_cast<int32_t>(_value.Roll));
+		}
+		else if constexpr (std::is_same_v<T, std::shared_ptr<TriggerFunction>>)
+		{
+			WriteString(_value ? _value->name : std::string());
+			if (!_value)
+				return;
+
+			TriggerFunctionParams params = {};
+			_value->WriteParams(params);
+			for (float value : params.floats)
+				Write(value);
+			for (int32_t value : params.ints)
+				Write(value);
+			Write(static_cast<uint8_t>(params.flag));
+		}
+		else if constexpr (std::is_same_v<T, std::shared_ptr<const RingPrefab>>)
+		{
+			// Templates are immutable and registered by id, the id is enough
+			WriteString(_value ? _value->id : std::string());
+		}
+		else
+		{
+			WriteFields(_value, AllFieldsMask<T>);
+		}
+	}
+
+	// Fields of _object whose bit is set in _fieldMask, in field order
+	template <ReflectedType T>
+	void WriteFields(const T& _object, uint64_t _fieldMask) {
+		ForEachField<T>([&](const auto& _field, size_t _index) {
+			if (_fieldMask & (uint64_t(1) << _index))
+				Write(_field.Get(_object));
+			});
+	}
+
+	void WriteString(const std::string& _value);
+
+private:
+	void WriteRaw(const void* _data, size_t _size) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(_data);
+		m_out.insert(m_out.end(), bytes, bytes + _size);
+	}
+
+	std::vector<uint8_t>& m_out;
+	RmeStringTable* m_strings;
+};
+
+//Reads what FieldWriter wrote with the fields of _fieldsVersion, the fields added since keep their value (nested objects included)
+class FieldReader
+{
+public:
+	// Finds a prefab by id, PrefabLibrary::Find when none is given
+	using PrefabLookup = std::function<std::shared_ptr<const RingPrefab>(const std::string&)>;
+
+	FieldReader(const uint8_t* _data, size_t _size, uint16_t _fieldsVersion, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions,
+		PrefabLookup _findPrefab = nullptr, const BinaryMapView* _strings = nullptr)
+		: m_data(_data), m_size(_size), m_fieldsVersion(_fieldsVersion), m_triggerFunctions(_triggerFunctions), m_findPrefab(std::move(_findPrefab)), m_strings(_strings) {}
+
+	template <typename T>
+	bool Read(T& _value) {
+		if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+		{
+			return ReadRaw(&_value, sizeof(T));
+		}
+		else if constexpr (std::is_same_v<T, std::string>)
+		{
+			return ReadString(_value);
+		}
+		else if constexpr (std::is_same_v<T, Vector>)
+		{
+			return Read(_value.X) && Read(_value.Y) && Read(_value.Z);
+		}
+		else if constexpr (std::is_same_v<T, Rotator>)
+		{
+			int32_t pitch = 0, yaw = 0, roll = 0;
+			if (!Read(pitch) || !Read(yaw) || !Read(roll))
+				return false;
+
+			_value = Rotator(pitch, yaw, roll);
+			return true;
+		}
+		else if constexpr (std::is_same_v<T, std::shared_ptr<TriggerFunction>>)
+		{
+			return ReadCallback(_value);
+		}
+		else if constexpr (std::is_same_v<T, std::shared_ptr<const RingPrefab>>)
+		{
+			return ReadPrefab(_value);
+		}
+		else
+		{
+			return ReadFields(_value, ~uint64_t(0));
+		}
+	}
+
+	// Bits of _fieldMask index the fields that existed in the reader's version
+	template <ReflectedType T>
+	bool ReadFields(T& _object, uint64_t _fieldMask) {
+		bool success = true;
+		uint64_t bit = 0;
+		ForEachField<T>([&](const auto& _field, size_t) {
+			if (_field.sinceVersion > m_fieldsVersion)
+				return;
+
+			if (success && (_fieldMask & (uint64_t(1) << bit)))
+				success = Read(_field.Get(_object));
+			bit++;
+			});
+		return success;
+	}
+
+	bool ReadString(std::string& _out);
+
+	bool IsAtEnd() const { return m_offset == m_size; }
+
+private:
+	bool ReadRaw(void* _out, size_t _size);
+	bool ReadCallback(std::shared_ptr<TriggerFunction>& _out);
+	bool ReadPrefab(std::shared_ptr<const RingPrefab>& _out);
+
+	const uint8_t* m_data;
+	size_t m_size;
+	size_t m_offset = 0;
+	uint16_t m_fieldsVersion;
+	std::map<std::string, std::shared_ptr<TriggerFunction>>& m_triggerFunctions;
+	PrefabLookup m_findPrefab;
+	const BinaryMapView* m_strings;
+};
@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "HudText.h"
+
+
+HudText::HudText(Vector2 _position, float _scale, size_t _maxLines)
+{
+	m_position = _position;
+	m_scale = _scale;
+	m_lineHeight = 15.f * _scale;
+	m_lines.resize(_maxLines);
+}
+
+
+
+bool HudText::Update(uint64_t _sourceKey)
+{
+	if (m_valid && m_sourceKey == _sourceKey)
+		return false;
+
+	m_sourceKey = _sourceKey;
+	m_valid = true;
+	Clear();
+	return true;
+}
+
+void HudText::Invalidate()
+{
+	m_valid = false;
+}
+
+void HudText::Clear()
+{
+	for (HudLine& line : m_lines)
+	{
+		line.visible = false;
+	}
+}
+
+void HudText::Render(CanvasWrapper _canvas) const
+{
+	_canvas.SetColor(m_color[0], m_color[1], m_color[2], m_color[3]);
+
+	for (size_t row = 0; row < m_lines.size(); row++)
+	{
+		const HudLine& line = m_lines[row];
+		if (!line.visible)
+			continue;
+
+		_canvas.SetPosition(Vector2F{ static_cast<float>(m_position.X), m_position.Y + (row * m_lineHeight) });
+		_canvas.DrawString(line.text, m_scale, m_scale);
+	}
+}
+
+void HudText::SetPosition(Vector2 _position)
+{
+	m_position = _position;
+}
+
+void HudText::SetColor(uint8_t _r, uint8_t _g, uint8_t _b, uint8_t _a)
+{
+	m_color[0] = _r;
+	m_color[1] = _g;
+	m_color[2] = _b;
+	m_color[3] = _a;
+}
+
+uint64_t HudText::Combine(uint64_t _seed, uint64_t _value)
+{
+	return _seed ^ (_value + 0x9e3779b97f4a7c15ull + (_seed << 6) + (_seed >> 2));
+}
+
+uint64_t HudText::Hash(std::string_view _text)
+{
+	//FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : _text)
+	{
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
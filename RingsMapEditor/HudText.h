@@ -0,0 +1,57 @@
+#pragma once
+#include "bakkesmod/wrappers/canvaswrapper.h"
+
+#include <array>
+#include <format>
+#include <string_view>
+
+struct HudLine
+{
+	std::array<char, 128> buffer{}; // formatted text, only rewritten when the line is rebuilt
+	std::string text;               // copy handed to CanvasWrapper::DrawString, keeps its capacity between rebuilds
+	bool visible = false;
+};
+
+//Retained HUD text block.
+//Lines are formatted once into fixed buffers and drawn as-is every frame.
+//Callers pass a key describing the source values to Update(), the lines only need to be rebuilt when it returns true.
+class HudText
+{
+public:
+	HudText(Vector2 _position = Vector2{ 20, 80 }, float _scale = 2.f, size_t _maxLines = 10);
+	~HudText() = default;
+
+	bool Update(uint64_t _sourceKey);
+	void Invalidate();
+	void Clear();
+	void Render(CanvasWrapper _canvas) const;
+
+	template <typename... Args>
+	void SetLine(size_t _row, std::format_string<Args...> _format, Args&&... _args)
+	{
+		if (_row >= m_lines.size())
+			return;
+
+		HudLine& line = m_lines[_row];
+		auto result = std::format_to_n(line.buffer.data(), line.buffer.size() - 1, _format, std::forward<Args>(_args)...);
+		*result.out = '\0';
+		line.text.assign(line.buffer.data(), result.out - line.buffer.data());
+		line.visible = true;
+	}
+
+	void SetPosition(Vector2 _position);
+	void SetColor(uint8_t _r, uint8_t _g, uint8_t _b, uint8_t _a = 255);
+
+	static uint64_t Combine(uint64_t _seed, uint64_t _value);
+	static uint64_t Hash(std::string_view _text);
+
+private:
+	std::vector<HudLine> m_lines;
+	uint64_t m_sourceKey = 0;
+	bool m_valid = false;
+
+	Vector2 m_position;
+	float m_scale = 2.f;
+	float m_lineHeight = 30.f;
+	uint8_t m_color[4] = { 255, 255, 255, 255 };
+};
@@ -0,0 +1,120 @@
+#include "pch.h"
+#include <algorithm>
+#include "IdTable.h"
+
+bool IdTable::Set(SlotHandle _handle, int _id)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!_handle.IsValid())
+		return true;
+
+	if (_handle.index >= m_users.size())
+		m_users.resize(_handle.index + 1);
+
+	// A user left by a removed object in the same slot is dropped first
+	User& user = m_users[_handle.index];
+	if (user.handle == _handle && user.id == _id)
+		return true;
+
+	RemoveUser(user);
+
+	if (_id < 0 || _id > MaxId)
+		return true;
+
+	if (static_cast<size_t>(_id) >= m_entries.size())
+		m_entries.resize(static_cast<size_t>(_id) + 1);
+
+	user.handle = _handle;
+	user.id = _id;
+	if (_id > m_highestId)
+		m_highestId = _id;
+
+	Entry& entry = m_entries[_id];
+	entry.userCount++;
+	if (entry.userCount > 1)
+		return false;
+
+	entry.handle = _handle;
+	return true;
+}
+
+void IdTable::Remove(SlotHandle _handle)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (_handle.IsValid() && _handle.index < m_users.size() && m_users[_handle.index].handle == _handle)
+		RemoveUser(m_users[_handle.index]);
+}
+
+void IdTable::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_entries.clear();
+	m_users.clear();
+	m_highestId = 0;
+}
+
+SlotHandle IdTable::Find(int _id) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return (_id >= 0 && static_cast<size_t>(_id) < m_entries.size()) ? m_entries[_id].handle : SlotHandle();
+}
+
+SlotHandle IdTable::FindLowest() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (const Entry& entry : m_entries)
+	{
+		if (entry.handle.IsValid())
+			return entry.handle;
+	}
+	return SlotHandle();
+}
+
+int IdTable::GetFreeId(bool _reuseFreed) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!_reuseFreed)
+		return m_highestId + 1;
+
+	for (size_t id = 1; id < m_entries.size(); id++)
+	{
+		if (m_entries[id].userCount == 0)
+			return static_cast<int>(id);
+	}
+	return m_entries.empty() ? 1 : static_cast<int>(m_entries.size());
+}
+
+//Called with m_mutex held
+void IdTable::RemoveUser(User& _user)
+{
+	if (!_user.handle.IsValid() || _user.id < 0)
+	{
+		_user = User();
+		return;
+	}
+
+	Entry& entry = m_entries[_user.id];
+	entry.userCount--;
+
+	// The entry passes to another object with the same id, only duplicates ever pay for this search
+	if (entry.handle == _user.handle)
+	{
+		entry.handle = SlotHandle();
+		if (entry.userCount > 0)
+		{
+			auto it = std::find_if(m_users.begin(), m_users.end(), [&](const User& _other) {
+				return &_other != &_user && _other.id == _user.id && _other.handle.IsValid();
+				});
+			if (it != m_users.end())
+				entry.handle = it->handle;
+		}
+	}
+
+	_user = User();
+}
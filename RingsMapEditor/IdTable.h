@@ -0,0 +1,49 @@
+#pragma once
+#include "SlotMap.h"
+
+#include <mutex>
+
+//Dense id -> handle table for the ids objects carry themselves (checkpoint and ring ids), the entry of an id is at index id.
+//Each object's id is also kept by slot index, so a changed or removed id is found without a search.
+//Several objects may hold the same id (maps made before ids were checked) : the first one keeps the entry, the others are counted.
+class IdTable
+{
+public:
+	// Ids the table holds, an object with an id outside of them is left out
+	static constexpr int MaxId = 1 << 20;
+
+	// _handle now uses _id instead of its previous id, a negative _id removes it.
+	// Returns false when another object already uses _id, _handle is counted as one of its users anyway
+	bool Set(SlotHandle _handle, int _id);
+	void Remove(SlotHandle _handle);
+	void Clear();
+
+	// Object using _id, invalid if none
+	SlotHandle Find(int _id) const;
+	// Object using the lowest id, invalid if none
+	SlotHandle FindLowest() const;
+
+	// An id no object uses : one past the highest id ever set since the last Clear(), or the lowest free one when _reuseFreed is set
+	int GetFreeId(bool _reuseFreed) const;
+
+private:
+	struct Entry
+	{
+		SlotHandle handle;
+		uint32_t userCount = 0;
+	};
+
+	struct User
+	{
+		SlotHandle handle;
+		int id = -1;
+	};
+
+	void RemoveUser(User& _user);
+
+	mutable std::mutex m_mutex; // edited on the game thread, read by the ImGui render thread
+
+	std::vector<Entry> m_entries; // indexed by id
+	std::vector<User> m_users;    // indexed by slot index, the handle tells whether it's the current object of the slot
+	int m_highestId = 0;
+};
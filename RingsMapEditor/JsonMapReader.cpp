@@ -0,0 +1,1045 @@
+#include "pch.h"
+#include <algorithm>
+#include "JsonMapReader.h"
+#include "MappedFile.h"
+#include "ObjectFields.h"
+#include "PrefabLibrary.h"
+
+#include <atomic>
+#include <thread>
+
+namespace
+{
+	constexpr JsonMapField ObjectTypeField = JsonMapKeys.Find("objectType");
+	constexpr JsonMapField TriggerVolumeTypeField = JsonMapKeys.Find("triggerVolumeType");
+	constexpr JsonMapField RingIdField = JsonMapKeys.Find("ringId");
+	constexpr JsonMapField PrefabField = JsonMapKeys.Find("prefab");
+	constexpr JsonMapField PrefabDefinitionField = JsonMapKeys.Find("prefabDefinition");
+	constexpr JsonMapField ParentField = JsonMapKeys.Find("parent");
+
+	constexpr uint64_t RingPrefabField = GetFieldMask<Ring>({ "prefab" });
+
+	constexpr std::string_view VectorComponents[] = { "X", "Y", "Z" };
+	constexpr std::string_view RotatorComponents[] = { "Pitch", "Yaw", "Roll" };
+
+	//Keys of TriggerFunction::WriteJson, "description" is ignored since it always matches the registered function
+	enum CallbackComponent
+	{
+		CallbackName,
+		CallbackLocation,
+		CallbackRotation,
+		CallbackUseCurrentCheckpoint,
+		CallbackCheckpointId
+	};
+	constexpr std::string_view CallbackComponents[] = { "name", "location", "rotation", "useCurrentCheckpoint", "checkpointId" };
+
+	template <size_t N>
+	constexpr int FindComponent(const std::string_view(&_names)[N], std::string_view _key)
+	{
+		for (size_t i = 0; i < N; i++)
+		{
+			if (_names[i] == _key)
+				return static_cast<int>(i);
+		}
+		return -1;
+	}
+
+	//Key of each field of T, in field order
+	template <ReflectedType T>
+	constexpr std::array<JsonMapField, FieldCount<T>> MakeFieldKeys()
+	{
+		std::array<JsonMapField, FieldCount<T>> keys = {};
+		ForEachField<T>([&](const auto& _field, size_t _index) {
+			keys[_index] = JsonMapKeys.Find(_field.name);
+			});
+		return keys;
+	}
+
+	template <ReflectedType T>
+	constexpr std::array<JsonMapField, FieldCount<T>> FieldKeys = MakeFieldKeys<T>();
+
+	//MeshInfos is read on its own frame, its components are its fields
+	int FindMeshInfosComponent(std::string_view _key)
+	{
+		int component = -1;
+		ForEachField<MeshInfos>([&](const auto& _field, size_t _index) {
+			if (_field.name == _key)
+				component = static_cast<int>(_index);
+			});
+		return component;
+	}
+
+	std::string_view GetMeshInfosComponentName(int _component)
+	{
+		std::string_view name = "?";
+		ForEachField<MeshInfos>([&](const auto& _field, size_t _index) {
+			if (static_cast<int>(_index) == _component)
+				name = _field.name;
+			});
+		return name;
+	}
+
+	JsonValueKind GetKind(JsonMapField _field)
+	{
+		return JsonMapKeys.keys[static_cast<size_t>(_field)].kind;
+	}
+
+	//Maps smaller than this are parsed on the calling thread, splitting them costs more than it saves
+	constexpr size_t ParallelLoadMinElements = 1024;
+	constexpr size_t ElementsPerChunk = 256;
+
+	constexpr bool IsJsonWhitespace(uint8_t _c)
+	{
+		return _c == ' ' || _c == '\t' || _c == '\n' || _c == '\r';
+	}
+
+	//Finds the byte range of every element of the top-level array without parsing them.
+	//Only strings and nesting are tracked, anything unusual returns false and the map is parsed in one pass instead,
+	//which also gives the proper error for malformed files.
+	bool SplitRootArray(const uint8_t* _data, size_t _size, std::vector<JsonMapElement>& _outElements)
+	{
+		size_t i = 0;
+		auto skipWhitespace = [&]() {
+			while (i < _size && IsJsonWhitespace(_data[i]))
+				i++;
+			};
+
+		skipWhitespace();
+		if (i == _size || _data[i] != '[')
+			return false;
+		i++;
+
+		skipWhitespace();
+		if (i < _size && _data[i] == ']')
+		{
+			i++;
+			skipWhitespace();
+			return i == _size;
+		}
+
+		while (true)
+		{
+			skipWhitespace();
+			size_t begin = i;
+			int depth = 0;
+			bool inString = false;
+
+			for (; i < _size; i++)
+			{
+				uint8_t c = _data[i];
+				if (inString)
+				{
+					if (c == '\\')
+						i++;
+					else if (c == '"')
+						inString = false;
+					continue;
+				}
+
+				if (c == '"')
+					inString = true;
+				else if (c == '{' || c == '[')
+					depth++;
+				else if (c == '}' || c == ']')
+				{
+					if (depth == 0)
+						break;
+					depth--;
+				}
+				else if (c == ',' && depth == 0)
+					break;
+			}
+
+			if (i >= _size)
+				return false;
+
+			size_t end = i;
+			while (end > begin && IsJsonWhitespace(_data[end - 1]))
+				end--;
+			if (end == begin)
+				return false;
+
+			_outElements.push_back(JsonMapElement{ begin, end, _data[begin] == '{' });
+
+			if (_data[i] == ']')
+			{
+				i++;
+				skipWhitespace();
+				return i == _size;
+			}
+			i++;
+		}
+	}
+
+	//Runs _task(0.._taskCount-1) on up to one thread per core, tasks are handed out in order as workers free up
+	template <typename Task>
+	void RunOnWorkers(size_t _taskCount, Task&& _task)
+	{
+		size_t workerCount = std::min<size_t>(std::max<unsigned>(1, std::thread::hardware_concurrency()), _taskCount);
+		std::atomic<size_t> nextTask = 0;
+
+		auto work = [&]() {
+			for (size_t task = nextTask++; task < _taskCount; task = nextTask++)
+				_task(task);
+			};
+
+		std::vector<std::thread> workers;
+		workers.reserve(workerCount - 1);
+		for (size_t i = 1; i < workerCount; i++)
+			workers.emplace_back(work);
+
+		work();
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+}
+
+
+
+JsonMapReader::JsonMapReader(std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects)
+	: m_triggerFunctions(_triggerFunctions), m_outObjects(_outObjects)
+{
+	m_frames.reserve(8);
+}
+
+bool JsonMapReader::Load(const std::filesystem::path& _filePath, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects, MapExtras& _outExtras)
+{
+	MappedFile file;
+	if (!file.Open(_filePath))
+	{
+		LOG("[ERROR]Could not open config file: {}", _filePath.string());
+		return false;
+	}
+
+	std::vector<std::shared_ptr<Object>> loadedObjects;
+	std::vector<int> positions;
+	std::vector<int> parentPositions;
+	std::map<std::string, std::shared_ptr<const RingPrefab>> prefabs;
+	size_t errorCount = 0;
+
+	std::vector<JsonMapElement> elements;
+	if (std::thread::hardware_concurrency() > 1 && file.Size() > 0
+		&& SplitRootArray(file.Data(), file.Size(), elements) && elements.size() >= ParallelLoadMinElements)
+	{
+		if (!LoadElements(file.Data(), elements, _triggerFunctions, loadedObjects, positions, parentPositions, prefabs, errorCount))
+			return false;
+	}
+	else
+	{
+		JsonMapReader reader(_triggerFunctions, loadedObjects);
+		if (!nlohmann::json::sax_parse(file.Data(), file.Data() + file.Size(), &reader))
+			return false;
+
+		errorCount = reader.GetErrorCount();
+		positions = std::move(reader.m_positions);
+		parentPositions = std::move(reader.m_parentPositions);
+		prefabs = std::move(reader.m_prefabs);
+	}
+
+	if (errorCount > 0)
+		LOG("[ERROR]{} error(s) while loading {}, {} object(s) were loaded", errorCount, _filePath.string(), loadedObjects.size());
+
+	// Positions only grow along the array, a parent is found back by binary search
+	const size_t firstIndex = _outObjects.size();
+	for (size_t i = 0; i < parentPositions.size(); i++)
+	{
+		if (parentPositions[i] < 0)
+			continue;
+
+		auto parent = std::lower_bound(positions.begin(), positions.end(), parentPositions[i]);
+		if (parent == positions.end() || *parent != parentPositions[i] || parent - positions.begin() == static_cast<ptrdiff_t>(i))
+		{
+			LOG("[ERROR]Object {} of {} has no loaded parent at {}, it was left unlinked", positions[i], _filePath.string(), parentPositions[i]);
+			continue;
+		}
+
+		if (_outExtras.parents.size() < firstIndex + loadedObjects.size())
+			_outExtras.parents.resize(firstIndex + loadedObjects.size(), -1);
+		_outExtras.parents[firstIndex + i] = static_cast<int32_t>(firstIndex + (parent - positions.begin()));
+	}
+
+	for (auto& [id, prefab] : prefabs)
+		_outExtras.prefabs.push_back(std::move(prefab));
+
+	_outObjects.insert(_outObjects.end(), std::make_move_iterator(loadedObjects.begin()), std::make_move_iterator(loadedObjects.end()));
+	return true;
+}
+
+
+//Parses chunks of consecutive elements on worker threads, each with its own reader, then merges the objects in file order.
+//A reader starts every element with the root array frame already pushed, so elements behave exactly as in a one-pass load.
+bool JsonMapReader::LoadElements(const uint8_t* _data, const std::vector<JsonMapElement>& _elements, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects,
+	std::vector<int>& _outPositions, std::vector<int>& _outParentPositions, std::map<std::string, std::shared_ptr<const RingPrefab>>& _outPrefabs, size_t& _outErrorCount)
+{
+	struct Chunk
+	{
+		size_t firstElement = 0;
+		size_t elementCount = 0;
+		int firstObjectIndex = 0;
+		std::vector<std::shared_ptr<Object>> objects;
+		std::vector<int> positions;
+		std::vector<int> parentPositions;
+		std::map<std::string, std::shared_ptr<const RingPrefab>> prefabs;
+		size_t errorCount = 0;
+		bool parsed = false;
+	};
+
+	// Prefab definitions lead the array, they're read before the chunks holding their instances are parsed.
+	// The first element that isn't one is parsed here too and stays first in the merged objects
+	size_t firstElement = 0;
+	int objectIndex = 0;
+	{
+		JsonMapReader reader(_triggerFunctions, _outObjects);
+		reader.m_frames.push_back(Frame{ FrameKind::Root });
+
+		while (firstElement < _elements.size())
+		{
+			const size_t definitionCount = reader.m_prefabDefinitionCount;
+			reader.m_byteOffset = _elements[firstElement].begin;
+			if (!nlohmann::json::sax_parse(_data + _elements[firstElement].begin, _data + _elements[firstElement].end, &reader))
+				return false;
+
+			firstElement++;
+			if (reader.m_prefabDefinitionCount == definitionCount)
+				break;
+		}
+
+		_outErrorCount += reader.GetErrorCount();
+		objectIndex = reader.m_objectIndex + 1;
+		_outPositions = std::move(reader.m_positions);
+		_outParentPositions = std::move(reader.m_parentPositions);
+		_outPrefabs = std::move(reader.m_prefabs);
+	}
+
+	std::vector<Chunk> chunks((_elements.size() - firstElement + ElementsPerChunk - 1) / ElementsPerChunk);
+
+	// Object indexes in error messages only count object elements, like the one-pass reader does
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		Chunk& chunk = chunks[i];
+		chunk.firstElement = firstElement + i * ElementsPerChunk;
+		chunk.elementCount = std::min<size_t>(ElementsPerChunk, _elements.size() - chunk.firstElement);
+		chunk.firstObjectIndex = objectIndex;
+
+		for (size_t element = chunk.firstElement; element < chunk.firstElement + chunk.elementCount; element++)
+		{
+			if (_elements[element].isObject)
+				objectIndex++;
+		}
+	}
+
+	RunOnWorkers(chunks.size(), [&](size_t _chunkIndex) {
+		Chunk& chunk = chunks[_chunkIndex];
+		chunk.objects.reserve(chunk.elementCount);
+
+		JsonMapReader reader(_triggerFunctions, chunk.objects);
+		reader.m_frames.push_back(Frame{ FrameKind::Root });
+		reader.m_objectIndex = chunk.firstObjectIndex - 1;
+		reader.m_prefabs = _outPrefabs;
+
+		for (size_t element = chunk.firstElement; element < chunk.firstElement + chunk.elementCount; element++)
+		{
+			reader.m_byteOffset = _elements[element].begin;
+			if (!nlohmann::json::sax_parse(_data + _elements[element].begin, _data + _elements[element].end, &reader))
+				return;
+		}
+
+		chunk.errorCount = reader.GetErrorCount();
+		chunk.positions = std::move(reader.m_positions);
+		chunk.parentPositions = std::move(reader.m_parentPositions);
+		chunk.prefabs = std::move(reader.m_prefabs);
+		chunk.parsed = true;
+		});
+
+	size_t objectCount = 0;
+	for (const Chunk& chunk : chunks)
+	{
+		if (!chunk.parsed)
+			return false;
+		objectCount += chunk.objects.size();
+	}
+
+	_outObjects.reserve(_outObjects.size() + objectCount);
+	for (Chunk& chunk : chunks)
+	{
+		_outObjects.insert(_outObjects.end(), std::make_move_iterator(chunk.objects.begin()), std::make_move_iterator(chunk.objects.end()));
+		_outPositions.insert(_outPositions.end(), chunk.positions.begin(), chunk.positions.end());
+		_outParentPositions.insert(_outParentPositions.end(), chunk.parentPositions.begin(), chunk.parentPositions.end());
+		// Definitions found further down the array, later ones replace earlier ones like in a one-pass load
+		for (auto& [id, prefab] : chunk.prefabs)
+			_outPrefabs[id] = std::move(prefab);
+		_outErrorCount += chunk.errorCount;
+	}
+
+	return true;
+}
+
+
+
+bool JsonMapReader::null()
+{
+	if (m_skipDepth > 0)
+		return true;
+	if (m_frames.empty())
+		return OnRootScalar();
+
+	const Frame& frame = m_frames.back();
+	if (frame.kind == FrameKind::Callback)
+		return true;
+
+	if (frame.kind == FrameKind::Object)
+	{
+		if (frame.field == JsonMapField::Unknown)
+			return true;
+
+		// A volume without callback is written as "onTouchCallback": null, a ring without prefab as "prefab": null
+		JsonValueKind kind = GetKind(frame.field);
+		if (kind == JsonValueKind::Callback || kind == JsonValueKind::Prefab)
+		{
+			m_pending.back()[frame.field].emplace<std::nullptr_t>();
+			return true;
+		}
+	}
+
+	ReportUnexpected("null");
+	return true;
+}
+
+bool JsonMapReader::boolean(bool _value)
+{
+	if (m_skipDepth > 0)
+		return true;
+	if (m_frames.empty())
+		return OnRootScalar();
+
+	const Frame& frame = m_frames.back();
+
+	if (frame.kind == FrameKind::Object)
+	{
+		if (frame.field == JsonMapField::Unknown)
+			return true;
+
+		if (GetKind(frame.field) == JsonValueKind::Boolean)
+			m_pending.back()[frame.field].emplace<bool>(_value);
+		else
+			ReportUnexpected("boolean");
+		return true;
+	}
+
+	if (frame.kind == FrameKind::Callback)
+	{
+		JsonPendingCallback& callback = *static_cast<JsonPendingCallback*>(frame.target);
+		if (frame.component == CallbackUseCurrentCheckpoint)
+			callback.useCurrentCheckpoint = _value;
+		else if (frame.component >= 0)
+			ReportUnexpected("boolean");
+		return true;
+	}
+
+	ReportUnexpected("boolean");
+	return true;
+}
+
+bool JsonMapReader::number_integer(number_integer_t _value)
+{
+	return OnNumber(static_cast<double>(_value));
+}
+
+bool JsonMapReader::number_unsigned(number_unsigned_t _value)
+{
+	return OnNumber(static_cast<double>(_value));
+}
+
+bool JsonMapReader::number_float(number_float_t _value, const string_t& _text)
+{
+	return OnNumber(static_cast<double>(_value));
+}
+
+bool JsonMapReader::OnNumber(double _value)
+{
+	if (m_skipDepth > 0)
+		return true;
+	if (m_frames.empty())
+		return OnRootScalar();
+
+	const Frame& frame = m_frames.back();
+
+	switch (frame.kind)
+	{
+	case FrameKind::Vector:
+	{
+		Vector& vector = *static_cast<Vector*>(frame.target);
+		if (frame.component == 0) vector.X = static_cast<float>(_value);
+		else if (frame.component == 1) vector.Y = static_cast<float>(_value);
+		else if (frame.component == 2) vector.Z = static_cast<float>(_value);
+		return true;
+	}
+	case FrameKind::Rotator:
+	{
+		Rotator& rotator = *static_cast<Rotator*>(frame.target);
+		if (frame.component == 0) rotator.Pitch = static_cast<int>(_value);
+		else if (frame.component == 1) rotator.Yaw = static_cast<int>(_value);
+		else if (frame.component == 2) rotator.Roll = static_cast<int>(_value);
+		return true;
+	}
+	case FrameKind::Object:
+		if (frame.field == JsonMapField::Unknown)
+			return true;
+
+		if (GetKind(frame.field) == JsonValueKind::Number)
+			m_pending.back()[frame.field].emplace<double>(_value);
+		else
+			ReportUnexpected("number");
+		return true;
+	case FrameKind::Callback:
+	{
+		JsonPendingCallback& callback = *static_cast<JsonPendingCallback*>(frame.target);
+		if (frame.component == CallbackCheckpointId)
+		{
+			callback.checkpointId = static_cast<int>(_value);
+			callback.hasCheckpointId = true;
+		}
+		else if (frame.component >= 0)
+			ReportUnexpected("number");
+		return true;
+	}
+	default:
+		ReportUnexpected("number");
+		return true;
+	}
+}
+
+bool JsonMapReader::string(string_t& _value)
+{
+	if (m_skipDepth > 0)
+		return true;
+	if (m_frames.empty())
+		return OnRootScalar();
+
+	const Frame& frame = m_frames.back();
+
+	switch (frame.kind)
+	{
+	case FrameKind::Object:
+		if (frame.field == JsonMapField::Unknown)
+			return true;
+
+		if (GetKind(frame.field) == JsonValueKind::String || GetKind(frame.field) == JsonValueKind::Prefab)
+			m_pending.back()[frame.field].emplace<std::string>(std::move(_value));
+		else
+			ReportUnexpected("string");
+		return true;
+	case FrameKind::MeshInfos:
+	{
+		MeshInfos& meshInfos = *static_cast<MeshInfos*>(frame.target);
+		ForEachField<MeshInfos>([&](const auto& _field, size_t _index) {
+			if (static_cast<int>(_index) == frame.component)
+				_field.Get(meshInfos) = std::move(_value);
+			});
+		return true;
+	}
+	case FrameKind::Callback:
+		if (frame.component == CallbackName)
+			static_cast<JsonPendingCallback*>(frame.target)->name = std::move(_value);
+		else if (frame.component >= 0)
+			ReportUnexpected("string");
+		return true;
+	default:
+		ReportUnexpected("string");
+		return true;
+	}
+}
+
+bool JsonMapReader::binary(binary_t& _value)
+{
+	if (m_skipDepth == 0)
+		ReportUnexpected("binary value");
+	return true;
+}
+
+bool JsonMapReader::start_object(std::size_t _elements)
+{
+	if (m_skipDepth > 0)
+	{
+		m_skipDepth++;
+		return true;
+	}
+
+	if (m_frames.empty())
+		return OnRootScalar();
+
+	// Copied because pushing a frame below invalidates references into m_frames
+	FrameKind kind = m_frames.back().kind;
+	JsonMapField field = m_frames.back().field;
+
+	if (kind == FrameKind::Root)
+	{
+		m_objectIndex++;
+		m_pending.emplace_back();
+		m_frames.push_back(Frame{ FrameKind::Object });
+		return true;
+	}
+
+	if (kind == FrameKind::Object)
+	{
+		if (field == JsonMapField::Unknown)
+		{
+			SkipValue();
+			return true;
+		}
+
+		JsonPendingValue& value = m_pending.back()[field];
+		switch (GetKind(field))
+		{
+		case JsonValueKind::Vector: StartValueObject(FrameKind::Vector, &value.emplace<Vector>(0.f)); break;
+		case JsonValueKind::Rotator: StartValueObject(FrameKind::Rotator, &value.emplace<Rotator>(0)); break;
+		case JsonValueKind::MeshInfos: StartValueObject(FrameKind::MeshInfos, &value.emplace<MeshInfos>()); break;
+		case JsonValueKind::Callback: StartValueObject(FrameKind::Callback, &value.emplace<JsonPendingCallback>()); break;
+		case JsonValueKind::Object:
+			// Nested objects are built on their own frame then stored in the parent in end_object()
+			m_pending.emplace_back();
+			m_frames.push_back(Frame{ FrameKind::Object });
+			break;
+		default:
+			ReportUnexpected("object");
+			SkipValue();
+			break;
+		}
+		return true;
+	}
+
+	if (kind == FrameKind::Callback)
+	{
+		const Frame& frame = m_frames.back();
+		JsonPendingCallback& callback = *static_cast<JsonPendingCallback*>(frame.target);
+		if (frame.component == CallbackLocation)
+			StartValueObject(FrameKind::Vector, &callback.location);
+		else if (frame.component == CallbackRotation)
+			StartValueObject(FrameKind::Rotator, &callback.rotation);
+		else
+			SkipValue();
+		return true;
+	}
+
+	ReportUnexpected("object");
+	SkipValue();
+	return true;
+}
+
+bool JsonMapReader::key(string_t& _value)
+{
+	if (m_skipDepth > 0)
+		return true;
+
+	Frame& frame = m_frames.back();
+	switch (frame.kind)
+	{
+	case FrameKind::Object:
+		frame.field = FindField(_value);
+		break;
+	case FrameKind::Callback:
+		frame.component = FindComponent(CallbackComponents, _value);
+		break;
+	case FrameKind::Vector:
+		frame.component = FindComponent(VectorComponents, _value);
+		break;
+	case FrameKind::Rotator:
+		frame.component = FindComponent(RotatorComponents, _value);
+		break;
+	case FrameKind::MeshInfos:
+		frame.component = FindMeshInfosComponent(_value);
+		break;
+	default:
+		break;
+	}
+
+	return true;
+}
+
+bool JsonMapReader::end_object()
+{
+	if (m_skipDepth > 0)
+	{
+		m_skipDepth--;
+		return true;
+	}
+
+	FrameKind kind = m_frames.back().kind;
+	m_frames.pop_back();
+
+	if (kind != FrameKind::Object)
+		return true;
+
+	// The object's frame is popped first so error paths end at the key holding it
+	JsonPendingObject& pending = m_pending.back();
+	std::shared_ptr<Object> object = pending.valid ? BuildObject(pending) : nullptr;
+	const double* parent = std::get_if<double>(&pending[ParentField]);
+	const int parentPosition = parent ? static_cast<int>(*parent) : -1;
+	m_pending.pop_back();
+
+	if (m_frames.back().kind == FrameKind::Object)
+	{
+		// Its type is checked when it's assigned to the parent's field
+		if (object)
+			m_pending.back()[m_frames.back().field].emplace<std::shared_ptr<Object>>(object);
+		else
+			m_pending.back().valid = false;
+	}
+	else if (object)
+	{
+		m_outObjects.push_back(object);
+		m_positions.push_back(m_objectIndex);
+		m_parentPositions.push_back(parentPosition);
+	}
+
+	return true;
+}
+
+bool JsonMapReader::start_array(std::size_t _elements)
+{
+	if (m_skipDepth > 0)
+	{
+		m_skipDepth++;
+		return true;
+	}
+
+	if (m_frames.empty())
+	{
+		m_frames.push_back(Frame{ FrameKind::Root });
+		if (_elements != static_cast<std::size_t>(-1))
+			m_outObjects.reserve(m_outObjects.size() + _elements);
+		return true;
+	}
+
+	const Frame& frame = m_frames.back();
+	if ((frame.kind == FrameKind::Object && frame.field == JsonMapField::Unknown) || (frame.kind == FrameKind::Callback && frame.component < 0))
+	{
+		SkipValue();
+		return true;
+	}
+
+	ReportUnexpected("array");
+	SkipValue();
+	return true;
+}
+
+bool JsonMapReader::end_array()
+{
+	if (m_skipDepth > 0)
+	{
+		m_skipDepth--;
+		return true;
+	}
+
+	m_frames.pop_back();
+	return true;
+}
+
+bool JsonMapReader::parse_error(std::size_t _position, const std::string& _lastToken, const nlohmann::detail::exception& _exception)
+{
+	LOG("[ERROR]Failed to parse config at byte {} (object {}): {}", m_byteOffset + _position, m_objectIndex, _exception.what());
+	return false;
+}
+
+
+
+bool JsonMapReader::OnRootScalar()
+{
+	LOG("[ERROR]Config must contain an array of objects");
+	return false;
+}
+
+void JsonMapReader::StartValueObject(FrameKind _kind, void* _target)
+{
+	Frame frame{ _kind };
+	frame.target = _target;
+	m_frames.push_back(frame);
+}
+
+void JsonMapReader::SkipValue()
+{
+	m_skipDepth = 1;
+}
+
+std::shared_ptr<Object> JsonMapReader::BuildObject(const JsonPendingObject& _pending)
+{
+	if (!Require(_pending, { ObjectTypeField }))
+		return nullptr;
+
+	const uint8_t objectType = static_cast<uint8_t>(std::get<double>(_pending[ObjectTypeField]));
+
+	if (static_cast<ObjectType>(objectType) == ObjectType::Ring)
+		return BuildRing(_pending);
+
+	uint8_t triggerVolumeType = 0;
+	if (static_cast<ObjectType>(objectType) == ObjectType::TriggerVolume)
+	{
+		if (!Require(_pending, { TriggerVolumeTypeField }))
+			return nullptr;
+		triggerVolumeType = static_cast<uint8_t>(std::get<double>(_pending[TriggerVolumeTypeField]));
+	}
+
+	std::shared_ptr<Object> object = CreateObject(static_cast<ObjectType>(objectType), static_cast<TriggerVolumeType>(triggerVolumeType));
+	if (!object)
+	{
+		if (static_cast<ObjectType>(objectType) == ObjectType::TriggerVolume)
+			ReportError(GetFieldName(TriggerVolumeTypeField), "unknown trigger volume type " + std::to_string(triggerVolumeType));
+		else
+			ReportError(GetFieldName(ObjectTypeField), "unknown object type " + std::to_string(objectType));
+		return nullptr;
+	}
+
+	bool complete = VisitObject(*object, [&](auto& _concreteObject) { return AssignFields(_concreteObject, _pending, false); }, false);
+	return complete ? object : nullptr;
+}
+
+//A ring made from a prefab starts as a copy of it and only takes the fields the map stores, its overrides
+std::shared_ptr<Ring> JsonMapReader::BuildRing(const JsonPendingObject& _pending)
+{
+	const bool* prefabDefinition = std::get_if<bool>(&_pending[PrefabDefinitionField]);
+	const bool isDefinition = prefabDefinition && *prefabDefinition;
+	const std::string* prefabId = std::get_if<std::string>(&_pending[PrefabField]);
+
+	if (isDefinition)
+	{
+		if (!prefabId)
+		{
+			ReportError(GetFieldName(PrefabField), "missing");
+			return nullptr;
+		}
+
+		// The definition's own id isn't registered yet, it isn't read as a link
+		Ring ring;
+		if (!AssignFields(ring, _pending, false, RingPrefabField))
+			return nullptr;
+
+		std::shared_ptr<const RingPrefab> existing = PrefabLibrary::Get().Find(*prefabId);
+		if (existing && existing->builtIn)
+			ReportError(GetFieldName(PrefabField), "\"" + *prefabId + "\" is a built-in prefab, the definition is ignored", false);
+		else
+			m_prefabs[*prefabId] = PrefabLibrary::MakePrefab(*prefabId, ring);
+		m_prefabDefinitionCount++;
+		return nullptr;
+	}
+
+	if (!prefabId)
+	{
+		std::shared_ptr<Ring> ring = MakePooled<Ring>();
+		if (!AssignFields(*ring, _pending, false))
+			return nullptr;
+
+		// Maps written before the parts were shared placed them in the world
+		ring->ClearPartTransforms();
+		return ring;
+	}
+
+	if (!Require(_pending, { RingIdField }))
+		return nullptr;
+
+	std::shared_ptr<const RingPrefab> prefab = FindPrefab(*prefabId);
+	if (!prefab)
+	{
+		ReportError(GetFieldName(PrefabField), "unknown prefab \"" + *prefabId + "\"");
+		return nullptr;
+	}
+
+	std::shared_ptr<Ring> ring = PrefabLibrary::Instantiate(prefab, -1);
+	if (!AssignFields(*ring, _pending, true))
+		return nullptr;
+
+	// Only the overridden parts were copied from the template's
+	ring->ClearPartTransforms();
+	PrefabLibrary::ShareUnchangedParts(*ring);
+	return ring;
+}
+
+template <ReflectedType T>
+bool JsonMapReader::AssignFields(T& _object, const JsonPendingObject& _pending, bool _instance, uint64_t _skippedFields)
+{
+	bool complete = true;
+	ForEachField<T>([&](const auto& _field, size_t _index) {
+		using Field = std::remove_cvref_t<decltype(_field)>;
+		if (_skippedFields & (uint64_t(1) << _index))
+			return;
+
+		const JsonPendingValue& value = _pending[FieldKeys<T>[_index]];
+		if (std::holds_alternative<std::monostate>(value))
+		{
+			if (!_field.optional && (!_instance || std::is_same_v<typename Field::ClassType, Object>))
+			{
+				ReportError(_field.name, "missing");
+				complete = false;
+			}
+			return;
+		}
+
+		complete = AssignValue(_field.Get(_object), value, _field.name) && complete;
+		});
+	return complete;
+}
+
+//The value holds the alternative of the field's JsonValueKind, events of any other kind were reported as unexpected
+template <typename Member>
+bool JsonMapReader::AssignValue(Member& _member, const JsonPendingValue& _value, std::string_view _key)
+{
+	if constexpr (std::is_same_v<Member, bool>)
+	{
+		_member = std::get<bool>(_value);
+	}
+	else if constexpr (std::is_enum_v<Member>)
+	{
+		_member = static_cast<Member>(static_cast<std::underlying_type_t<Member>>(std::get<double>(_value)));
+	}
+	else if constexpr (std::is_arithmetic_v<Member>)
+	{
+		_member = static_cast<Member>(std::get<double>(_value));
+	}
+	else if constexpr (std::is_same_v<Member, std::shared_ptr<TriggerFunction>>)
+	{
+		const JsonPendingCallback* callback = std::get_if<JsonPendingCallback>(&_value);
+		_member = callback ? BuildCallback(*callback, _key) : nullptr;
+	}
+	else if constexpr (std::is_same_v<Member, std::shared_ptr<const RingPrefab>>)
+	{
+		const std::string* id = std::get_if<std::string>(&_value);
+		_member = id ? FindPrefab(*id) : nullptr;
+		if (id && !_member)
+		{
+			ReportError(_key, "unknown prefab \"" + *id + "\"");
+			return false;
+		}
+	}
+	else if constexpr (std::is_base_of_v<Object, Member>)
+	{
+		const Member* child = dynamic_cast<const Member*>(std::get<std::shared_ptr<Object>>(_value).get());
+		if (!child)
+		{
+			ReportError(_key, "nested object has the wrong type");
+			return false;
+		}
+		_member = *child;
+	}
+	else
+	{
+		_member = std::get<Member>(_value);
+	}
+	return true;
+}
+
+//Definitions of this map first, they are only registered once the whole map is loaded
+std::shared_ptr<const RingPrefab> JsonMapReader::FindPrefab(const std::string& _id) const
+{
+	auto it = m_prefabs.find(_id);
+	return it != m_prefabs.end() ? it->second : PrefabLibrary::Get().Find(_id);
+}
+
+bool JsonMapReader::Require(const JsonPendingObject& _pending, std::initializer_list<JsonMapField> _fields)
+{
+	bool hasAll = true;
+	for (JsonMapField field : _fields)
+	{
+		if (!_pending.Has(field))
+		{
+			ReportError(GetFieldName(field), "missing");
+			hasAll = false;
+		}
+	}
+	return hasAll;
+}
+
+std::shared_ptr<TriggerFunction> JsonMapReader::BuildCallback(const JsonPendingCallback& _pending, std::string_view _key)
+{
+	auto it = m_triggerFunctions.find(_pending.name);
+	if (it == m_triggerFunctions.end() || !it->second)
+	{
+		// The volume is kept, it just won't do anything when touched
+		ReportError(_key, "unknown trigger function \"" + _pending.name + "\", callback dropped", false);
+		return nullptr;
+	}
+
+	// Same slot layout as TriggerFunction::WriteParams, each function only reads the slots it uses
+	TriggerFunctionParams params;
+	params.floats[0] = _pending.location.X;
+	params.floats[1] = _pending.location.Y;
+	params.floats[2] = _pending.location.Z;
+	params.ints[0] = _pending.rotation.Pitch;
+	params.ints[1] = _pending.rotation.Yaw;
+	params.ints[2] = _pending.rotation.Roll;
+	if (_pending.hasCheckpointId)
+		params.ints[0] = _pending.checkpointId;
+	params.flag = _pending.useCurrentCheckpoint;
+
+	std::shared_ptr<TriggerFunction> callback = it->second->Clone();
+	callback->ReadParams(params);
+	return callback;
+}
+
+void JsonMapReader::ReportError(std::string_view _key, std::string_view _message, bool _dropObject)
+{
+	m_errorCount++;
+
+	std::string keyPath = GetKeyPath();
+	if (!_key.empty())
+	{
+		if (!keyPath.empty())
+			keyPath += '.';
+		keyPath += _key;
+	}
+
+	LOG("[ERROR]Object {}, key \"{}\": {}", m_objectIndex, keyPath, _message);
+
+	if (_dropObject && !m_pending.empty())
+		m_pending.back().valid = false;
+}
+
+void JsonMapReader::ReportUnexpected(std::string_view _token)
+{
+	ReportError("", "unexpected " + std::string(_token));
+}
+
+std::string JsonMapReader::GetKeyPath() const
+{
+	std::string keyPath;
+
+	for (const Frame& frame : m_frames)
+	{
+		std::string_view key;
+		switch (frame.kind)
+		{
+		case FrameKind::Object:
+			key = GetFieldName(frame.field);
+			break;
+		case FrameKind::Callback:
+			key = frame.component >= 0 ? CallbackComponents[frame.component] : "?";
+			break;
+		case FrameKind::Vector:
+			key = frame.component >= 0 ? VectorComponents[frame.component] : "?";
+			break;
+		case FrameKind::Rotator:
+			key = frame.component >= 0 ? RotatorComponents[frame.component] : "?";
+			break;
+		case FrameKind::MeshInfos:
+			key = GetMeshInfosComponentName(frame.component);
+			break;
+		default:
+			continue;
+		}
+
+		if (!keyPath.empty())
+			keyPath += '.';
+		keyPath += key;
+	}
+
+	return keyPath;
+}
+
+JsonMapField JsonMapReader::FindField(std::string_view _key)
+{
+	return JsonMapKeys.Find(_key);
+}
+
+std::string_view JsonMapReader::GetFieldName(JsonMapField _field)
+{
+	return _field != JsonMapField::Unknown ? JsonMapKeys.keys[static_cast<size_t>(_field)].name : "?";
+}
@@ -0,0 +1,238 @@
+#pragma once
+#include "ObjectManager.h"
+#include "ObjectFields.h"
+
+#include <array>
+#include <deque>
+#include <filesystem>
+#include <variant>
+
+//What a key holds, decides which SAX events fill it
+enum class JsonValueKind : uint8_t
+{
+	Boolean,
+	Number,
+	String,
+	Vector,
+	Rotator,
+	MeshInfos,
+	Callback,   // object or null
+	Prefab,     // id or null
+	Object      // nested reflected object, built on its own frame
+};
+
+template <typename Member>
+constexpr JsonValueKind GetJsonValueKind()
+{
+	if constexpr (std::is_same_v<Member, bool>)
+		return JsonValueKind::Boolean;
+	else if constexpr (std::is_arithmetic_v<Member> || std::is_enum_v<Member>)
+		return JsonValueKind::Number;
+	else if constexpr (std::is_same_v<Member, std::string>)
+		return JsonValueKind::String;
+	else if constexpr (std::is_same_v<Member, Vector>)
+		return JsonValueKind::Vector;
+	else if constexpr (std::is_same_v<Member, Rotator>)
+		return JsonValueKind::Rotator;
+	else if constexpr (std::is_same_v<Member, MeshInfos>)
+		return JsonValueKind::MeshInfos;
+	else if constexpr (std::is_same_v<Member, std::shared_ptr<TriggerFunction>>)
+		return JsonValueKind::Callback;
+	else if constexpr (std::is_same_v<Member, std::shared_ptr<const RingPrefab>>)
+		return JsonValueKind::Prefab;
+	else
+	{
+		static_assert(std::is_base_of_v<Object, Member>, "No JSON value kind for this field type");
+		return JsonValueKind::Object;
+	}
+}
+
+//Index of a key in JsonMapKeys
+enum class JsonMapField : uint8_t
+{
+	Unknown = 0xFF
+};
+
+struct JsonMapKey
+{
+	std::string_view name;
+	JsonValueKind kind;
+};
+
+//Keys of the map objects : the fields of every reflected object type, each name once, then the keys only maps have
+struct JsonMapKeyTable
+{
+	std::array<JsonMapKey, 64> keys = {};
+	size_t count = 0;
+	bool consistent = true; // a name has the same kind in every type listing it
+
+	constexpr void Add(std::string_view _name, JsonValueKind _kind) {
+		for (size_t i = 0; i < count; i++)
+		{
+			if (keys[i].name == _name)
+			{
+				consistent = consistent && keys[i].kind == _kind;
+				return;
+			}
+		}
+		keys[count++] = JsonMapKey{ _name, _kind };
+	}
+
+	template <ReflectedType T>
+	constexpr void AddFields() {
+		ForEachField<T>([&](const auto& _field, size_t) {
+			Add(_field.name, GetJsonValueKind<typename std::remove_cvref_t<decltype(_field)>::MemberType>());
+			});
+	}
+
+	constexpr JsonMapField Find(std::string_view _name) const {
+		for (size_t i = 0; i < count; i++)
+		{
+			if (keys[i].name == _name)
+				return static_cast<JsonMapField>(i);
+		}
+		return JsonMapField::Unknown;
+	}
+};
+
+constexpr JsonMapKeyTable MakeJsonMapKeys()
+{
+	JsonMapKeyTable table;
+	table.AddFields<Mesh>();
+	table.AddFields<TriggerVolume_Box>();
+	table.AddFields<TriggerVolume_Cylinder>();
+	table.AddFields<Checkpoint>();
+	table.AddFields<Ring>();
+	table.Add("parent", JsonValueKind::Number);
+	table.Add("prefabDefinition", JsonValueKind::Boolean);
+	return table;
+}
+
+inline constexpr JsonMapKeyTable JsonMapKeys = MakeJsonMapKeys();
+static_assert(JsonMapKeys.consistent, "A field name holds a different kind of value in two reflected types");
+static_assert(JsonMapKeys.count < static_cast<size_t>(JsonMapField::Unknown));
+
+struct JsonPendingCallback
+{
+	std::string name;
+	Vector location = Vector(0.f);
+	Rotator rotation = Rotator(0);
+	bool useCurrentCheckpoint = false;
+	int checkpointId = 0;
+	bool hasCheckpointId = false;
+};
+
+//std::monostate until the key is read, then the alternative its JsonValueKind stores (nullptr for a null callback or prefab)
+using JsonPendingValue = std::variant<std::monostate, std::nullptr_t, bool, double, std::string, Vector, Rotator, MeshInfos, JsonPendingCallback, std::shared_ptr<Object>>;
+
+//Values of an object's keys seen so far, the concrete object is only built on its closing brace
+//since keys are written in alphabetical order and "objectType" comes late
+struct JsonPendingObject
+{
+	bool valid = true;
+	std::array<JsonPendingValue, JsonMapKeys.count> values;
+
+	bool Has(JsonMapField _field) const { return !std::holds_alternative<std::monostate>(values[static_cast<size_t>(_field)]); }
+	JsonPendingValue& operator[](JsonMapField _field) { return values[static_cast<size_t>(_field)]; }
+	const JsonPendingValue& operator[](JsonMapField _field) const { return values[static_cast<size_t>(_field)]; }
+};
+
+//Byte range of one element of a map's top-level array
+struct JsonMapElement
+{
+	size_t begin;
+	size_t end;
+	bool isObject;
+};
+
+//Streaming loader for the JSON maps written by SaveConfig.
+//Objects are built from SAX events as tokens arrive, no nlohmann::json DOM is created. Keys are read and assigned through ObjectFields,
+//a field missing from an object is an error unless it's optional (see FieldInfo).
+//A malformed object is reported with its index and key then skipped, the rest of the map still loads.
+//Large maps are split at their top-level elements and parsed in chunks on one thread per core.
+//Prefab definitions come first in the array, they are read before any chunk is parsed and handed out in MapExtras::prefabs,
+//nothing is registered in the PrefabLibrary while the map loads.
+//"parent" holds the position of the parent among the objects of the array, prefab definitions included.
+class JsonMapReader : public nlohmann::json_sax<nlohmann::json>
+{
+public:
+	JsonMapReader(std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects);
+
+	static bool Load(const std::filesystem::path& _filePath, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects, MapExtras& _outExtras);
+
+	bool null() override;
+	bool boolean(bool _value) override;
+	bool number_integer(number_integer_t _value) override;
+	bool number_unsigned(number_unsigned_t _value) override;
+	bool number_float(number_float_t _value, const string_t& _text) override;
+	bool string(string_t& _value) override;
+	bool binary(binary_t& _value) override;
+	bool start_object(std::size_t _elements) override;
+	bool key(string_t& _value) override;
+	bool end_object() override;
+	bool start_array(std::size_t _elements) override;
+	bool end_array() override;
+	bool parse_error(std::size_t _position, const std::string& _lastToken, const nlohmann::detail::exception& _exception) override;
+
+	size_t GetErrorCount() const { return m_errorCount; }
+
+private:
+	enum class FrameKind : uint8_t
+	{
+		Root,
+		Object,
+		Vector,
+		Rotator,
+		MeshInfos,
+		Callback
+	};
+
+	struct Frame
+	{
+		FrameKind kind;
+		JsonMapField field = JsonMapField::Unknown; // last key read in an Object frame
+		int component = -1;                         // last key read in a Vector, Rotator, MeshInfos or Callback frame
+		void* target = nullptr;                     // Vector / Rotator / MeshInfos / JsonPendingCallback being filled
+	};
+
+	// _outPositions / _outParentPositions get the array position and "parent" of every object added to _outObjects
+	static bool LoadElements(const uint8_t* _data, const std::vector<JsonMapElement>& _elements, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions, std::vector<std::shared_ptr<Object>>& _outObjects,
+		std::vector<int>& _outPositions, std::vector<int>& _outParentPositions, std::map<std::string, std::shared_ptr<const RingPrefab>>& _outPrefabs, size_t& _outErrorCount);
+
+	bool OnNumber(double _value);
+	bool OnRootScalar();
+	void StartValueObject(FrameKind _kind, void* _target);
+	void SkipValue();
+
+	std::shared_ptr<Object> BuildObject(const JsonPendingObject& _pending);
+	std::shared_ptr<Ring> BuildRing(const JsonPendingObject& _pending);
+	// A ring made from a prefab (_instance) keeps the template's value for the fields it doesn't store, only the fields of Object are required
+	template <ReflectedType T>
+	bool AssignFields(T& _object, const JsonPendingObject& _pending, bool _instance, uint64_t _skippedFields = 0);
+	template <typename Member>
+	bool AssignValue(Member& _member, const JsonPendingValue& _value, std::string_view _key);
+	std::shared_ptr<const RingPrefab> FindPrefab(const std::string& _id) const;
+	bool Require(const JsonPendingObject& _pending, std::initializer_list<JsonMapField> _fields);
+	std::shared_ptr<TriggerFunction> BuildCallback(const JsonPendingCallback& _pending, std::string_view _key);
+
+	void ReportError(std::string_view _key, std::string_view _message, bool _dropObject = true);
+	void ReportUnexpected(std::string_view _token);
+	std::string GetKeyPath() const;
+
+	static JsonMapField FindField(std::string_view _key);
+	static std::string_view GetFieldName(JsonMapField _field);
+
+	std::map<std::string, std::shared_ptr<TriggerFunction>>& m_triggerFunctions;
+	std::vector<std::shared_ptr<Object>>& m_outObjects;
+
+	std::vector<Frame> m_frames;
+	std::deque<JsonPendingObject> m_pending; // deque so Frame::target pointers survive nested pushes
+	int m_skipDepth = 0;
+	int m_objectIndex = -1;
+	size_t m_errorCount = 0;
+	size_t m_byteOffset = 0; // position of the parsed range in the file, for error messages
+	size_t m_prefabDefinitionCount = 0;
+	std::map<std::string, std::shared_ptr<const RingPrefab>> m_prefabs; // definitions read so far, chunk readers start with the leading ones
+	std::vector<int> m_positions;       // m_objectIndex of each object in m_outObjects
+	std::vector<int> m_parentPositions; // its "parent", -1 for none
+};
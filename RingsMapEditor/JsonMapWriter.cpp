@@ -0,0 +1,413 @@
+#include "pch.h"
+#include <algorithm>
+#include "JsonMapWriter.h"
+#include "TriggerFunctions.h"
+#include "ObjectFields.h"
+#include "PrefabLibrary.h"
+
+#include <charconv>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+	constexpr size_t FlushThreshold = 64 * 1024;
+	constexpr std::string_view ParentKey = "parent";
+}
+
+
+
+JsonMapWriter::JsonMapWriter(std::ostream& _out, bool _pretty)
+	: m_out(_out), m_pretty(_pretty)
+{
+	m_buffer.reserve(FlushThreshold + 4096);
+}
+
+JsonMapWriter::~JsonMapWriter()
+{
+	Flush();
+}
+
+bool JsonMapWriter::Save(const std::filesystem::path& _filePath, const std::vector<std::shared_ptr<Object>>& _objects, const std::vector<int32_t>& _parents, bool _pretty)
+{
+	std::ofstream file = std::ofstream(_filePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG("[ERROR]Could not open config file for writing: {}", _filePath.string());
+		return false;
+	}
+
+	{
+		// Written first so the reader has them registered before their instances
+		std::vector<std::shared_ptr<const RingPrefab>> prefabs;
+		PrefabLibrary::GetUserPrefabs(_objects, prefabs);
+
+		// Position of each object in the array, null objects aren't written
+		std::vector<int32_t> positions;
+		if (!_parents.empty())
+		{
+			positions.resize(_objects.size(), -1);
+			int32_t position = static_cast<int32_t>(prefabs.size());
+			for (size_t i = 0; i < _objects.size(); i++)
+			{
+				if (_objects[i])
+					positions[i] = position++;
+			}
+		}
+
+		JsonMapWriter writer(file, _pretty);
+		writer.BeginArray();
+		for (const std::shared_ptr<const RingPrefab>& prefab : prefabs)
+			writer.WritePrefabDefinition(*prefab);
+		for (size_t i = 0; i < _objects.size(); i++)
+		{
+			if (!_objects[i])
+				continue;
+
+			int32_t parent = i < _parents.size() ? _parents[i] : -1;
+			writer.WriteObject(*_objects[i], parent >= 0 && static_cast<size_t>(parent) < positions.size() ? positions[parent] : -1);
+		}
+		writer.EndArray();
+	}
+
+	if (!file)
+	{
+		LOG("[ERROR]Failed to write config file: {}", _filePath.string());
+		return false;
+	}
+
+	return true;
+}
+
+void JsonMapWriter::WriteObject(const Object& _object, int32_t _parent)
+{
+	switch (_object.objectType)
+	{
+	case ObjectType::Mesh:
+		WriteReflected(static_cast<const Mesh&>(_object), ~uint64_t(0), _parent);
+		break;
+	case ObjectType::TriggerVolume:
+	{
+		// Only the shape is known at run time, each shape is still written from its own field list
+		const TriggerVolume& volume = static_cast<const TriggerVolume&>(_object);
+		if (volume.triggerVolumeType == TriggerVolumeType::Box)
+			WriteReflected(static_cast<const TriggerVolume_Box&>(volume), ~uint64_t(0), _parent);
+		else if (volume.triggerVolumeType == TriggerVolumeType::Cylinder)
+			WriteReflected(static_cast<const TriggerVolume_Cylinder&>(volume), ~uint64_t(0), _parent);
+		else
+			LOG("[ERROR]Skipping trigger volume with unknown type: {}", volume.name);
+		break;
+	}
+	case ObjectType::Checkpoint:
+		WriteReflected(static_cast<const Checkpoint&>(_object), ~uint64_t(0), _parent);
+		break;
+	case ObjectType::Ring:
+	{
+		const Ring& ring = static_cast<const Ring&>(_object);
+		WriteReflected(ring, ring.prefab ? PrefabLibrary::GetInstanceFields() | PrefabLibrary::GetOverrides(ring) : ~uint64_t(0), _parent);
+		break;
+	}
+	default:
+		LOG("[ERROR]Skipping object with unknown type: {}", _object.name);
+		break;
+	}
+}
+
+//Every field of the template, with "prefabDefinition" telling the reader to register it instead of adding a ring
+void JsonMapWriter::WritePrefabDefinition(const RingPrefab& _prefab)
+{
+	BeginObject();
+	ForEachField<Ring>([&](const auto& _field, size_t) {
+		Key(_field.name);
+		if constexpr (std::is_same_v<typename std::remove_cvref_t<decltype(_field)>::MemberType, std::shared_ptr<const RingPrefab>>)
+		{
+			String(_prefab.id);
+			Field("prefabDefinition", true);
+		}
+		else
+		{
+			WriteValue(_field.Get(_prefab.ring));
+		}
+		});
+	EndObject();
+}
+
+
+
+template <typename T>
+void JsonMapWriter::WriteReflected(const T& _object, uint64_t _fieldMask, int32_t _parent)
+{
+	// "parent" isn't a field of the object, it still goes in its alphabetical place
+	bool writeParent = _parent >= 0;
+
+	BeginObject();
+	ForEachField<T>([&](const auto& _field, size_t _index) {
+		if (writeParent && _field.name > ParentKey)
+		{
+			Field(ParentKey, _parent);
+			writeParent = false;
+		}
+
+		if (!(_fieldMask & (uint64_t(1) << _index)))
+			return;
+
+		Key(_field.name);
+		WriteValue(_field.Get(_object));
+		});
+	if (writeParent)
+		Field(ParentKey, _parent);
+	EndObject();
+}
+
+template <typename T>
+void JsonMapWriter::WriteValue(const T& _value)
+{
+	if constexpr (std::is_same_v<T, bool>) Bool(_value);
+	else if constexpr (std::is_floating_point_v<T>) Float(static_cast<float>(_value));
+	else if constexpr (std::is_integral_v<T>) Int(static_cast<int64_t>(_value));
+	else if constexpr (std::is_enum_v<T>) Int(static_cast<int64_t>(static_cast<std::underlying_type_t<T>>(_value)));
+	else if constexpr (std::is_same_v<T, std::string>) String(_value);
+	else if constexpr (std::is_same_v<T, Vector>) WriteVector(_value);
+	else if constexpr (std::is_same_v<T, Rotator>) WriteRotator(_value);
+	else if constexpr (std::is_same_v<T, std::shared_ptr<TriggerFunction>>)
+	{
+		if (_value)
+			_value->WriteJson(*this);
+		else
+			Null();
+	}
+	else if constexpr (std::is_same_v<T, std::shared_ptr<const RingPrefab>>)
+	{
+		if (_value)
+			String(_value->id);
+		else
+			Null();
+	}
+	else
+		WriteReflected(_value);
+}
+
+void TriggerFunction::WriteJson(JsonMapWriter& _writer) const
+{
+	_writer.BeginObject();
+	_writer.Field("description", description);
+	_writer.Field("name", name);
+	_writer.EndObject();
+}
+
+
+
+void JsonMapWriter::BeginObject()
+{
+	Open('{');
+}
+
+void JsonMapWriter::EndObject()
+{
+	Close('}');
+}
+
+void JsonMapWriter::BeginArray()
+{
+	Open('[');
+}
+
+void JsonMapWriter::EndArray()
+{
+	Close(']');
+}
+
+void JsonMapWriter::Key(std::string_view _key)
+{
+	if (m_hasElements)
+		m_buffer += ',';
+	NewLine();
+
+	AppendQuoted(_key);
+	m_buffer += m_pretty ? ": " : ":";
+
+	m_hasElements = true;
+	m_afterKey = true;
+}
+
+void JsonMapWriter::Null()
+{
+	BeginValue();
+	Append("null");
+}
+
+void JsonMapWriter::Bool(bool _value)
+{
+	BeginValue();
+	Append(_value ? "true" : "false");
+}
+
+void JsonMapWriter::Int(int64_t _value)
+{
+	BeginValue();
+
+	char buffer[24];
+	auto result = std::to_chars(buffer, buffer + sizeof(buffer), _value);
+	Append(std::string_view(buffer, result.ptr - buffer));
+}
+
+void JsonMapWriter::Float(float _value)
+{
+	BeginValue();
+
+	// nlohmann writes non-finite numbers as null
+	if (!std::isfinite(_value))
+	{
+		Append("null");
+		return;
+	}
+
+	// Floats are widened like nlohmann::json does, then printed with the shortest round-trip digits.
+	// Same notation rule as nlohmann's dtoa: fixed when the decimal exponent is in [-4, 14], scientific otherwise
+	double value = static_cast<double>(_value);
+	char buffer[48];
+	auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific);
+	std::string_view text(buffer, result.ptr - buffer);
+
+	int exponent = 0;
+	size_t exponentPosition = text.find('e');
+	std::from_chars(text.data() + exponentPosition + (text[exponentPosition + 1] == '+' ? 2 : 1), text.data() + text.size(), exponent);
+
+	if (exponent >= -4 && exponent <= 14)
+	{
+		result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed);
+		text = std::string_view(buffer, result.ptr - buffer);
+		Append(text);
+
+		if (text.find('.') == std::string_view::npos)
+			Append(".0");
+	}
+	else
+	{
+		Append(text);
+	}
+}
+
+void JsonMapWriter::String(std::string_view _value)
+{
+	BeginValue();
+	AppendQuoted(_value);
+
+	if (m_buffer.size() >= FlushThreshold)
+		Flush();
+}
+
+void JsonMapWriter::WriteVector(const Vector& _value)
+{
+	BeginObject();
+	Field("X", _value.X);
+	Field("Y", _value.Y);
+	Field("Z", _value.Z);
+	EndObject();
+}
+
+void JsonMapWriter::WriteRotator(const Rotator& _value)
+{
+	BeginObject();
+	Field("Pitch", _value.Pitch);
+	Field("Roll", _value.Roll);
+	Field("Yaw", _value.Yaw);
+	EndObject();
+}
+
+void JsonMapWriter::Flush()
+{
+	if (m_buffer.empty())
+		return;
+
+	m_out.write(m_buffer.data(), m_buffer.size());
+	m_buffer.clear();
+}
+
+
+
+void JsonMapWriter::BeginValue()
+{
+	if (m_afterKey)
+	{
+		m_afterKey = false;
+		return;
+	}
+
+	// Array element, or the root value
+	if (m_depth > 0)
+	{
+		if (m_hasElements)
+			m_buffer += ',';
+		NewLine();
+		m_hasElements = true;
+	}
+}
+
+void JsonMapWriter::Open(char _bracket)
+{
+	BeginValue();
+	m_buffer += _bracket;
+	m_depth++;
+	m_hasElements = false;
+}
+
+void JsonMapWriter::Close(char _bracket)
+{
+	m_depth--;
+	if (m_hasElements)
+		NewLine();
+	m_buffer += _bracket;
+
+	// The parent holds at least this container
+	m_hasElements = true;
+
+	if (m_buffer.size() >= FlushThreshold)
+		Flush();
+}
+
+void JsonMapWriter::NewLine()
+{
+	if (!m_pretty)
+		return;
+
+	m_buffer += '\n';
+	m_buffer.append(static_cast<size_t>(m_depth) * 4, ' ');
+}
+
+void JsonMapWriter::Append(std::string_view _text)
+{
+	m_buffer.append(_text);
+}
+
+void JsonMapWriter::AppendQuoted(std::string_view _value)
+{
+	m_buffer += '"';
+	for (char c : _value)
+	{
+		switch (c)
+		{
+		case '"': m_buffer += "\\\""; break;
+		case '\\': m_buffer += "\\\\"; break;
+		case '\b': m_buffer += "\\b"; break;
+		case '\f': m_buffer += "\\f"; break;
+		case '\n': m_buffer += "\\n"; break;
+		case '\r': m_buffer += "\\r"; break;
+		case '\t': m_buffer += "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char escaped[7];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+				m_buffer += escaped;
+			}
+			else
+			{
+				m_buffer += c;
+			}
+			break;
+		}
+	}
+	m_buffer += '"';
+}
+
@@ -0,0 +1,77 @@
+#pragma once
+#include "Object.h"
+
+#include <filesystem>
+#include <ostream>
+#include <string_view>
+
+struct RingPrefab;
+
+//Streaming writer for JSON maps.
+//Objects are serialized straight into a chunk buffer flushed to the output stream, no nlohmann::json values are built,
+//so saving keeps a flat memory footprint instead of holding a DOM and its dump(4) string (~270 MB extra for 50k objects).
+//Keys are written in alphabetical order and pretty output uses 4-space indents, matching nlohmann's dump(4).
+//Rings made from a prefab only write their instance fields and their overrides, user prefabs are written in full before the objects.
+//Linked objects carry a "parent" key, the position of their parent in the array (prefab definitions included).
+class JsonMapWriter
+{
+public:
+	JsonMapWriter(std::ostream& _out, bool _pretty);
+	~JsonMapWriter();
+
+	// _parents holds the parent of each object as an index in _objects, -1 for none (see SceneGraph::GetParentIndices)
+	static bool Save(const std::filesystem::path& _filePath, const std::vector<std::shared_ptr<Object>>& _objects, const std::vector<int32_t>& _parents, bool _pretty);
+
+	// _parent is the position of the parent in the written array, -1 writes no "parent" key
+	void WriteObject(const Object& _object, int32_t _parent = -1);
+	void WritePrefabDefinition(const RingPrefab& _prefab);
+
+	void BeginObject();
+	void EndObject();
+	void BeginArray();
+	void EndArray();
+	void Key(std::string_view _key);
+
+	void Null();
+	void Bool(bool _value);
+	void Int(int64_t _value);
+	void Float(float _value);
+	void String(std::string_view _value);
+	void WriteVector(const Vector& _value);
+	void WriteRotator(const Rotator& _value);
+
+	template <typename T>
+	void Field(std::string_view _key, const T& _value) {
+		Key(_key);
+		if constexpr (std::is_same_v<T, bool>) Bool(_value);
+		else if constexpr (std::is_floating_point_v<T>) Float(static_cast<float>(_value));
+		else if constexpr (std::is_integral_v<T>) Int(static_cast<int64_t>(_value));
+		else if constexpr (std::is_same_v<T, Vector>) WriteVector(_value);
+		else if constexpr (std::is_same_v<T, Rotator>) WriteRotator(_value);
+		else String(_value);
+	}
+
+	void Flush();
+
+private:
+	// Driven by ObjectFields<T>, defined and instantiated in JsonMapWriter.cpp only
+	template <typename T>
+	void WriteReflected(const T& _object, uint64_t _fieldMask = ~uint64_t(0), int32_t _parent = -1);
+	template <typename T>
+	void WriteValue(const T& _value);
+
+	void BeginValue();
+	void Open(char _bracket);
+	void Close(char _bracket);
+	void NewLine();
+	void Append(std::string_view _text);
+	void AppendQuoted(std::string_view _value);
+
+	std::ostream& m_out;
+	std::string m_buffer;
+	bool m_pretty = true;
+
+	int m_depth = 0;
+	bool m_hasElements = false; // current container already holds a value, the next one needs a comma
+	bool m_afterKey = false;
+};
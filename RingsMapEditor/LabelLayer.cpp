@@ -0,0 +1,177 @@
+#include "pch.h"
+#include <algorithm>
+#include "LabelLayer.h"
+
+
+LabelLayer::LabelLayer(std::shared_ptr<ObjectManager> _objectManager)
+{
+	m_objectManager = _objectManager;
+}
+
+
+
+void LabelLayer::Render(CanvasWrapper _canvas, CameraWrapper _camera, const Object* _selectedObject)
+{
+	m_drawnCount = 0;
+
+	if (!m_enabled)
+		return;
+
+	RT::Frustum frustum(_canvas, _camera, 50.f, m_maxDistance);
+	CollectCandidates(_canvas, frustum, _camera.GetLocation(), _selectedObject);
+	ResetGrid(_canvas.GetSize());
+
+	std::sort(m_candidates.begin(), m_candidates.end(), [](const LabelCandidate& a, const LabelCandidate& b) {
+		return a.priority < b.priority;
+		});
+
+	int candidateCount = static_cast<int>(m_candidates.size());
+	for (int i = 0; i < candidateCount && m_drawnCount < m_maxLabels; i++)
+	{
+		if (!TryPlaceLabel(i))
+			continue;
+
+		const LabelCandidate& label = m_candidates[i];
+
+		if (label.object == _selectedObject)
+			_canvas.SetColor(255, 255, 0, 255);
+		else
+			_canvas.SetColor(255, 255, 255, 220);
+
+		_canvas.SetPosition(Vector2F{ label.x, label.y });
+		_canvas.DrawString(label.object->name, m_textScale, m_textScale);
+		m_drawnCount++;
+	}
+}
+
+bool LabelLayer::IsEnabled() const
+{
+	return m_enabled;
+}
+
+void LabelLayer::SetEnabled(bool _enabled)
+{
+	m_enabled = _enabled;
+}
+
+int LabelLayer::GetDrawnCount() const
+{
+	return m_drawnCount;
+}
+
+void LabelLayer::CollectCandidates(CanvasWrapper _canvas, RT::Frustum& _frustum, const Vector& _cameraLocation, const Object* _selectedObject)
+{
+	m_candidates.clear();
+
+	//The bounding spheres are culled first on the transform arrays, the anchor is on the sphere
+	const TransformStore& transforms = m_objectManager->GetTransforms();
+	transforms.FindInFrustum(_frustum, m_visibleRows);
+
+	std::vector<std::shared_ptr<Object>>& objects = m_objectManager->GetObjects();
+	for (uint32_t row : m_visibleRows)
+	{
+		std::shared_ptr<Object>& object = objects[row];
+		if (!object || object->name.empty())
+			continue;
+
+		//Anchor the label on top of the object
+		Vector anchor = transforms.GetLocation(row) + Vector(0.f, 0.f, transforms.GetBoundingRadius(row));
+		if (!_frustum.IsInFrustum(anchor))
+			continue;
+
+		Vector toAnchor = anchor - _cameraLocation;
+		Vector2F projected = _canvas.ProjectF(anchor);
+
+		LabelCandidate candidate;
+		candidate.object = object.get();
+		candidate.width = static_cast<float>(object->name.size()) * m_charWidth * m_textScale;
+		candidate.height = m_lineHeight * m_textScale;
+		candidate.x = projected.X - (candidate.width / 2.f);
+		candidate.y = projected.Y - candidate.height;
+
+		if (object.get() == _selectedObject)
+			candidate.priority = -1.f; // always first
+		else
+			candidate.priority = toAnchor.magnitude() * GetTypePriorityFactor(object->objectType);
+
+		m_candidates.emplace_back(candidate);
+	}
+}
+
+void LabelLayer::ResetGrid(const Vector2& _screenSize)
+{
+	int columns = max(1, static_cast<int>(ceilf(_screenSize.X / m_cellWidth)));
+	int rows = max(1, static_cast<int>(ceilf(_screenSize.Y / m_cellHeight)));
+
+	if (columns != m_gridColumns || rows != m_gridRows)
+	{
+		m_gridColumns = columns;
+		m_gridRows = rows;
+		m_cells.resize(static_cast<size_t>(columns) * rows);
+	}
+
+	for (std::vector<int>& cell : m_cells)
+	{
+		cell.clear();
+	}
+}
+
+bool LabelLayer::TryPlaceLabel(int _candidateIndex)
+{
+	const LabelCandidate& label = m_candidates[_candidateIndex];
+
+	int minColumn = static_cast<int>(floorf(label.x / m_cellWidth));
+	int maxColumn = static_cast<int>(floorf((label.x + label.width) / m_cellWidth));
+	int minRow = static_cast<int>(floorf(label.y / m_cellHeight));
+	int maxRow = static_cast<int>(floorf((label.y + label.height) / m_cellHeight));
+
+	//Fully off screen
+	if (maxColumn < 0 || maxRow < 0 || minColumn >= m_gridColumns || minRow >= m_gridRows)
+		return false;
+
+	minColumn = max(minColumn, 0);
+	minRow = max(minRow, 0);
+	maxColumn = min(maxColumn, m_gridColumns - 1);
+	maxRow = min(maxRow, m_gridRows - 1);
+
+	for (int row = minRow; row <= maxRow; row++)
+	{
+		for (int column = minColumn; column <= maxColumn; column++)
+		{
+			for (int placedIndex : m_cells[row * m_gridColumns + column])
+			{
+				if (Overlaps(label, m_candidates[placedIndex]))
+					return false;
+			}
+		}
+	}
+
+	for (int row = minRow; row <= maxRow; row++)
+	{
+		for (int column = minColumn; column <= maxColumn; column++)
+		{
+			m_cells[row * m_gridColumns + column].push_back(_candidateIndex);
+		}
+	}
+
+	return true;
+}
+
+bool LabelLayer::Overlaps(const LabelCandidate& a, const LabelCandidate& b)
+{
+	return a.x < b.x + b.width && b.x < a.x + a.width
+		&& a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+float LabelLayer::GetTypePriorityFactor(ObjectType _objectType)
+{
+	//Lower factor means the label wins against objects of other types at the same distance
+	if (_objectType == ObjectType::Checkpoint)
+		return 0.5f;
+	else if (_objectType == ObjectType::Ring)
+		return 0.75f;
+	else if (_objectType == ObjectType::TriggerVolume)
+		return 1.f;
+	else
+		return 1.25f;
+}
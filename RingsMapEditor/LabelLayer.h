@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ObjectManager.h"
+
+struct LabelCandidate
+{
+	Object* object = nullptr;
+	float priority = 0.f; // lower is drawn first
+	float x = 0.f;        // label rectangle in screen space
+	float y = 0.f;
+	float width = 0.f;
+	float height = 0.f;
+};
+
+//Draws object names in the world.
+//Labels are sorted by priority (selected, then nearest weighted by object type) and binned into a screen grid,
+//a label overlapping an already accepted one is dropped, so the number of DrawString calls is bounded by the screen area.
+class LabelLayer
+{
+public:
+	LabelLayer(std::shared_ptr<ObjectManager> _objectManager);
+	~LabelLayer() = default;
+
+	void Render(CanvasWrapper _canvas, CameraWrapper _camera, const Object* _selectedObject);
+
+	bool IsEnabled() const;
+	void SetEnabled(bool _enabled);
+	int GetDrawnCount() const;
+
+private:
+	void CollectCandidates(CanvasWrapper _canvas, RT::Frustum& _frustum, const Vector& _cameraLocation, const Object* _selectedObject);
+	void ResetGrid(const Vector2& _screenSize);
+	bool TryPlaceLabel(int _candidateIndex);
+	static bool Overlaps(const LabelCandidate& a, const LabelCandidate& b);
+	static float GetTypePriorityFactor(ObjectType _objectType);
+
+	std::shared_ptr<ObjectManager> m_objectManager;
+	bool m_enabled = true;
+	int m_drawnCount = 0;
+
+	//Reused every frame to avoid reallocating
+	std::vector<LabelCandidate> m_candidates;
+	std::vector<uint32_t> m_visibleRows;
+	std::vector<std::vector<int>> m_cells; // indices into m_candidates of accepted labels
+	int m_gridColumns = 0;
+	int m_gridRows = 0;
+
+	//Settings
+	int m_maxLabels = 64;
+	float m_maxDistance = 15000.f;
+	float m_cellWidth = 128.f;
+	float m_cellHeight = 32.f;
+	float m_textScale = 1.f;
+	float m_charWidth = 8.f;   // approximation of the default canvas font, avoids measuring every string
+	float m_lineHeight = 15.f;
+};
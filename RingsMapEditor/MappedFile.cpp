@@ -0,0 +1,116 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::filesystem::path& _filePath)
+{
+	Close();
+
+	if (OpenMapped(_filePath))
+		return true;
+
+	return OpenBuffered(_filePath);
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (m_mapping)
+	{
+		UnmapViewOfFile(m_data);
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+	}
+	if (m_file)
+	{
+		CloseHandle(m_file);
+		m_file = nullptr;
+	}
+#endif
+
+	m_buffer.clear();
+	m_buffer.shrink_to_fit();
+	m_data = nullptr;
+	m_size = 0;
+}
+
+bool MappedFile::OpenMapped(const std::filesystem::path& _filePath)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileW(_filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	// Empty files can't be mapped, and anything that doesn't fit the address space goes through the fallback
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 || static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_file = file;
+	m_mapping = mapping;
+	m_data = static_cast<const uint8_t*>(view);
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool MappedFile::OpenBuffered(const std::filesystem::path& _filePath)
+{
+	std::ifstream file = std::ifstream(_filePath, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		LOG("[ERROR]Could not open file: {}", _filePath.string());
+		return false;
+	}
+
+	std::streamsize size = file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	m_buffer.resize(static_cast<size_t>(size));
+	if (size > 0 && !file.read(reinterpret_cast<char*>(m_buffer.data()), size))
+	{
+		LOG("[ERROR]Failed to read file: {}", _filePath.string());
+		m_buffer.clear();
+		return false;
+	}
+
+	m_data = m_buffer.data();
+	m_size = m_buffer.size();
+	return true;
+}
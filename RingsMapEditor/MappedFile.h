@@ -0,0 +1,34 @@
+#pragma once
+#include <filesystem>
+#include <vector>
+
+//Read-only view of a whole file.
+//The file is memory mapped when possible, otherwise its content is read into an owned buffer.
+//Either way Data() stays valid until the MappedFile is closed or destroyed.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const std::filesystem::path& _filePath);
+	void Close();
+
+	const uint8_t* Data() const { return m_data; }
+	size_t Size() const { return m_size; }
+	bool IsMapped() const { return m_mapping != nullptr; }
+
+private:
+	bool OpenMapped(const std::filesystem::path& _filePath);
+	bool OpenBuffered(const std::filesystem::path& _filePath);
+
+	const uint8_t* m_data = nullptr;
+	size_t m_size = 0;
+
+	void* m_file = nullptr;      // HANDLE
+	void* m_mapping = nullptr;   // HANDLE
+	std::vector<uint8_t> m_buffer;
+};
@@ -69,22 +69,8 @@ public:
 
     static UPhysicalMaterial* GetStickyWallsPhysMaterial();
 
-    nlohmann::json to_json() const override {
-        return nlohmann::json {
-            {"objectType", static_cast<uint8_t>(objectType)},
-            {"name", name},
-            {"location", location},
-            {"rotation", rotation},
-            {"scale", scale},
-            {"meshInfos", meshInfos},
-            {"enableCollisions", enableCollisions},
-            {"enablePhysics", enablePhysics},
-            {"enableStickyWalls", enableStickyWalls},
-        };
-    }
-
 	std::shared_ptr<Object> Clone() override {
-		std::shared_ptr<Mesh> clonedMesh = std::make_shared<Mesh>(*this);
+		std::shared_ptr<Mesh> clonedMesh = MakePooled<Mesh>(*this);
         if (clonedMesh->instance)
         {
             clonedMesh->SpawnInstance();
@@ -0,0 +1,268 @@
+#include "pch.h"
+#include <algorithm>
+#include "MeshCatalogue.h"
+#include "MappedFile.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	//Index layout : MeshIndexHeader, then per entry fileSize, lastWriteTime and the three strings (uint32 length + UTF-8 bytes)
+#pragma pack(push, 1)
+	struct MeshIndexHeader
+	{
+		char magic[4];
+		uint16_t version;
+		uint16_t headerSize;
+		uint32_t entryCount;
+	};
+#pragma pack(pop)
+
+	static_assert(sizeof(MeshIndexHeader) == 12);
+
+	constexpr char MeshIndexMagic[4] = { 'R', 'M', 'E', 'I' };
+	constexpr uint16_t MeshIndexVersion = 1;
+
+	class IndexReader
+	{
+	public:
+		IndexReader(const uint8_t* _data, size_t _size) : m_data(_data), m_size(_size) {}
+
+		template <typename T>
+		bool Read(T& _out) {
+			if (m_size - m_offset < sizeof(T))
+				return false;
+
+			std::memcpy(&_out, m_data + m_offset, sizeof(T));
+			m_offset += sizeof(T);
+			return true;
+		}
+
+		bool ReadString(std::string& _out) {
+			uint32_t length = 0;
+			if (!Read(length) || m_size - m_offset < length)
+				return false;
+
+			_out.assign(reinterpret_cast<const char*>(m_data + m_offset), length);
+			m_offset += length;
+			return true;
+		}
+
+		void Skip(size_t _bytes) { m_offset = std::min(m_size, m_offset + _bytes); }
+
+	private:
+		const uint8_t* m_data;
+		size_t m_size;
+		size_t m_offset = 0;
+	};
+
+	void WriteString(std::vector<uint8_t>& _buffer, const std::string& _value)
+	{
+		uint32_t length = static_cast<uint32_t>(_value.size());
+		const uint8_t* lengthBytes = reinterpret_cast<const uint8_t*>(&length);
+		_buffer.insert(_buffer.end(), lengthBytes, lengthBytes + sizeof(length));
+		_buffer.insert(_buffer.end(), _value.begin(), _value.end());
+	}
+
+	template <typename T>
+	void WriteValue(std::vector<uint8_t>& _buffer, const T& _value)
+	{
+		const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&_value);
+		_buffer.insert(_buffer.end(), bytes, bytes + sizeof(T));
+	}
+}
+
+
+
+MeshCatalogue::MeshCatalogue(const std::filesystem::path& _meshesPath, const std::filesystem::path& _indexPath)
+	: m_meshesPath(_meshesPath), m_indexPath(_indexPath)
+{
+}
+
+std::vector<MeshInfos> MeshCatalogue::Scan(bool _fullRescan)
+{
+	if (_fullRescan)
+		m_entries.clear();
+	else if (m_entries.empty())
+		LoadIndex();
+
+	std::vector<MeshCatalogueEntry> entries;
+	entries.reserve(m_entries.size());
+	size_t parsedCount = 0;
+
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(m_meshesPath, error))
+	{
+		if (entry.path().extension() != ".json")
+			continue;
+
+		// Size and write time come from the directory listing, unchanged descriptors are never opened
+		MeshCatalogueEntry catalogueEntry;
+		catalogueEntry.fileName = entry.path().filename().string();
+		std::error_code statError;
+		catalogueEntry.fileSize = entry.file_size(statError);
+		catalogueEntry.lastWriteTime = entry.last_write_time(statError).time_since_epoch().count();
+
+		auto cached = std::lower_bound(m_entries.begin(), m_entries.end(), catalogueEntry.fileName, [](const MeshCatalogueEntry& _entry, const std::string& _fileName) {
+			return _entry.fileName < _fileName;
+			});
+
+		if (cached != m_entries.end() && cached->fileName == catalogueEntry.fileName
+			&& cached->fileSize == catalogueEntry.fileSize && cached->lastWriteTime == catalogueEntry.lastWriteTime)
+		{
+			entries.push_back(*cached);
+			continue;
+		}
+
+		if (!ParseMeshInfos(entry.path(), catalogueEntry.meshInfos))
+			continue;
+
+		entries.push_back(std::move(catalogueEntry));
+		parsedCount++;
+	}
+
+	if (error)
+		LOG("[ERROR]Could not list mesh configs in {}: {}", m_meshesPath.string(), error.message());
+
+	std::sort(entries.begin(), entries.end(), [](const MeshCatalogueEntry& _a, const MeshCatalogueEntry& _b) {
+		return _a.fileName < _b.fileName;
+		});
+
+	bool indexChanged = parsedCount > 0 || entries.size() != m_entries.size();
+	m_entries = std::move(entries);
+
+	if (indexChanged)
+		SaveIndex();
+
+	LOG("Found {} available meshes in {} ({} parsed, {} from the index)", m_entries.size(), m_meshesPath.string(), parsedCount, m_entries.size() - parsedCount);
+
+	std::vector<MeshInfos> availableMeshes;
+	availableMeshes.reserve(m_entries.size());
+	for (const MeshCatalogueEntry& entry : m_entries)
+		availableMeshes.push_back(entry.meshInfos);
+
+	return availableMeshes;
+}
+
+bool MeshCatalogue::LoadIndex()
+{
+	if (!std::filesystem::exists(m_indexPath))
+		return false;
+
+	MappedFile file;
+	if (!file.Open(m_indexPath))
+	{
+		LOG("[ERROR]Could not open mesh index: {}", m_indexPath.string());
+		return false;
+	}
+
+	IndexReader reader(file.Data(), file.Size());
+
+	MeshIndexHeader header;
+	if (!reader.Read(header) || std::memcmp(header.magic, MeshIndexMagic, sizeof(MeshIndexMagic)) != 0
+		|| header.version != MeshIndexVersion || header.headerSize < sizeof(MeshIndexHeader))
+	{
+		LOG("[ERROR]Mesh index is invalid, every mesh config will be parsed again: {}", m_indexPath.string());
+		return false;
+	}
+	reader.Skip(header.headerSize - sizeof(MeshIndexHeader));
+
+	std::vector<MeshCatalogueEntry> entries;
+	entries.reserve(header.entryCount);
+
+	for (uint32_t i = 0; i < header.entryCount; i++)
+	{
+		MeshCatalogueEntry entry;
+		if (!reader.Read(entry.fileSize) || !reader.Read(entry.lastWriteTime)
+			|| !reader.ReadString(entry.fileName) || !reader.ReadString(entry.meshInfos.name) || !reader.ReadString(entry.meshInfos.meshPath))
+		{
+			LOG("[ERROR]Mesh index is truncated, every mesh config will be parsed again: {}", m_indexPath.string());
+			return false;
+		}
+
+		entries.push_back(std::move(entry));
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const MeshCatalogueEntry& _a, const MeshCatalogueEntry& _b) {
+		return _a.fileName < _b.fileName;
+		});
+
+	m_entries = std::move(entries);
+	return true;
+}
+
+bool MeshCatalogue::SaveIndex() const
+{
+	std::vector<uint8_t> buffer;
+	buffer.reserve(sizeof(MeshIndexHeader) + m_entries.size() * 96);
+
+	MeshIndexHeader header;
+	std::memcpy(header.magic, MeshIndexMagic, sizeof(MeshIndexMagic));
+	header.version = MeshIndexVersion;
+	header.headerSize = sizeof(MeshIndexHeader);
+	header.entryCount = static_cast<uint32_t>(m_entries.size());
+	WriteValue(buffer, header);
+
+	for (const MeshCatalogueEntry& entry : m_entries)
+	{
+		WriteValue(buffer, entry.fileSize);
+		WriteValue(buffer, entry.lastWriteTime);
+		WriteString(buffer, entry.fileName);
+		WriteString(buffer, entry.meshInfos.name);
+		WriteString(buffer, entry.meshInfos.meshPath);
+	}
+
+	std::filesystem::path tempPath = m_indexPath;
+	tempPath += ".tmp";
+
+	{
+		std::ofstream file = std::ofstream(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			LOG("[ERROR]Could not open mesh index for writing: {}", tempPath.string());
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+		if (!file)
+		{
+			LOG("[ERROR]Failed to write mesh index: {}", tempPath.string());
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, m_indexPath, error);
+	if (error)
+	{
+		LOG("[ERROR]Could not move {} into place: {}", tempPath.string(), error.message());
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+
+	return true;
+}
+
+bool MeshCatalogue::ParseMeshInfos(const std::filesystem::path& _filePath, MeshInfos& _outMeshInfos)
+{
+	std::ifstream file = std::ifstream(_filePath);
+	if (!file.is_open())
+	{
+		LOG("[ERROR]Could not open mesh config file: {}", _filePath.string());
+		return false;
+	}
+
+	try
+	{
+		nlohmann::json meshInfos_json = nlohmann::json::parse(file);
+		_outMeshInfos = meshInfos_json.get<MeshInfos>();
+	}
+	catch (const nlohmann::json::exception& e)
+	{
+		LOG("[ERROR]Failed to parse mesh config file: {}", e.what());
+		return false;
+	}
+
+	return true;
+}
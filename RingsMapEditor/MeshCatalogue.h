@@ -0,0 +1,36 @@
+#pragma once
+#include "Mesh.h"
+
+#include <filesystem>
+
+struct MeshCatalogueEntry
+{
+	std::string fileName;       // mesh descriptor file name, relative to the meshes folder
+	uint64_t fileSize = 0;
+	int64_t lastWriteTime = 0;  // file_time_type ticks
+	MeshInfos meshInfos;
+};
+
+//Index of the mesh descriptor files (one small JSON per mesh) found in the meshes folder.
+//The parsed MeshInfos are cached in a single binary index file along with each descriptor's size and last write time,
+//so a scan only parses descriptors that were added or changed since the last one.
+class MeshCatalogue
+{
+public:
+	MeshCatalogue(const std::filesystem::path& _meshesPath, const std::filesystem::path& _indexPath);
+
+	// A full rescan ignores the cached index and parses every descriptor again
+	std::vector<MeshInfos> Scan(bool _fullRescan = false);
+
+	const std::vector<MeshCatalogueEntry>& GetEntries() const { return m_entries; }
+
+private:
+	bool LoadIndex();
+	bool SaveIndex() const;
+
+	static bool ParseMeshInfos(const std::filesystem::path& _filePath, MeshInfos& _outMeshInfos);
+
+	std::filesystem::path m_meshesPath;
+	std::filesystem::path m_indexPath;
+	std::vector<MeshCatalogueEntry> m_entries; // sorted by file name
+};
@@ -0,0 +1,309 @@
+#include "pch.h"
+#include <algorithm>
+#include "NameIndex.h"
+
+namespace
+{
+	// Removed entries are dropped once there are this many and they outnumber the others
+	constexpr size_t CompactionThreshold = 1024;
+
+	void AppendLowercase(std::string_view _text, std::string& _out)
+	{
+		for (char c : _text)
+			_out.push_back((c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c);
+	}
+}
+
+
+
+void NameIndex::Add(const Object& _object, SlotHandle _handle)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto it = m_entryByObject.find(&_object);
+	if (it != m_entryByObject.end())
+		RemoveEntry(it->second);
+
+	AddEntry(_object, _handle);
+	m_version++;
+}
+
+void NameIndex::Remove(const Object* _object)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto it = m_entryByObject.find(_object);
+	if (it == m_entryByObject.end())
+		return;
+
+	RemoveEntry(it->second);
+	m_version++;
+
+	if (m_removedCount >= CompactionThreshold && m_removedCount * 2 > m_entries.size())
+		Compact();
+}
+
+void NameIndex::Replace(const Object* _oldObject, const Object& _newObject)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto it = m_entryByObject.find(_oldObject);
+	if (it == m_entryByObject.end())
+		return;
+
+	uint32_t entryIndex = it->second;
+	SlotHandle handle = m_entries[entryIndex].handle;
+	RemoveEntry(entryIndex);
+	AddEntry(_newObject, handle);
+	m_version++;
+}
+
+void NameIndex::Rename(const Object& _object)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto it = m_entryByObject.find(&_object);
+	if (it == m_entryByObject.end())
+		return;
+
+	std::string key;
+	AppendLowercase(_object.name, key);
+	if (GetKey(m_entries[it->second]) == key)
+		return;
+
+	uint32_t entryIndex = it->second;
+	SlotHandle handle = m_entries[entryIndex].handle;
+	RemoveEntry(entryIndex);
+	AddEntry(_object, handle);
+	m_version++;
+}
+
+void NameIndex::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_entries.clear();
+	m_keys.clear();
+	m_entryByObject.clear();
+	m_removedCount = 0;
+	m_order.clear();
+	m_unordered.clear();
+	m_version++;
+}
+
+void NameIndex::Reserve(size_t _capacity)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_entries.reserve(_capacity);
+	m_entryByObject.reserve(_capacity);
+	m_unordered.reserve(_capacity);
+}
+
+size_t NameIndex::Size() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_entryByObject.size();
+}
+
+void NameIndex::Find(std::string_view _query, NameMatch _match, uint32_t _typeMask, std::vector<SlotHandle>& _outHandles)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::string query;
+	AppendLowercase(_query, query);
+
+	// Matches of "ring 1" are a subset of the matches of "ring", only those are checked again
+	const bool refines = m_lastVersion == m_version && m_lastMatch == _match && m_lastTypeMask == _typeMask
+		&& (_match == NameMatch::Prefix ? query.starts_with(m_lastQuery) : query.find(m_lastQuery) != std::string::npos);
+
+	if (refines)
+	{
+		if (query != m_lastQuery)
+		{
+			auto end = std::remove_if(m_lastResults.begin(), m_lastResults.end(), [&](uint32_t _entryIndex) {
+				return !Matches(m_entries[_entryIndex], query, _match, _typeMask);
+				});
+			m_lastResults.erase(end, m_lastResults.end());
+		}
+	}
+	else if (_match == NameMatch::Prefix)
+	{
+		FindPrefix(query, _typeMask, m_lastResults);
+	}
+	else
+	{
+		FindSubstring(query, _typeMask, m_lastResults);
+	}
+
+	m_lastVersion = m_version;
+	m_lastQuery = std::move(query);
+	m_lastMatch = _match;
+	m_lastTypeMask = _typeMask;
+
+	_outHandles.clear();
+	_outHandles.reserve(m_lastResults.size());
+	for (uint32_t entryIndex : m_lastResults)
+		_outHandles.push_back(m_entries[entryIndex].handle);
+}
+
+void NameIndex::AddEntry(const Object& _object, SlotHandle _handle)
+{
+	Entry entry;
+	entry.object = &_object;
+	entry.handle = _handle;
+	entry.objectType = _object.objectType;
+	entry.removed = false;
+	entry.keyOffset = static_cast<uint32_t>(m_keys.size());
+
+	AppendLowercase(_object.name, m_keys);
+	entry.keyLength = static_cast<uint32_t>(m_keys.size() - entry.keyOffset);
+	m_keys.push_back('\0'); // a substring match can't run into the next name
+
+	const uint32_t entryIndex = static_cast<uint32_t>(m_entries.size());
+	m_entries.push_back(entry);
+	m_entryByObject[&_object] = entryIndex;
+	m_unordered.push_back(entryIndex);
+}
+
+void NameIndex::RemoveEntry(uint32_t _entryIndex)
+{
+	Entry& entry = m_entries[_entryIndex];
+	m_entryByObject.erase(entry.object);
+	entry.removed = true;
+	m_removedCount++;
+}
+
+std::string_view NameIndex::GetKey(const Entry& _entry) const
+{
+	return std::string_view(m_keys.data() + _entry.keyOffset, _entry.keyLength);
+}
+
+//New entries are sorted among themselves then merged in, a load sorts once instead of inserting one name at a time
+void NameIndex::UpdateOrder()
+{
+	if (m_unordered.empty())
+		return;
+
+	auto byKey = [this](uint32_t _a, uint32_t _b) {
+		int comparison = GetKey(m_entries[_a]).compare(GetKey(m_entries[_b]));
+		return comparison < 0 || (comparison == 0 && _a < _b);
+		};
+
+	std::sort(m_unordered.begin(), m_unordered.end(), byKey);
+
+	const size_t orderedCount = m_order.size();
+	m_order.insert(m_order.end(), m_unordered.begin(), m_unordered.end());
+	std::inplace_merge(m_order.begin(), m_order.begin() + orderedCount, m_order.end(), byKey);
+	m_unordered.clear();
+}
+
+//Rebuilds the buffers without the removed entries, entry indices change
+void NameIndex::Compact()
+{
+	std::vector<uint32_t> newIndices(m_entries.size(), UINT32_MAX);
+	std::vector<Entry> entries;
+	std::string keys;
+	entries.reserve(m_entries.size() - m_removedCount);
+	keys.reserve(m_keys.size());
+
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		if (m_entries[i].removed)
+			continue;
+
+		Entry entry = m_entries[i];
+		entry.keyOffset = static_cast<uint32_t>(keys.size());
+		keys.append(GetKey(m_entries[i]));
+		keys.push_back('\0');
+
+		newIndices[i] = static_cast<uint32_t>(entries.size());
+		m_entryByObject[entry.object] = newIndices[i];
+		entries.push_back(entry);
+	}
+
+	auto remap = [&newIndices](std::vector<uint32_t>& _entryIndices) {
+		size_t count = 0;
+		for (uint32_t entryIndex : _entryIndices)
+		{
+			if (newIndices[entryIndex] != UINT32_MAX)
+				_entryIndices[count++] = newIndices[entryIndex];
+		}
+		_entryIndices.resize(count);
+		};
+	remap(m_order);
+	remap(m_unordered);
+
+	m_entries = std::move(entries);
+	m_keys = std::move(keys);
+	m_removedCount = 0;
+}
+
+void NameIndex::FindPrefix(std::string_view _query, uint32_t _typeMask, std::vector<uint32_t>& _outEntries)
+{
+	UpdateOrder();
+	_outEntries.clear();
+
+	auto it = std::lower_bound(m_order.begin(), m_order.end(), _query, [this](uint32_t _entryIndex, std::string_view _value) {
+		return GetKey(m_entries[_entryIndex]) < _value;
+		});
+
+	for (; it != m_order.end(); ++it)
+	{
+		const Entry& entry = m_entries[*it];
+		if (!GetKey(entry).starts_with(_query))
+			break;
+
+		if (!entry.removed && (_typeMask & GetObjectTypeBit(entry.objectType)))
+			_outEntries.push_back(*it);
+	}
+}
+
+void NameIndex::FindSubstring(std::string_view _query, uint32_t _typeMask, std::vector<uint32_t>& _outEntries) const
+{
+	_outEntries.clear();
+
+	if (_query.empty())
+	{
+		for (size_t i = 0; i < m_entries.size(); i++)
+		{
+			if (!m_entries[i].removed && (_typeMask & GetObjectTypeBit(m_entries[i].objectType)))
+				_outEntries.push_back(static_cast<uint32_t>(i));
+		}
+		return;
+	}
+
+	const std::string_view keys = m_keys;
+	size_t entryIndex = 0;
+	size_t position = keys.find(_query);
+	while (position != std::string_view::npos)
+	{
+		// Entries are in m_keys order and matches come in increasing positions : gallop forward from the previous match
+		// to the last entry starting at or before this one, dense matches cost a step or two and sparse ones a short binary search
+		size_t step = 1;
+		while (entryIndex + step < m_entries.size() && m_entries[entryIndex + step].keyOffset <= position)
+		{
+			entryIndex += step;
+			step *= 2;
+		}
+		auto it = std::upper_bound(m_entries.begin() + entryIndex, m_entries.begin() + std::min<size_t>(entryIndex + step, m_entries.size()), position, [](size_t _position, const Entry& _entry) {
+			return _position < _entry.keyOffset;
+			});
+		entryIndex = (it - m_entries.begin()) - 1;
+		const Entry& entry = m_entries[entryIndex];
+
+		if (!entry.removed && (_typeMask & GetObjectTypeBit(entry.objectType)))
+			_outEntries.push_back(static_cast<uint32_t>(entryIndex));
+
+		position = keys.find(_query, entry.keyOffset + entry.keyLength + 1);
+	}
+}
+
+bool NameIndex::Matches(const Entry& _entry, std::string_view _query, NameMatch _match, uint32_t _typeMask) const
+{
+	if (_entry.removed || !(_typeMask & GetObjectTypeBit(_entry.objectType)))
+		return false;
+
+	std::string_view key = GetKey(_entry);
+	return (_match == NameMatch::Prefix) ? key.starts_with(_query) : key.find(_query) != std::string_view::npos;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "Object.h"
+#include "SlotMap.h"
+
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+enum class NameMatch : uint8_t
+{
+	Prefix,
+	Substring
+};
+
+//Bit per ObjectType, for the _typeMask of NameIndex::Find
+constexpr uint32_t GetObjectTypeBit(ObjectType _objectType) { return 1u << static_cast<uint32_t>(_objectType); }
+constexpr uint32_t AllObjectTypes = ~0u;
+
+//Case insensitive index of the scene object names, kept up to date by ObjectManager.
+//Lowercase names are stored back to back in one buffer, so a substring search is a single pass over contiguous bytes,
+//and an order over them answers prefix searches with a binary search.
+//A query that extends the previous one only filters the previous results, typing in the search box never scans every name again.
+class NameIndex
+{
+public:
+	void Add(const Object& _object, SlotHandle _handle);
+	void Remove(const Object* _object);
+	// The object at _oldObject was replaced by _newObject (trigger volume conversion)
+	void Replace(const Object* _oldObject, const Object& _newObject);
+	// Reads the name of _object again, nothing happens when it didn't change
+	void Rename(const Object& _object);
+	void Clear();
+	void Reserve(size_t _capacity);
+	size_t Size() const;
+
+	// Replace _outHandles with the objects whose name matches _query and whose type is in _typeMask.
+	// Prefix matches come in name order, substring matches in the order the objects were indexed.
+	void Find(std::string_view _query, NameMatch _match, uint32_t _typeMask, std::vector<SlotHandle>& _outHandles);
+
+private:
+	struct Entry
+	{
+		const Object* object;
+		SlotHandle handle;
+		ObjectType objectType;
+		bool removed;
+		uint32_t keyOffset; // lowercase name in m_keys
+		uint32_t keyLength;
+	};
+
+	void AddEntry(const Object& _object, SlotHandle _handle);
+	void RemoveEntry(uint32_t _entryIndex);
+	std::string_view GetKey(const Entry& _entry) const;
+	void UpdateOrder();
+	void Compact();
+	void FindPrefix(std::string_view _query, uint32_t _typeMask, std::vector<uint32_t>& _outEntries);
+	void FindSubstring(std::string_view _query, uint32_t _typeMask, std::vector<uint32_t>& _outEntries) const;
+	bool Matches(const Entry& _entry, std::string_view _query, NameMatch _match, uint32_t _typeMask) const;
+
+	mutable std::mutex m_mutex; // searched from the ImGui render thread, objects are added and removed from the game thread too
+
+	std::vector<Entry> m_entries; // in m_keys order, removed entries stay until the next compaction
+	std::string m_keys;
+	std::unordered_map<const Object*, uint32_t> m_entryByObject;
+	size_t m_removedCount = 0;
+
+	std::vector<uint32_t> m_order;     // entries ordered by key, removed ones are skipped
+	std::vector<uint32_t> m_unordered; // entries added since m_order was last merged
+
+	// Previous search, reused when the next query extends it and the index didn't change
+	uint64_t m_version = 0;
+	uint64_t m_lastVersion = UINT64_MAX;
+	std::string m_lastQuery;
+	NameMatch m_lastMatch = NameMatch::Substring;
+	uint32_t m_lastTypeMask = 0;
+	std::vector<uint32_t> m_lastResults;
+};
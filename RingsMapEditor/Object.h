@@ -6,6 +6,8 @@
 
 #include "nlohmann/json.hpp"
 
+#include "ObjectPool.h"
+
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(FVector, X, Y, Z)
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Vector, X, Y, Z)
 NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(FRotator, Pitch, Yaw, Roll)
@@ -34,7 +36,6 @@ public:
 
 	virtual ~Object() {}
 
-    virtual nlohmann::json to_json() const = 0;
     virtual std::shared_ptr<Object> Clone() = 0;
 
 
@@ -54,6 +55,16 @@ public:
         rotation = _newRotation;
     }
 
+    // Pushes the transform into what the object drives (a ring's mesh and trigger volumes), setters only mark it.
+    // Moving an object several times in a tick costs one update
+    virtual void UpdateChildren() {
+    }
+
+    // Radius of a sphere centered on GetLocation() that contains the whole object, used for culling
+    virtual float GetBoundingRadius() const {
+        return 0.f;
+    }
+
     FVector GetFVectorLocation() const {
 		return VectorToFVector(location);
 	}
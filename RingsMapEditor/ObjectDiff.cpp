@@ -0,0 +1,101 @@
+#include "pch.h"
+#include <algorithm>
+#include "ObjectDiff.h"
+#include "FieldCodec.h"
+#include "PrefabLibrary.h"
+
+namespace
+{
+	bool IsSameType(const Object& _a, const Object& _b)
+	{
+		if (_a.objectType != _b.objectType)
+			return false;
+
+		if (_a.objectType == ObjectType::TriggerVolume)
+			return static_cast<const TriggerVolume&>(_a).triggerVolumeType == static_cast<const TriggerVolume&>(_b).triggerVolumeType;
+
+		return true;
+	}
+}
+
+
+
+uint64_t ObjectDiff::Compare(const Object& _before, const Object& _after)
+{
+	const bool sameType = IsSameType(_before, _after);
+
+	return VisitObject(_after, [&](const auto& _afterObject) {
+		using T = std::remove_cvref_t<decltype(_afterObject)>;
+		if (!sameType)
+			return AllFieldsMask<T>;
+
+		const T& beforeObject = static_cast<const T&>(_before);
+
+		// Each field is compared through its encoding, so every field type compares the same way the diff stores it
+		thread_local std::vector<uint8_t> beforeBytes;
+		thread_local std::vector<uint8_t> afterBytes;
+
+		uint64_t mask = 0;
+		ForEachField<T>([&](const auto& _field, size_t _index) {
+			beforeBytes.clear();
+			afterBytes.clear();
+			FieldWriter(beforeBytes).Write(_field.Get(beforeObject));
+			FieldWriter(afterBytes).Write(_field.Get(_afterObject));
+			if (beforeBytes != afterBytes)
+				mask |= uint64_t(1) << _index;
+			});
+		return mask;
+		}, uint64_t(0));
+}
+
+uint64_t ObjectDiff::GetFieldsMask(const Object& _object)
+{
+	return VisitObject(_object, [](const auto& _concreteObject) {
+		using T = std::remove_cvref_t<decltype(_concreteObject)>;
+		return AllFieldsMask<T>;
+		}, uint64_t(0));
+}
+
+uint64_t ObjectDiff::GetTransformMask(const Object& _object)
+{
+	return VisitObject(_object, [](const auto& _concreteObject) {
+		using T = std::remove_cvref_t<decltype(_concreteObject)>;
+		constexpr uint64_t transformMask = GetFieldMask<T>({ "location", "rotation", "scale" });
+		return transformMask;
+		}, uint64_t(0));
+}
+
+void ObjectDiff::Encode(const Object& _object, uint64_t _fieldMask, std::vector<uint8_t>& _out)
+{
+	VisitObject(_object, [&](const auto& _concreteObject) {
+		FieldWriter(_out).WriteFields(_concreteObject, _fieldMask);
+		return true;
+		}, false);
+}
+
+bool ObjectDiff::Apply(Object& _object, uint64_t _fieldMask, uint16_t _fieldsVersion, const uint8_t* _data, size_t _size, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions,
+	const std::vector<std::shared_ptr<const RingPrefab>>* _prefabs)
+{
+	return VisitObject(_object, [&](auto& _concreteObject) {
+		FieldReader::PrefabLookup findPrefab = nullptr;
+		if (_prefabs)
+		{
+			findPrefab = [_prefabs](const std::string& _id) {
+				auto it = std::find_if(_prefabs->begin(), _prefabs->end(), [&](const std::shared_ptr<const RingPrefab>& _prefab) { return _prefab->id == _id; });
+				return it != _prefabs->end() ? *it : PrefabLibrary::Get().Find(_id);
+				};
+		}
+
+		// Mask bits index the fields that existed in _fieldsVersion
+		FieldReader reader(_data, _size, _fieldsVersion, _triggerFunctions, std::move(findPrefab));
+		bool success = reader.ReadFields(_concreteObject, _fieldMask);
+
+		// Parts written by older versions were placed in the world. Parts that match the template are shared again
+		if constexpr (std::is_same_v<std::remove_cvref_t<decltype(_concreteObject)>, Ring>)
+		{
+			_concreteObject.ClearPartTransforms();
+			PrefabLibrary::ShareUnchangedParts(_concreteObject);
+		}
+		return success && reader.IsAtEnd();
+		}, false);
+}
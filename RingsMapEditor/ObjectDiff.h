@@ -0,0 +1,24 @@
+#pragma once
+#include "ObjectFields.h"
+
+//Field-level binary diffs between two states of the same object, driven by ObjectFields<T>.
+//A diff is a mask of changed fields followed by the new value of each of them in field order, encoded by FieldWriter with inline strings.
+class ObjectDiff
+{
+public:
+	// Returns the fields of _after that differ from _before, every field when the two aren't the same type
+	static uint64_t Compare(const Object& _before, const Object& _after);
+
+	// Every field of the object's type
+	static uint64_t GetFieldsMask(const Object& _object);
+
+	// Fields that only move the object, an edit limited to them is journaled as a transform
+	static uint64_t GetTransformMask(const Object& _object);
+
+	static void Encode(const Object& _object, uint64_t _fieldMask, std::vector<uint8_t>& _out);
+
+	// _fieldsVersion is the ObjectFieldsVersion the diff was encoded with, fields added since are not in its mask.
+	// Prefab ids are looked up in _prefabs first, then in the PrefabLibrary
+	static bool Apply(Object& _object, uint64_t _fieldMask, uint16_t _fieldsVersion, const uint8_t* _data, size_t _size, std::map<std::string, std::shared_ptr<TriggerFunction>>& _triggerFunctions,
+		const std::vector<std::shared_ptr<const RingPrefab>>* _prefabs = nullptr);
+};
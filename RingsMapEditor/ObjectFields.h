@@ -0,0 +1,269 @@
+#pragma once
+#include "Ring.h"
+#include "Checkpoint.h"
+
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+//Current version of the reflected field sets, bumped whenever a field is added to one of them
+constexpr uint16_t ObjectFieldsVersion = 2;
+
+template <typename Class, typename Member>
+struct FieldInfo
+{
+	using ClassType = Class;
+	using MemberType = Member;
+
+	std::string_view name;      // JSON key
+	Member Class::* member;
+	uint16_t sinceVersion;      // first ObjectFieldsVersion holding the field
+	bool optional;              // JSON maps may leave it out, readers keep the default. Fields added after version 1 always are
+
+	template <typename Derived>
+	constexpr const Member& Get(const Derived& _object) const { return static_cast<const Class&>(_object).*member; }
+
+	template <typename Derived>
+	constexpr Member& Get(Derived& _object) const { return static_cast<Class&>(_object).*member; }
+};
+
+template <typename Class, typename Member>
+constexpr FieldInfo<Class, Member> MakeField(std::string_view _name, Member Class::* _member, uint16_t _sinceVersion = 1)
+{
+	return FieldInfo<Class, Member>{ _name, _member, _sinceVersion, _sinceVersion > 1 };
+}
+
+template <typename Class, typename Member>
+constexpr FieldInfo<Class, Member> MakeOptionalField(std::string_view _name, Member Class::* _member)
+{
+	return FieldInfo<Class, Member>{ _name, _member, 1, true };
+}
+
+//Ring field stored in its RingParts : read from the shared template, written through the ring's own copy (see Ring::EditParts)
+template <typename Member>
+struct RingPartField
+{
+	using ClassType = Ring;
+	using MemberType = Member;
+
+	std::string_view name;
+	Member RingParts::* member;
+	uint16_t sinceVersion;
+	bool optional;
+
+	const Member& Get(const Ring& _ring) const { return _ring.GetParts().*member; }
+	Member& Get(Ring& _ring) const { return _ring.EditParts().*member; }
+};
+
+template <typename Member>
+constexpr RingPartField<Member> MakePartField(std::string_view _name, Member RingParts::* _member)
+{
+	return RingPartField<Member>{ _name, _member, 1, false };
+}
+
+template <typename Member>
+constexpr RingPartField<Member> MakeOptionalPartField(std::string_view _name, Member RingParts::* _member)
+{
+	return RingPartField<Member>{ _name, _member, 1, true };
+}
+
+//One field list per serialised type, shared by the JSON writer and reader, the .rme records and the diff encoder (see FieldCodec.h).
+//Fields are listed by name in alphabetical order (checked below), the JSON keys come out in the order nlohmann's dump() uses.
+template <typename T>
+struct ObjectFields;
+
+template <typename T>
+concept ReflectedType = requires { ObjectFields<T>::fields; };
+
+template <>
+struct ObjectFields<MeshInfos>
+{
+	static constexpr auto fields = std::make_tuple(
+		MakeField("meshPath", &MeshInfos::meshPath),
+		MakeField("name", &MeshInfos::name)
+	);
+};
+
+template <>
+struct ObjectFields<Mesh>
+{
+	static constexpr auto fields = std::make_tuple(
+		MakeField("enableCollisions", &Mesh::enableCollisions),
+		MakeField("enablePhysics", &Mesh::enablePhysics),
+		MakeField("enableStickyWalls", &Mesh::enableStickyWalls),
+		MakeField("location", &Object::location),
+		MakeField("meshInfos", &Mesh::meshInfos),
+		MakeField("name", &Object::name),
+		MakeField("objectType", &Object::objectType),
+		MakeField("rotation", &Object::rotation),
+		MakeField("scale", &Object::scale)
+	);
+};
+
+template <>
+struct ObjectFields<TriggerVolume_Box>
+{
+	static constexpr auto fields = std::make_tuple(
+		MakeField("location", &Object::location),
+		MakeField("name", &Object::name),
+		MakeField("objectType", &Object::objectType),
+		MakeOptionalField("onTouchCallback", &TriggerVolume::onTouchCallback),
+		MakeField("rotation", &Object::rotation),
+		MakeField("scale", &Object::scale),
+		MakeField("size", &TriggerVolume_Box::size),
+		MakeField("triggerVolumeType", &TriggerVolume::triggerVolumeType)
+	);
+};
+
+template <>
+struct ObjectFields<TriggerVolume_Cylinder>
+{
+	static constexpr auto fields = std::make_tuple(
+		MakeField("height", &TriggerVolume_Cylinder::height),
+		MakeField("location", &Object::location),
+		MakeField("name", &Object::name),
+		MakeField("objectType", &Object::objectType),
+		MakeOptionalField("onTouchCallback", &TriggerVolume::onTouchCallback),
+		MakeField("radius", &TriggerVolume_Cylinder::radius),
+		MakeField("rotation", &Object::rotation),
+		MakeField("scale", &Object::scale),
+		MakeField("triggerVolumeType", &TriggerVolume::triggerVolumeType)
+	);
+};
+
+template <>
+struct ObjectFields<Checkpoint>
+{
+	static constexpr auto fields = std::make_tuple(
+		MakeField("checkpointId", &Checkpoint::checkpointId),
+		MakeField("checkpointType", &Checkpoint::checkpointType),
+		MakeField("location", &Object::location),
+		MakeField("name", &Object::name),
+		MakeField("objectType", &Object::objectType),
+		MakeField("rotation", &Object::rotation),
+		MakeField("scale", &Object::scale),
+		MakeField("spawnLocation_offset", &Checkpoint::spawnLocation_offset),
+		MakeField("spawnRotation", &Checkpoint::spawnRotation),
+		MakeField("triggerVolume", &Checkpoint::triggerVolume)
+	);
+};
+
+template <>
+struct ObjectFields<Ring>
+{
+	static constexpr auto fields = std::make_tuple(
+		MakeField("location", &Object::location),
+		MakePartField("mesh", &RingParts::mesh),
+		MakeField("name", &Object::name),
+		MakeField("objectType", &Object::objectType),
+		MakeField("prefab", &Ring::prefab, 2),
+		MakeField("ringId", &Ring::ringId),
+		MakeField("rotation", &Object::rotation),
+		MakeField("scale", &Object::scale),
+		MakePartField("triggerVolumeIn", &RingParts::triggerVolumeIn),
+		MakeOptionalPartField("triggerVolumeIn_offset_location", &RingParts::triggerVolumeIn_offset_location),
+		MakeOptionalPartField("triggerVolumeIn_offset_rotation", &RingParts::triggerVolumeIn_offset_rotation),
+		MakePartField("triggerVolumeOut", &RingParts::triggerVolumeOut),
+		MakeOptionalPartField("triggerVolumeOut_offset_location", &RingParts::triggerVolumeOut_offset_location),
+		MakeOptionalPartField("triggerVolumeOut_offset_rotation", &RingParts::triggerVolumeOut_offset_rotation)
+	);
+};
+
+template <ReflectedType T>
+constexpr size_t FieldCount = std::tuple_size_v<std::remove_cvref_t<decltype(ObjectFields<T>::fields)>>;
+
+//Calls _function(field, index) for every field of T, unrolled at compile time
+template <ReflectedType T, typename Function>
+constexpr void ForEachField(Function&& _function)
+{
+	[&]<size_t... Indices>(std::index_sequence<Indices...>) {
+		(_function(std::get<Indices>(ObjectFields<T>::fields), Indices), ...);
+	}(std::make_index_sequence<FieldCount<T>>{});
+}
+
+template <ReflectedType T>
+constexpr bool AreFieldsSorted()
+{
+	return std::apply([](const auto&... _fields) {
+		std::string_view names[] = { _fields.name... };
+		for (size_t i = 1; i < sizeof...(_fields); i++)
+		{
+			if (!(names[i - 1] < names[i]))
+				return false;
+		}
+		return true;
+		}, ObjectFields<T>::fields);
+}
+
+//Bit i is set for the i-th field of T named in _names
+template <ReflectedType T>
+constexpr uint64_t GetFieldMask(std::initializer_list<std::string_view> _names)
+{
+	uint64_t mask = 0;
+	ForEachField<T>([&](const auto& _field, size_t _index) {
+		for (std::string_view name : _names)
+		{
+			if (_field.name == name)
+				mask |= uint64_t(1) << _index;
+		}
+		});
+	return mask;
+}
+
+template <typename From, typename To>
+using CopyConst = std::conditional_t<std::is_const_v<From>, const To, To>;
+
+//Calls _function with _object cast to its concrete reflected type, returns _fallback for unknown types
+template <typename ObjectRef, typename Function, typename Result>
+Result VisitObject(ObjectRef& _object, Function&& _function, Result _fallback)
+{
+	switch (_object.objectType)
+	{
+	case ObjectType::Mesh:
+		return _function(static_cast<CopyConst<ObjectRef, Mesh>&>(_object));
+	case ObjectType::TriggerVolume:
+	{
+		TriggerVolumeType triggerVolumeType = static_cast<const TriggerVolume&>(_object).triggerVolumeType;
+		if (triggerVolumeType == TriggerVolumeType::Box)
+			return _function(static_cast<CopyConst<ObjectRef, TriggerVolume_Box>&>(_object));
+		if (triggerVolumeType == TriggerVolumeType::Cylinder)
+			return _function(static_cast<CopyConst<ObjectRef, TriggerVolume_Cylinder>&>(_object));
+		return _fallback;
+	}
+	case ObjectType::Checkpoint:
+		return _function(static_cast<CopyConst<ObjectRef, Checkpoint>&>(_object));
+	case ObjectType::Ring:
+		return _function(static_cast<CopyConst<ObjectRef, Ring>&>(_object));
+	default:
+		return _fallback;
+	}
+}
+
+//Default-constructed object of the reflected type stored as _objectType / _triggerVolumeType, nullptr for unknown types
+inline std::shared_ptr<Object> CreateObject(ObjectType _objectType, TriggerVolumeType _triggerVolumeType = TriggerVolumeType::Unknown)
+{
+	switch (_objectType)
+	{
+	case ObjectType::Mesh:
+		return MakePooled<Mesh>();
+	case ObjectType::TriggerVolume:
+		if (_triggerVolumeType == TriggerVolumeType::Box)
+			return MakePooled<TriggerVolume_Box>();
+		if (_triggerVolumeType == TriggerVolumeType::Cylinder)
+			return MakePooled<TriggerVolume_Cylinder>();
+		return nullptr;
+	case ObjectType::Checkpoint:
+		return MakePooled<Checkpoint>();
+	case ObjectType::Ring:
+		return MakePooled<Ring>();
+	default:
+		return nullptr;
+	}
+}
+
+template <ReflectedType T>
+constexpr uint64_t AllFieldsMask = (FieldCount<T> == 64) ? ~uint64_t(0) : ((uint64_t(1) << FieldCount<T>) - 1);
+
+static_assert(AreFieldsSorted<MeshInfos>() && AreFieldsSorted<Mesh>() && AreFieldsSorted<TriggerVolume_Box>() && AreFieldsSorted<TriggerVolume_Cylinder>()
+	&& AreFieldsSorted<Checkpoint>() && AreFieldsSorted<Ring>(), "Reflected fields must be listed in alphabetical order");
+static_assert(FieldCount<Ring> <= 64, "Field masks are 64 bits");
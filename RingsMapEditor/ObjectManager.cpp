@@ -1,13 +1,56 @@
 #include "pch.h"
 #include "ObjectManager.h"
+#include "EditJournal.h"
+#include "AsyncMapSaver.h"
+#include "ObjectDiff.h"
+
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+	UndoCommand MakeCommand(UndoOp _op, size_t _objectIndex)
+	{
+		UndoCommand command;
+		command.op = _op;
+		command.objectIndex = static_cast<uint32_t>(_objectIndex);
+		command.time = std::chrono::steady_clock::now();
+		return command;
+	}
+
+	//Inserts at the end then swaps into _index, the reverse of SlotMap::Remove
+	template <typename T>
+	SlotHandle InsertAt(SlotMap<T>& _slotMap, T _value, size_t _index)
+	{
+		SlotHandle handle = _slotMap.Insert(std::move(_value));
+		if (_index < _slotMap.Size() - 1)
+			_slotMap.Swap(_index, _slotMap.Size() - 1);
+		return handle;
+	}
+
+	void DestroyInstance(Object& _object)
+	{
+		if (_object.objectType == ObjectType::Mesh)
+			static_cast<Mesh&>(_object).DestroyInstance();
+		else if (_object.objectType == ObjectType::Ring)
+			static_cast<Ring&>(_object).DestroyMesh();
+	}
+}
+
 
 
 ObjectManager::ObjectManager()
 {
+	m_snapshot.store(std::make_shared<SceneSnapshot>());
+
+	findCheckpoint = [this](int _checkpointId) {
+		return FindCheckpoint(_checkpointId);
+		};
 }
 
 ObjectManager::~ObjectManager()
 {
+	findCheckpoint = nullptr;
 }
 
 
@@ -16,31 +59,27 @@ void ObjectManager::AddObject(ObjectType _objectType)
 {
 	if (_objectType == ObjectType::Mesh)
 	{
-		std::shared_ptr<Mesh> newMesh = std::make_shared<Mesh>();
+		std::shared_ptr<Mesh> newMesh = MakePooled<Mesh>();
 		AddObject(newMesh);
-		AddMesh(newMesh);
 		//SelectLastObject();
 	}
 	else if (_objectType == ObjectType::TriggerVolume)
 	{
-		std::shared_ptr<TriggerVolume_Box> newTriggerVolume = std::make_shared<TriggerVolume_Box>();
+		std::shared_ptr<TriggerVolume_Box> newTriggerVolume = MakePooled<TriggerVolume_Box>();
 		AddObject(newTriggerVolume);
-		AddTriggerVolume(newTriggerVolume);
 		//SelectLastObject();
 	}
 	else if (_objectType == ObjectType::Checkpoint)
 	{
-		std::shared_ptr<Checkpoint> newCheckpoint = std::make_shared<Checkpoint>();
-		newCheckpoint->checkpointId = checkpoints.size() + 1; // Assign a new ID based on the current size
+		std::shared_ptr<Checkpoint> newCheckpoint = MakePooled<Checkpoint>();
+		newCheckpoint->checkpointId = AllocateCheckpointId();
 		AddObject(newCheckpoint);
-		AddCheckpoint(newCheckpoint);
 		//SelectLastObject();
 	}
 	else if (_objectType == ObjectType::Ring)
 	{
-		std::shared_ptr<Ring_Small> newRing = std::make_shared<Ring_Small>(m_rings.size() + 1);
+		std::shared_ptr<Ring> newRing = PrefabLibrary::Get().Instantiate(RingSmallPrefab, AllocateRingId());
 		AddObject(newRing);
-		AddRing(newRing);
 		//SelectLastObject();
 	}
 	else
@@ -49,104 +88,447 @@ void ObjectManager::AddObject(ObjectType _objectType)
 	}
 }
 
-void ObjectManager::AddObject(const std::shared_ptr<Object>& _object)
+ObjectHandle ObjectManager::AddObject(const std::shared_ptr<Object>& _object)
+{
+	ObjectHandle handle = InsertObject(_object);
+	const size_t objectIndex = m_objects.Size() - 1;
+
+	if (m_journal)
+		m_journal->RecordAdd(static_cast<uint32_t>(objectIndex), _object);
+
+	m_undoStack.Push(MakeCommand(UndoOp::Add, objectIndex));
+	return handle;
+}
+
+ObjectHandle ObjectManager::InsertObject(const std::shared_ptr<Object>& _object, size_t _objectIndex, size_t _typedIndex)
 {
-	m_objects.emplace_back(_object);
+	const size_t objectIndex = std::min(_objectIndex, m_objects.Size());
+
+	ObjectSlots slots;
+	slots.object = m_objects.InsertAt(_object, objectIndex);
+	m_transforms.Insert(objectIndex, *_object);
 
 	if (_object->objectType == ObjectType::Mesh)
-		AddMesh(std::static_pointer_cast<Mesh>(_object));
+		slots.typed = InsertAt(m_meshes, std::static_pointer_cast<Mesh>(_object), _typedIndex);
 	else if (_object->objectType == ObjectType::TriggerVolume)
-		AddTriggerVolume(std::static_pointer_cast<TriggerVolume>(_object));
+		slots.typed = InsertAt(m_triggerVolumes, std::static_pointer_cast<TriggerVolume>(_object), _typedIndex);
 	else if (_object->objectType == ObjectType::Checkpoint)
-		AddCheckpoint(std::static_pointer_cast<Checkpoint>(_object));
+		slots.typed = InsertAt(m_checkpoints, std::static_pointer_cast<Checkpoint>(_object), _typedIndex);
 	else if (_object->objectType == ObjectType::Ring)
-		AddRing(std::static_pointer_cast<Ring>(_object));
-}
+		slots.typed = InsertAt(m_rings, std::static_pointer_cast<Ring>(_object), _typedIndex);
 
-void ObjectManager::AddMesh(const std::shared_ptr<Mesh>& _mesh)
-{
-	m_meshes.emplace_back(_mesh);
+	m_handles[_object.get()] = slots;
+	m_nameIndex.Add(*_object, slots.object);
+	IndexId(*_object, slots.object);
+	MarkSnapshotShift(objectIndex);
+	return slots.object;
 }
 
-void ObjectManager::AddTriggerVolume(const std::shared_ptr<TriggerVolume>& _triggerVolume)
+uint32_t ObjectManager::EraseObject(size_t _objectIndex)
 {
-	m_triggerVolumes.emplace_back(_triggerVolume);
-}
+	std::shared_ptr<Object> object = m_objects.GetValues()[_objectIndex];
+	auto slots = m_handles.find(object.get());
 
-void ObjectManager::AddCheckpoint(const std::shared_ptr<Checkpoint>& _checkpoint)
-{
-	checkpoints.emplace_back(_checkpoint);
+	int typedIndex = 0;
+	if (object->objectType == ObjectType::Mesh)
+	{
+		typedIndex = m_meshes.GetIndex(slots->second.typed);
+		m_meshes.Remove(slots->second.typed);
+	}
+	else if (object->objectType == ObjectType::TriggerVolume)
+	{
+		typedIndex = m_triggerVolumes.GetIndex(slots->second.typed);
+		m_triggerVolumes.Remove(slots->second.typed);
+	}
+	else if (object->objectType == ObjectType::Checkpoint)
+	{
+		m_checkpointIds.Remove(slots->second.object);
+		typedIndex = m_checkpoints.GetIndex(slots->second.typed);
+		m_checkpoints.Remove(slots->second.typed);
+	}
+	else if (object->objectType == ObjectType::Ring)
+	{
+		m_ringIds.Remove(slots->second.object);
+		typedIndex = m_rings.GetIndex(slots->second.typed);
+		m_rings.Remove(slots->second.typed);
+	}
+
+	m_handles.erase(slots);
+	m_nameIndex.Remove(object.get());
+	m_sceneGraph.OnRemoved(m_objects.GetHandle(_objectIndex));
+	m_objects.Erase(m_objects.GetHandle(_objectIndex));
+	m_transforms.Erase(_objectIndex);
+	MarkSnapshotShift(_objectIndex);
+
+	return static_cast<uint32_t>(typedIndex);
 }
 
-void ObjectManager::AddRing(const std::shared_ptr<Ring>& _ring)
+//The new object takes over the slots of the old one, handles to it stay valid
+void ObjectManager::ReplaceTriggerVolume(size_t _objectIndex, const std::shared_ptr<TriggerVolume>& _triggerVolume)
 {
-	m_rings.emplace_back(_ring);
+	std::shared_ptr<Object>& object = m_objects.GetValues()[_objectIndex];
+
+	auto slots = m_handles.find(object.get());
+	ObjectSlots objectSlots = slots->second;
+	objectSlots.published = nullptr;
+	m_handles.erase(slots);
+	m_handles[_triggerVolume.get()] = objectSlots;
+	m_nameIndex.Replace(object.get(), *_triggerVolume);
+
+	object = _triggerVolume; // point to new object
+	m_transforms.Update(_objectIndex, *_triggerVolume);
+	MarkSnapshotIndex(_objectIndex);
+
+	if (std::shared_ptr<TriggerVolume>* triggerVolume = m_triggerVolumes.Get(objectSlots.typed))
+		*triggerVolume = _triggerVolume;
 }
 
 std::shared_ptr<Object> ObjectManager::CopyObject(Object& _object)
 {
+	int sourceIndex = FindObjectIndex(&_object);
+
 	std::shared_ptr<Object> clonedObject = _object.Clone();
 	clonedObject->name += " (Copy)";
-	m_objects.emplace_back(clonedObject);
 
-	if (clonedObject->objectType == ObjectType::Mesh)
+	// The copy gets an id of its own rather than a duplicate
+	uint64_t idField = 0;
+	if (clonedObject->objectType == ObjectType::Checkpoint)
 	{
-		m_meshes.emplace_back(std::static_pointer_cast<Mesh>(clonedObject));
+		static_cast<Checkpoint&>(*clonedObject).checkpointId = AllocateCheckpointId();
+		idField = GetFieldMask<Checkpoint>({ "checkpointId" });
 	}
-	else if (clonedObject->objectType == ObjectType::TriggerVolume)
+	else if (clonedObject->objectType == ObjectType::Ring)
 	{
-		m_triggerVolumes.emplace_back(std::static_pointer_cast<TriggerVolume>(clonedObject));
+		static_cast<Ring&>(*clonedObject).ringId = AllocateRingId();
+		idField = GetFieldMask<Ring>({ "ringId" });
 	}
-	else if (clonedObject->objectType == ObjectType::Checkpoint)
+
+	InsertObject(clonedObject);
+
+	if (m_journal)
 	{
-		checkpoints.emplace_back(std::static_pointer_cast<Checkpoint>(clonedObject));
+		// Replaying a copy only needs the source and the new id, unless the source isn't part of the scene
+		if (sourceIndex >= 0)
+		{
+			m_journal->RecordCopy(static_cast<uint32_t>(sourceIndex));
+			if (idField != 0)
+				m_journal->RecordProperty(static_cast<uint32_t>(m_objects.Size() - 1), *clonedObject, idField);
+		}
+		else
+		{
+			m_journal->RecordAdd(static_cast<uint32_t>(m_objects.Size() - 1), clonedObject);
+		}
 	}
-	else if (clonedObject->objectType == ObjectType::Ring)
+
+	m_undoStack.Push(MakeCommand(UndoOp::Add, m_objects.Size() - 1));
+	return clonedObject;
+}
+
+void ObjectManager::RemoveObject(ObjectHandle _handle)
+{
+	int objectIndex = m_objects.GetIndex(_handle);
+	if (objectIndex < 0)
 	{
-		m_rings.emplace_back(std::static_pointer_cast<Ring>(clonedObject));
+		LOG("[ERROR]Tried to remove an object that isn't in the scene anymore");
+		return;
 	}
 
-	return clonedObject;
+	// The undo history keeps the object alive, its actor goes away now instead of when the object is released
+	UndoCommand command = MakeCommand(UndoOp::Remove, objectIndex);
+	command.detached = *m_objects.Get(_handle);
+	SaveLinks(objectIndex, command);
+	command.typedIndex = EraseObject(objectIndex);
+	DestroyInstance(*command.detached);
+	LOG("Removed object: {}", command.detached->name);
+
+	if (m_journal)
+		m_journal->RecordRemove(static_cast<uint32_t>(objectIndex));
+
+	m_undoStack.Push(std::move(command));
+}
+
+void ObjectManager::ClearObjects()
+{
+	m_objects.Clear();
+	m_meshes.Clear();
+	m_triggerVolumes.Clear();
+	m_checkpoints.Clear();
+	m_rings.Clear();
+	m_handles.clear();
+	m_transforms.Clear();
+	m_nameIndex.Clear();
+	m_sceneGraph.Clear();
+	m_checkpointIds.Clear();
+	m_ringIds.Clear();
+
+	{
+		std::lock_guard<std::mutex> lock(m_snapshotMutex);
+		m_snapshotIndices.clear();
+		m_snapshotObjects.clear();
+		m_snapshotShiftedFrom = SIZE_MAX;
+		m_snapshotReset = true;
+	}
+
+	// Indices in the history refer to the objects that were just cleared
+	m_undoStack.Clear();
+	m_undoGeneration++;
+}
+
+void ObjectManager::LoadObjects(const std::vector<std::shared_ptr<Object>>& _objects, const MapExtras& _extras)
+{
+	ClearObjects();
+
+	m_objects.Reserve(_objects.size());
+	m_handles.reserve(_objects.size());
+	m_transforms.Reserve(_objects.size());
+	m_nameIndex.Reserve(_objects.size());
+	for (const std::shared_ptr<Object>& object : _objects)
+		InsertObject(object);
+	RegisterPrefabs(_extras.prefabs);
+	ApplyParents(_extras.parents);
+
+	// A loaded map is one snapshot, not one journal record per object
+	RebaseJournal();
 }
 
-void ObjectManager::RemoveObject(const int& _objectIndex)
+namespace
 {
-	std::shared_ptr<Object> selectedObject = m_objects[_objectIndex];
+	std::vector<uint8_t> EncodeContent(const Object& _object)
+	{
+		std::vector<uint8_t> content;
+		ObjectDiff::Encode(_object, ObjectDiff::GetFieldsMask(_object), content);
+		return content;
+	}
+
+	size_t HashContent(const std::vector<uint8_t>& _content)
+	{
+		return std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(_content.data()), _content.size()));
+	}
+
+	//Key an object keeps across edits of a map : ring and checkpoint ids, the name for anything else
+	std::string GetIdentity(const Object& _object)
+	{
+		std::string identity = std::to_string(static_cast<int>(_object.objectType)) + ':';
+		if (_object.objectType == ObjectType::TriggerVolume)
+			identity += std::to_string(static_cast<int>(static_cast<const TriggerVolume&>(_object).triggerVolumeType)) + ':';
+
+		if (_object.objectType == ObjectType::Ring)
+			identity += std::to_string(static_cast<const Ring&>(_object).ringId);
+		else if (_object.objectType == ObjectType::Checkpoint)
+			identity += std::to_string(static_cast<const Checkpoint&>(_object).checkpointId);
+		else
+			identity += _object.name;
+
+		return identity;
+	}
 
-	if (selectedObject->objectType == ObjectType::Mesh)
+	void SpawnInstance(Object& _object)
 	{
-		std::shared_ptr<Mesh> mesh = std::static_pointer_cast<Mesh>(selectedObject);
-		m_meshes.erase(std::remove(m_meshes.begin(), m_meshes.end(), mesh), m_meshes.end());
-		LOG("Removed mesh: {}", mesh->name);
+		if (_object.objectType == ObjectType::Mesh)
+		{
+			Mesh& mesh = static_cast<Mesh&>(_object);
+			if (mesh.IsInGame())
+				mesh.SpawnInstance();
+		}
+		else if (_object.objectType == ObjectType::Ring)
+		{
+			Ring& ring = static_cast<Ring&>(_object);
+			if (ring.GetParts().mesh.IsInGame())
+				ring.SpawnMesh();
+		}
 	}
-	else if (selectedObject->objectType == ObjectType::TriggerVolume)
+
+	//Brings a spawned actor in line with fields that were just replaced : moved when only its location or rotation changed,
+	//respawned otherwise (scale isn't applied to the collision component of a live actor)
+	void RefreshMeshInstance(Mesh& _mesh, uint64_t _changedFields)
 	{
-		std::shared_ptr<TriggerVolume> triggerVolume = std::static_pointer_cast<TriggerVolume>(selectedObject);
-		m_triggerVolumes.erase(std::remove(m_triggerVolumes.begin(), m_triggerVolumes.end(), triggerVolume), m_triggerVolumes.end());
-		LOG("Removed trigger volume: {}", triggerVolume->name);
+		if (!_mesh.IsSpawned() || _changedFields == 0)
+			return;
+
+		constexpr uint64_t moveFields = GetFieldMask<Mesh>({ "location", "rotation" });
+		if ((_changedFields & ~moveFields) == 0)
+		{
+			_mesh.SetLocation(_mesh.location);
+			_mesh.SetRotation(_mesh.rotation);
+			return;
+		}
+
+		_mesh.DestroyInstance();
+		_mesh.SpawnInstance();
 	}
-	else if (selectedObject->objectType == ObjectType::Checkpoint)
+
+	//A ring's actor is a copy of its parts' mesh, it's respawned from them when they changed. Moves go through UpdateChildren()
+	void RefreshRingMesh(Ring& _ring, bool _meshChanged)
 	{
-		std::shared_ptr<Checkpoint> chekpoint = std::static_pointer_cast<Checkpoint>(selectedObject);
-		checkpoints.erase(std::remove(checkpoints.begin(), checkpoints.end(), chekpoint), checkpoints.end());
-		LOG("Removed checkpoint: {}", chekpoint->name);
+		if (!_ring.IsMeshSpawned() || !_meshChanged)
+			return;
+
+		_ring.DestroyMesh();
+		_ring.SpawnMesh();
 	}
-	else if (selectedObject->objectType == ObjectType::Ring)
+
+	//Brings what the object drives (its actor, the trigger volumes of rings and checkpoints) in line with fields that were just replaced
+	void RefreshObject(Object& _object, uint64_t _changedFields)
 	{
-		std::shared_ptr<Ring> ring = std::static_pointer_cast<Ring>(selectedObject);
-		m_rings.erase(std::remove(m_rings.begin(), m_rings.end(), ring), m_rings.end());
-		LOG("Removed ring: {}", ring->name);
+		_object.SetLocation(_object.location);
+		_object.SetRotation(_object.rotation);
+		_object.UpdateChildren();
+
+		if (_object.objectType == ObjectType::Mesh)
+		{
+			RefreshMeshInstance(static_cast<Mesh&>(_object), _changedFields);
+		}
+		else if (_object.objectType == ObjectType::Ring)
+		{
+			// The ring was moved along with its mesh above, any other field may be one of the mesh's
+			RefreshRingMesh(static_cast<Ring&>(_object), (_changedFields & ~ObjectDiff::GetTransformMask(_object)) != 0);
+		}
 	}
 
-	m_objects.erase(m_objects.begin() + _objectIndex);
+	//Moves an object and what it drives to a transform given to its whole group. A rotation that didn't change isn't sent to the actor again,
+	//a scaled mesh is respawned (see RefreshMeshInstance)
+	void ApplyObjectTransform(Object& _object, const ObjectTransform& _transform)
+	{
+		const bool rotated = _object.rotation.Pitch != _transform.rotation.Pitch || _object.rotation.Yaw != _transform.rotation.Yaw
+			|| _object.rotation.Roll != _transform.rotation.Roll;
+		const bool scaled = _object.scale != _transform.scale;
+
+		if (_object.objectType == ObjectType::Mesh && !static_cast<Mesh&>(_object).IsSpawned())
+		{
+			_object.location = _transform.location;
+			_object.rotation = _transform.rotation;
+		}
+		else
+		{
+			_object.SetLocation(_transform.location);
+			if (rotated)
+				_object.SetRotation(_transform.rotation);
+		}
+
+		_object.UpdateChildren();
+		_object.scale = _transform.scale;
+
+		if (scaled && _object.objectType == ObjectType::Mesh)
+			RefreshMeshInstance(static_cast<Mesh&>(_object), ObjectDiff::GetTransformMask(_object));
+	}
 }
 
-void ObjectManager::ClearObjects()
+//Replaces the scene with _objects while keeping every current object that has an equivalent in it.
+//Identical objects are matched by content hash and left untouched, the others are matched by identity and get their changed fields applied in place.
+//Only unmatched objects are destroyed or created, so unchanged mesh actors stay spawned. The result is in the order of _objects.
+ReconcileStats ObjectManager::ReconcileObjects(const std::vector<std::shared_ptr<Object>>& _objects, const MapExtras& _extras)
 {
-	m_objects.clear();
-	m_triggerVolumes.clear();
-	checkpoints.clear();
-	m_rings.clear();
+	// Before any diff is applied, a ring taking a prefab from the map finds the map's template
+	RegisterPrefabs(_extras.prefabs);
+
+	ReconcileStats stats;
+	const std::vector<std::shared_ptr<Object>>& currentObjects = m_objects.GetValues();
+	std::vector<bool> matched(currentObjects.size(), false);
+	std::vector<std::shared_ptr<Object>> reconciled(_objects.size());
+
+	std::vector<std::vector<uint8_t>> currentContents(currentObjects.size());
+	std::unordered_multimap<size_t, size_t> currentByContent;
+	currentByContent.reserve(currentObjects.size());
+	for (size_t i = 0; i < currentObjects.size(); i++)
+	{
+		currentContents[i] = EncodeContent(*currentObjects[i]);
+		currentByContent.emplace(HashContent(currentContents[i]), i);
+	}
+
+	std::vector<size_t> unmatchedIncoming;
+	for (size_t i = 0; i < _objects.size(); i++)
+	{
+		std::vector<uint8_t> content = EncodeContent(*_objects[i]);
+		auto range = currentByContent.equal_range(HashContent(content));
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (!matched[it->second] && currentContents[it->second] == content)
+			{
+				matched[it->second] = true;
+				reconciled[i] = currentObjects[it->second];
+				stats.kept++;
+				break;
+			}
+		}
+
+		if (!reconciled[i])
+			unmatchedIncoming.push_back(i);
+	}
+
+	// Objects sharing an identity are paired in scene order
+	std::unordered_map<std::string, std::vector<size_t>> currentByIdentity;
+	for (size_t i = 0; i < currentObjects.size(); i++)
+	{
+		if (!matched[i])
+			currentByIdentity[GetIdentity(*currentObjects[i])].push_back(i);
+	}
+	for (auto& [identity, indices] : currentByIdentity)
+		std::reverse(indices.begin(), indices.end());
+
+	std::vector<uint8_t> diff;
+	for (size_t i : unmatchedIncoming)
+	{
+		const std::shared_ptr<Object>& incoming = _objects[i];
+
+		auto it = currentByIdentity.find(GetIdentity(*incoming));
+		if (it == currentByIdentity.end() || it->second.empty())
+		{
+			reconciled[i] = incoming;
+			SpawnInstance(*incoming);
+			stats.added++;
+			continue;
+		}
+
+		size_t currentIndex = it->second.back();
+		it->second.pop_back();
+		matched[currentIndex] = true;
+
+		std::shared_ptr<Object> current = currentObjects[currentIndex];
+		uint64_t changedFields = ObjectDiff::Compare(*current, *incoming);
+
+		uint64_t changedMeshFields = 0;
+		if (current->objectType == ObjectType::Mesh)
+			changedMeshFields = changedFields;
+		else if (current->objectType == ObjectType::Ring)
+			changedMeshFields = ObjectDiff::Compare(std::static_pointer_cast<Ring>(current)->GetParts().mesh, std::static_pointer_cast<Ring>(incoming)->GetParts().mesh);
+
+		diff.clear();
+		ObjectDiff::Encode(*incoming, changedFields, diff);
+		if (!ObjectDiff::Apply(*current, changedFields, ObjectFieldsVersion, diff.data(), diff.size(), m_triggerFunctionsMap))
+		{
+			LOG("[ERROR]Could not update {} in place, it was replaced", current->name);
+			reconciled[i] = incoming;
+			SpawnInstance(*incoming);
+			stats.added++;
+			stats.removed++;
+			continue;
+		}
+
+		if (current->objectType == ObjectType::Mesh)
+			RefreshMeshInstance(*std::static_pointer_cast<Mesh>(current), changedMeshFields);
+		else if (current->objectType == ObjectType::Ring)
+			RefreshRingMesh(*std::static_pointer_cast<Ring>(current), changedMeshFields != 0);
+
+		reconciled[i] = current;
+		stats.updated++;
+	}
+
+	stats.removed += std::count(matched.begin(), matched.end(), false);
+
+	// Objects left out of reconciled are released here, their destructors destroy their actors
+	ClearObjects();
+	m_objects.Reserve(reconciled.size());
+	m_handles.reserve(reconciled.size());
+	m_transforms.Reserve(reconciled.size());
+	m_nameIndex.Reserve(reconciled.size());
+	for (const std::shared_ptr<Object>& object : reconciled)
+		InsertObject(object);
+
+	// The links are the map's, those of the scene it replaces went away with ClearObjects()
+	ApplyParents(_extras.parents);
+	RebaseJournal();
+
+	return stats;
 }
 
 void ObjectManager::ConvertTriggerVolume(std::shared_ptr<TriggerVolume> _triggerVolume, TriggerVolumeType _triggerVolumeType)
@@ -155,52 +537,826 @@ void ObjectManager::ConvertTriggerVolume(std::shared_ptr<TriggerVolume> _trigger
 
 	if (_triggerVolumeType == TriggerVolumeType::Box)
 	{
-		_triggerVolume = std::make_shared<TriggerVolume_Box>(*_triggerVolume);
+		_triggerVolume = MakePooled<TriggerVolume_Box>(*_triggerVolume);
 	}
 	else if (_triggerVolumeType == TriggerVolumeType::Cylinder)
 	{
-		_triggerVolume = std::make_shared<TriggerVolume_Cylinder>(*_triggerVolume);
+		_triggerVolume = MakePooled<TriggerVolume_Cylinder>(*_triggerVolume);
 	}
 
-	auto objects_it = std::find(m_objects.begin(), m_objects.end(), oldPtr);
-	if (objects_it != m_objects.end())
+	int objectIndex = FindObjectIndex(oldPtr.get());
+	if (objectIndex < 0 || _triggerVolume == oldPtr)
+		return;
+
+	ReplaceTriggerVolume(objectIndex, _triggerVolume);
+
+	if (m_journal)
+		m_journal->RecordConvert(static_cast<uint32_t>(objectIndex), _triggerVolumeType);
+
+	// The old volume is kept as it is, converting back restores the fields the conversion dropped
+	UndoCommand command = MakeCommand(UndoOp::Convert, objectIndex);
+	command.detached = oldPtr;
+	m_undoStack.Push(std::move(command));
+}
+
+size_t ObjectManager::UpdatePrefab(const std::string& _id, const Ring& _ring)
+{
+	std::shared_ptr<const RingPrefab> prefab = PrefabLibrary::Get().Register(_id, _ring);
+	if (prefab->builtIn)
+		return 0;
+
+	if (m_journal)
+		m_journal->RecordPrefab(prefab);
+
+	size_t updatedCount = 0;
+	std::vector<uint8_t> overrides;
+	std::vector<uint8_t> diff;
+	for (const std::shared_ptr<Ring>& ring : m_rings.GetValues())
 	{
-		*objects_it = _triggerVolume; // point to new object
+		if (!ring->prefab || ring->prefab == prefab || ring->prefab->id != _id)
+			continue;
+
+		// Overrides are taken against the template the ring was made from, then laid over the new one
+		uint64_t overrideFields = PrefabLibrary::GetOverrides(*ring);
+		Ring updated = PrefabLibrary::Place(prefab, *ring);
+		overrides.clear();
+		ObjectDiff::Encode(*ring, overrideFields, overrides);
+		ObjectDiff::Apply(updated, overrideFields, ObjectFieldsVersion, overrides.data(), overrides.size(), m_triggerFunctionsMap);
+
+		uint64_t changedFields = ObjectDiff::Compare(*ring, updated);
+		bool meshChanged = ObjectDiff::Compare(ring->GetParts().mesh, updated.GetParts().mesh) != 0;
+		ring->prefab = prefab;
+
+		// A ring that overrides none of the parts reads the new template's, only its other fields are applied below
+		uint64_t appliedFields = changedFields;
+		if (!(overrideFields & PrefabLibrary::GetPartFields()))
+		{
+			ring->ShareParts(prefab->parts);
+			appliedFields &= ~PrefabLibrary::GetPartFields();
+		}
+
+		if (changedFields == 0)
+			continue;
+
+		diff.clear();
+		ObjectDiff::Encode(updated, appliedFields, diff);
+		if (!ObjectDiff::Apply(*ring, appliedFields, ObjectFieldsVersion, diff.data(), diff.size(), m_triggerFunctionsMap))
+		{
+			LOG("[ERROR]Could not update {} from prefab {}", ring->name, _id);
+			continue;
+		}
+
+		// Only the actors whose mesh changed are respawned, the others are at most moved
+		ring->SetLocation(ring->location);
+		ring->SetRotation(ring->rotation);
+		ring->UpdateChildren();
+		RefreshRingMesh(*ring, meshChanged);
+
+		int objectIndex = FindObjectIndex(ring.get());
+		m_transforms.Update(objectIndex, *ring);
+		MarkSnapshotObject(ring.get());
+		JournalEdit(objectIndex, *ring, changedFields);
+		updatedCount++;
 	}
 
-	auto triggerVolumes_it = std::find(m_triggerVolumes.begin(), m_triggerVolumes.end(), oldPtr);
-	if (triggerVolumes_it != m_triggerVolumes.end())
+	return updatedCount;
+}
+
+std::shared_ptr<const RingPrefab> ObjectManager::SavePrefab(const std::string& _id, const std::shared_ptr<Ring>& _ring)
+{
+	// The name can be taken between the GUI's check and this call
+	if (_id.empty() || PrefabLibrary::Get().Find(_id))
 	{
-		*triggerVolumes_it = _triggerVolume; // point to new object
+		LOG("[ERROR]Prefab name already in use: {}", _id);
+		return nullptr;
 	}
+
+	if (!_ring || FindObjectIndex(_ring.get()) < 0)
+		return nullptr;
+
+	ObjectEdit edit = BeginEdit(_ring);
+	std::shared_ptr<const RingPrefab> prefab = PrefabLibrary::Get().Register(_id, *_ring);
+	if (m_journal)
+		m_journal->RecordPrefab(prefab);
+
+	// The ring's parts are the template's now, it shares them
+	_ring->prefab = prefab;
+	_ring->ShareParts(prefab->parts);
+	CommitEdit(edit);
+
+	// The link is committed here, the properties panel's edit of the ring started before it
+	m_undoGeneration++;
+	return prefab;
+}
+
+size_t ObjectManager::TransformObjects(const std::vector<ObjectHandle>& _handles, const GroupTransform& _transform)
+{
+	if (!(_transform.scale > 0.f))
+	{
+		LOG("[ERROR]Objects can't be scaled by {}", _transform.scale);
+		return 0;
+	}
+
+	// Edits still waiting for their rows are copied in first, the rows are where the objects start from
+	UpdateTransforms();
+
+	std::vector<uint32_t> rows;
+	rows.reserve(_handles.size());
+	for (ObjectHandle handle : _handles)
+	{
+		int objectIndex = m_objects.GetIndex(handle);
+		if (objectIndex >= 0)
+			rows.push_back(static_cast<uint32_t>(objectIndex));
+	}
+
+	// Sorted so the pass walks the columns forward, an object listed twice is moved once
+	std::sort(rows.begin(), rows.end());
+	rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+	if (rows.empty())
+		return 0;
+
+	Vector pivot = _transform.pivot;
+	if (_transform.pivotAtCenter)
+	{
+		double sumX = 0.0, sumY = 0.0, sumZ = 0.0;
+		for (uint32_t row : rows)
+		{
+			Vector location = m_transforms.GetLocation(row);
+			sumX += location.X;
+			sumY += location.Y;
+			sumZ += location.Z;
+		}
+		pivot = Vector(static_cast<float>(sumX / rows.size()), static_cast<float>(sumY / rows.size()), static_cast<float>(sumZ / rows.size()));
+	}
+
+	auto getRowTransform = [this](uint32_t _row) {
+		return ObjectTransform{ m_transforms.GetLocation(_row), m_transforms.GetRotation(_row), m_transforms.GetScale(_row) };
+		};
+
+	UndoCommand command = MakeCommand(UndoOp::Transform, rows.front());
+	command.transformsBefore.reserve(rows.size());
+	for (uint32_t row : rows)
+		command.transformsBefore.push_back(getRowTransform(row));
+
+	m_transforms.TransformRows(rows, pivot, _transform.scale, _transform.rotation, _transform.translation);
+
+	const bool scaled = _transform.scale != 1.f;
+	std::vector<ObjectHandle> movedHandles;
+	movedHandles.reserve(rows.size());
+	command.transformsAfter.reserve(rows.size());
+	for (uint32_t row : rows)
+	{
+		ObjectTransform transform = getRowTransform(row);
+		Object& object = *m_objects.GetValues()[row];
+		ApplyObjectTransform(object, transform);
+
+		// Scaling may change the bounding radius, the row is copied back from the object for it
+		if (scaled)
+			m_transforms.Update(row, object);
+
+		movedHandles.push_back(m_objects.GetHandle(row));
+		MarkSnapshotObject(&object);
+		JournalEdit(row, object, ObjectDiff::GetTransformMask(object));
+		command.transformsAfter.push_back(transform);
+	}
+
+	// Marked once every object is in place, a selected child is bound to where its selected parent ended up
+	m_sceneGraph.MarkMoved(movedHandles);
+
+	const size_t movedCount = rows.size();
+	command.objectIndices = std::move(rows);
+	m_undoStack.Push(std::move(command));
+
+	// Children are moved now rather than on the next tick, the whole group is in place when this returns
+	UpdateTransforms();
+	return movedCount;
 }
 
 std::vector<std::shared_ptr<Object>>& ObjectManager::GetObjects()
 {
-	return m_objects;
+	return m_objects.GetValues();
 }
 
 std::vector<std::shared_ptr<Mesh>>& ObjectManager::GetMeshes()
 {
-	return m_meshes;
+	return m_meshes.GetValues();
 }
 
 std::vector<std::shared_ptr<TriggerVolume>>& ObjectManager::GetTriggerVolumes()
 {
-	return m_triggerVolumes;
+	return m_triggerVolumes.GetValues();
 }
 
 std::vector<std::shared_ptr<Checkpoint>>& ObjectManager::GetCheckpoints()
 {
-	return checkpoints;
+	return m_checkpoints.GetValues();
 }
 
 std::vector<std::shared_ptr<Ring>>& ObjectManager::GetRings()
 {
-	return m_rings;
+	return m_rings.GetValues();
 }
 
 std::map<std::string, std::shared_ptr<TriggerFunction>>& ObjectManager::GetTriggerFunctionsMap()
 {
 	return m_triggerFunctionsMap;
 }
+
+void ObjectManager::SetJournal(const std::shared_ptr<EditJournal>& _journal)
+{
+	m_journal = _journal;
+	RebaseJournal();
+}
+
+void ObjectManager::UpdateJournal()
+{
+	if (m_journal)
+		m_journal->Update(GetSnapshot());
+}
+
+void ObjectManager::RebaseJournal()
+{
+	if (!m_journal)
+		return;
+
+	std::vector<int32_t> parents;
+	m_sceneGraph.GetParentIndices(parents);
+	m_journal->Rebase(m_objects.GetValues(), parents);
+}
+
+//Detached copy used as the reference state of an edit, nullptr for types that can't be snapshotted
+static std::shared_ptr<Object> SnapshotObject(const std::shared_ptr<Object>& _object)
+{
+	std::vector<std::shared_ptr<Object>> snapshot = AsyncMapSaver::TakeSnapshot({ _object });
+	return snapshot.empty() ? nullptr : snapshot[0];
+}
+
+ObjectEdit ObjectManager::BeginEdit(const std::shared_ptr<Object>& _object)
+{
+	ObjectEdit edit;
+	edit.object = _object;
+	edit.undoGeneration = m_undoGeneration;
+
+	if (_object)
+		edit.before = SnapshotObject(_object);
+
+	return edit;
+}
+
+void ObjectManager::CommitEdit(ObjectEdit& _edit)
+{
+	if (!_edit.object || !_edit.before)
+		return;
+
+	// An undo or redo since the edit started isn't an edit of its own
+	if (_edit.undoGeneration != m_undoGeneration)
+	{
+		_edit.undoGeneration = m_undoGeneration;
+		_edit.before = SnapshotObject(_edit.object);
+		return;
+	}
+
+	uint64_t fieldMask = ObjectDiff::Compare(*_edit.before, *_edit.object);
+	if (fieldMask == 0)
+		return;
+
+	// The object was removed or converted since the edit started, those are journaled on their own
+	int objectIndex = FindObjectIndex(_edit.object.get());
+	if (objectIndex < 0)
+	{
+		_edit = ObjectEdit();
+		return;
+	}
+
+	JournalEdit(objectIndex, *_edit.object, fieldMask);
+	m_nameIndex.Rename(*_edit.object);
+	IndexId(*_edit.object, m_objects.GetHandle(objectIndex));
+	MarkSnapshotObject(_edit.object.get());
+
+	UndoCommand command = MakeCommand(UndoOp::Edit, objectIndex);
+	command.fieldMask = fieldMask;
+	ObjectDiff::Encode(*_edit.before, fieldMask, command.before);
+	ObjectDiff::Encode(*_edit.object, fieldMask, command.after);
+	m_undoStack.Push(std::move(command));
+
+	_edit.before = SnapshotObject(_edit.object);
+}
+
+void ObjectManager::JournalEdit(size_t _objectIndex, const Object& _object, uint64_t _fieldMask)
+{
+	if (!m_journal)
+		return;
+
+	if ((_fieldMask & ~ObjectDiff::GetTransformMask(_object)) == 0)
+		m_journal->RecordTransform(static_cast<uint32_t>(_objectIndex), _object);
+	else
+		m_journal->RecordProperty(static_cast<uint32_t>(_objectIndex), _object, _fieldMask);
+}
+
+void ObjectManager::IndexId(const Object& _object, ObjectHandle _handle)
+{
+	IdTable* ids = nullptr;
+	int id = -1;
+	if (_object.objectType == ObjectType::Checkpoint)
+	{
+		ids = &m_checkpointIds;
+		id = static_cast<const Checkpoint&>(_object).checkpointId;
+	}
+	else if (_object.objectType == ObjectType::Ring)
+	{
+		ids = &m_ringIds;
+		id = static_cast<const Ring&>(_object).ringId;
+	}
+	else
+	{
+		return;
+	}
+
+	if (id > IdTable::MaxId)
+		LOG("[ERROR]{} has id {}, ids above {} can't be looked up", _object.name, id, IdTable::MaxId);
+
+	if (!ids->Set(_handle, id))
+	{
+		std::shared_ptr<Object> holder = FindObject(ids->Find(id));
+		LOG("[ERROR]{} has id {} which {} already uses", _object.name, id, holder ? holder->name : "another object");
+	}
+}
+
+bool ObjectManager::Undo()
+{
+	UndoCommand command;
+	if (!m_undoStack.PopUndo(command))
+		return false;
+
+	if (!ApplyCommand(command, true))
+	{
+		LOG("[ERROR]Undo doesn't match the scene anymore, the undo history was cleared");
+		m_undoStack.Clear();
+		return false;
+	}
+
+	m_undoStack.PushRedo(std::move(command));
+	m_undoGeneration++;
+	return true;
+}
+
+bool ObjectManager::Redo()
+{
+	UndoCommand command;
+	if (!m_undoStack.PopRedo(command))
+		return false;
+
+	if (!ApplyCommand(command, false))
+	{
+		LOG("[ERROR]Redo doesn't match the scene anymore, the undo history was cleared");
+		m_undoStack.Clear();
+		return false;
+	}
+
+	m_undoStack.PushUndo(std::move(command));
+	m_undoGeneration++;
+	return true;
+}
+
+UndoStack& ObjectManager::GetUndoStack()
+{
+	return m_undoStack;
+}
+
+//Every later command was undone first, so the scene is in the exact state the command left it in (or found it in, for a redo).
+//Applying a command is journaled like the edit it reverts or repeats.
+bool ObjectManager::ApplyCommand(UndoCommand& _command, bool _undo)
+{
+	const size_t objectIndex = _command.objectIndex;
+	const size_t objectCount = m_objects.Size();
+
+	// Undoing an add and redoing a remove take the object out of the scene
+	const bool detach = (_command.op == UndoOp::Add) == _undo;
+
+	if (_command.op == UndoOp::Add || _command.op == UndoOp::Remove)
+	{
+		if (detach)
+		{
+			if (objectIndex >= objectCount || (_command.op == UndoOp::Add && objectIndex != objectCount - 1))
+				return false;
+
+			_command.detached = m_objects.GetValues()[objectIndex];
+			SaveLinks(objectIndex, _command);
+			_command.typedIndex = EraseObject(objectIndex);
+			DestroyInstance(*_command.detached);
+
+			if (m_journal)
+				m_journal->RecordRemove(static_cast<uint32_t>(objectIndex));
+			return true;
+		}
+
+		if (!_command.detached || objectIndex > objectCount || (_command.op == UndoOp::Add && objectIndex != objectCount))
+			return false;
+
+		InsertObject(_command.detached, objectIndex, _command.typedIndex);
+		SpawnInstance(*_command.detached);
+
+		if (m_journal)
+			m_journal->RecordAdd(static_cast<uint32_t>(objectIndex), _command.detached);
+
+		RestoreLinks(objectIndex, _command);
+		_command.detached = nullptr;
+		return true;
+	}
+
+	if (_command.op == UndoOp::Transform)
+	{
+		const std::vector<ObjectTransform>& transforms = _undo ? _command.transformsBefore : _command.transformsAfter;
+		if (transforms.size() != _command.objectIndices.size() || (!transforms.empty() && _command.objectIndices.back() >= objectCount))
+			return false;
+
+		std::vector<ObjectHandle> movedHandles;
+		movedHandles.reserve(transforms.size());
+		for (size_t i = 0; i < transforms.size(); i++)
+		{
+			const uint32_t index = _command.objectIndices[i];
+			Object& object = *m_objects.GetValues()[index];
+			ApplyObjectTransform(object, transforms[i]);
+			m_transforms.Update(index, object);
+			movedHandles.push_back(m_objects.GetHandle(index));
+			MarkSnapshotObject(&object);
+			JournalEdit(index, object, ObjectDiff::GetTransformMask(object));
+		}
+		m_sceneGraph.MarkMoved(movedHandles);
+		return true;
+	}
+
+	if (objectIndex >= objectCount)
+		return false;
+
+	if (_command.op == UndoOp::Edit)
+	{
+		Object& object = *m_objects.GetValues()[objectIndex];
+		const std::vector<uint8_t>& diff = _undo ? _command.before : _command.after;
+		if (!ObjectDiff::Apply(object, _command.fieldMask, ObjectFieldsVersion, diff.data(), diff.size(), m_triggerFunctionsMap))
+			return false;
+
+		RefreshObject(object, _command.fieldMask);
+		m_transforms.Update(objectIndex, object);
+		m_sceneGraph.MarkMoved(m_objects.GetHandle(objectIndex));
+		m_nameIndex.Rename(object);
+		IndexId(object, m_objects.GetHandle(objectIndex));
+		MarkSnapshotObject(&object);
+		JournalEdit(objectIndex, object, _command.fieldMask);
+		return true;
+	}
+
+	if (_command.op == UndoOp::Convert)
+	{
+		if (!_command.detached || m_objects.GetValues()[objectIndex]->objectType != ObjectType::TriggerVolume)
+			return false;
+
+		std::shared_ptr<TriggerVolume> triggerVolume = std::static_pointer_cast<TriggerVolume>(_command.detached);
+		_command.detached = m_objects.GetValues()[objectIndex];
+		ReplaceTriggerVolume(objectIndex, triggerVolume);
+
+		// A journaled convert only keeps the fields the two types share
+		if (m_journal)
+		{
+			m_journal->RecordConvert(static_cast<uint32_t>(objectIndex), triggerVolume->triggerVolumeType);
+			m_journal->RecordProperty(static_cast<uint32_t>(objectIndex), *triggerVolume, ObjectDiff::GetFieldsMask(*triggerVolume));
+		}
+		return true;
+	}
+
+	return false;
+}
+
+void ObjectManager::SaveLinks(size_t _objectIndex, UndoCommand& _command)
+{
+	const ObjectHandle handle = m_objects.GetHandle(_objectIndex);
+	_command.parentIndex = m_objects.GetIndex(m_sceneGraph.GetParent(handle));
+
+	std::vector<ObjectHandle> children;
+	m_sceneGraph.GetChildren(handle, children);
+	_command.childIndices.clear();
+	for (ObjectHandle child : children)
+		_command.childIndices.push_back(static_cast<uint32_t>(m_objects.GetIndex(child)));
+}
+
+//The object is back at _objectIndex and every other object where it was when the links were saved, see UndoCommand
+void ObjectManager::RestoreLinks(size_t _objectIndex, const UndoCommand& _command)
+{
+	const ObjectHandle handle = m_objects.GetHandle(_objectIndex);
+	if (_command.parentIndex >= 0 && static_cast<size_t>(_command.parentIndex) < m_objects.Size())
+		SetParent(handle, m_objects.GetHandle(_command.parentIndex));
+
+	for (uint32_t childIndex : _command.childIndices)
+	{
+		if (childIndex < m_objects.Size())
+			SetParent(m_objects.GetHandle(childIndex), handle);
+	}
+}
+
+//Links that would make a cycle are reported and dropped by the scene graph, the journal is rebased right after so they aren't journaled
+void ObjectManager::ApplyParents(const std::vector<int32_t>& _parents)
+{
+	const size_t objectCount = m_objects.Size();
+	for (size_t i = 0; i < std::min(_parents.size(), objectCount); i++)
+	{
+		if (_parents[i] < 0)
+			continue;
+
+		if (static_cast<size_t>(_parents[i]) >= objectCount)
+		{
+			LOG("[ERROR]Parent {} of {} isn't one of the loaded objects, the link was dropped", _parents[i], m_objects.GetValues()[i]->name);
+			continue;
+		}
+
+		m_sceneGraph.SetParent(m_objects.GetHandle(i), m_objects.GetHandle(_parents[i]));
+	}
+}
+
+//Registers the prefabs of a map that was read in full, rings of the scene made from a template they replace are moved over to them.
+//Only the template changes : the rings already hold the map's fields, their overrides are now taken against the map's template
+void ObjectManager::RegisterPrefabs(const std::vector<std::shared_ptr<const RingPrefab>>& _prefabs)
+{
+	if (_prefabs.empty())
+		return;
+
+	std::map<std::string, std::shared_ptr<const RingPrefab>> registered;
+	for (const std::shared_ptr<const RingPrefab>& prefab : _prefabs)
+		registered[prefab->id] = PrefabLibrary::Get().Register(prefab);
+
+	for (const std::shared_ptr<Ring>& ring : m_rings.GetValues())
+	{
+		if (!ring->prefab)
+			continue;
+
+		auto it = registered.find(ring->prefab->id);
+		if (it != registered.end())
+			ring->prefab = it->second;
+	}
+}
+
+int ObjectManager::FindObjectIndex(const Object* _object) const
+{
+	auto it = m_handles.find(_object);
+	return (it != m_handles.end()) ? m_objects.GetIndex(it->second.object) : -1;
+}
+
+ObjectHandle ObjectManager::GetHandle(const Object* _object) const
+{
+	auto it = m_handles.find(_object);
+	return (it != m_handles.end()) ? it->second.object : ObjectHandle();
+}
+
+ObjectHandle ObjectManager::GetHandle(size_t _objectIndex) const
+{
+	return m_objects.GetHandle(_objectIndex);
+}
+
+std::shared_ptr<Object> ObjectManager::FindObject(ObjectHandle _handle) const
+{
+	const std::shared_ptr<Object>* object = m_objects.Get(_handle);
+	return object ? *object : nullptr;
+}
+
+int ObjectManager::GetObjectIndex(ObjectHandle _handle) const
+{
+	return m_objects.GetIndex(_handle);
+}
+
+const TransformStore& ObjectManager::GetTransforms() const
+{
+	return m_transforms;
+}
+
+SceneGraph& ObjectManager::GetSceneGraph()
+{
+	return m_sceneGraph;
+}
+
+bool ObjectManager::SetParent(ObjectHandle _child, ObjectHandle _parent)
+{
+	if (!m_sceneGraph.SetParent(_child, _parent))
+		return false;
+
+	if (m_journal)
+		m_journal->RecordParent(static_cast<uint32_t>(m_objects.GetIndex(_child)), m_objects.GetIndex(_parent));
+	return true;
+}
+
+void ObjectManager::FindObjects(std::string_view _query, NameMatch _match, uint32_t _typeMask, std::vector<ObjectHandle>& _outHandles)
+{
+	m_nameIndex.Find(_query, _match, _typeMask, _outHandles);
+}
+
+std::shared_ptr<Checkpoint> ObjectManager::FindCheckpoint(int _checkpointId) const
+{
+	return std::static_pointer_cast<Checkpoint>(FindObject(m_checkpointIds.Find(_checkpointId)));
+}
+
+std::shared_ptr<Checkpoint> ObjectManager::FindStartCheckpoint() const
+{
+	return std::static_pointer_cast<Checkpoint>(FindObject(m_checkpointIds.FindLowest()));
+}
+
+std::shared_ptr<Ring> ObjectManager::FindRing(int _ringId) const
+{
+	return std::static_pointer_cast<Ring>(FindObject(m_ringIds.Find(_ringId)));
+}
+
+int ObjectManager::AllocateCheckpointId() const
+{
+	return m_checkpointIds.GetFreeId(m_reuseFreedIds);
+}
+
+int ObjectManager::AllocateRingId() const
+{
+	return m_ringIds.GetFreeId(m_reuseFreedIds);
+}
+
+void ObjectManager::SetReuseFreedIds(bool _reuseFreedIds)
+{
+	m_reuseFreedIds = _reuseFreedIds;
+}
+
+bool ObjectManager::GetReuseFreedIds() const
+{
+	return m_reuseFreedIds;
+}
+
+void ObjectManager::MarkTransformDirty(ObjectHandle _handle)
+{
+	std::lock_guard<std::mutex> lock(m_dirtyTransformsMutex);
+
+	if (m_dirtyTransforms.empty() || m_dirtyTransforms.back() != _handle)
+		m_dirtyTransforms.push_back(_handle);
+}
+
+void ObjectManager::UpdateTransforms()
+{
+	thread_local std::vector<ObjectHandle> dirtyTransforms;
+	{
+		std::lock_guard<std::mutex> lock(m_dirtyTransformsMutex);
+		dirtyTransforms.swap(m_dirtyTransforms);
+	}
+
+	// Handles of objects removed since they were marked are skipped
+	for (ObjectHandle handle : dirtyTransforms)
+	{
+		int objectIndex = m_objects.GetIndex(handle);
+		if (objectIndex < 0)
+			continue;
+
+		Object& object = *m_objects.GetValues()[objectIndex];
+		object.UpdateChildren();
+		m_transforms.Update(objectIndex, object);
+		MarkSnapshotObject(&object);
+	}
+	m_sceneGraph.MarkMoved(dirtyTransforms);
+
+	// Children moved along with their parents are journaled like any other move, a replayed journal has no links to follow
+	dirtyTransforms.clear();
+	m_sceneGraph.Resolve(dirtyTransforms);
+	for (ObjectHandle handle : dirtyTransforms)
+	{
+		int objectIndex = m_objects.GetIndex(handle);
+		const Object& object = *m_objects.GetValues()[objectIndex];
+		m_transforms.Update(objectIndex, object);
+		MarkSnapshotObject(&object);
+		JournalEdit(objectIndex, object, ObjectDiff::GetTransformMask(object));
+	}
+
+	dirtyTransforms.clear();
+}
+
+std::shared_ptr<const SceneSnapshot> ObjectManager::GetSnapshot() const
+{
+	return m_snapshot.load();
+}
+
+//Chunks holding a moved, added or edited object are rebuilt, the others are shared with the previous snapshot.
+//Only the edited and added objects are copied, a moved one keeps the copy it had
+void ObjectManager::PublishSnapshot()
+{
+	thread_local std::vector<uint32_t> indices;
+	thread_local std::vector<const Object*> changedObjects;
+	bool reset = false;
+	size_t shiftedFrom = SIZE_MAX;
+	{
+		std::lock_guard<std::mutex> lock(m_snapshotMutex);
+		indices.swap(m_snapshotIndices);
+		changedObjects.swap(m_snapshotObjects);
+		reset = m_snapshotReset;
+		m_snapshotReset = false;
+		shiftedFrom = m_snapshotShiftedFrom;
+		m_snapshotShiftedFrom = SIZE_MAX;
+	}
+
+	std::shared_ptr<const SceneSnapshot> previous = m_snapshot.load();
+	const size_t objectCount = m_objects.Size();
+	const uint64_t linksVersion = m_sceneGraph.GetLinksVersion();
+	if (!reset && indices.empty() && changedObjects.empty() && shiftedFrom == SIZE_MAX && previous->Size() == objectCount && linksVersion == m_snapshotLinksVersion)
+		return;
+
+	// Objects only change places where an index was marked, the parent indices are shared until then
+	const bool reordered = reset || !indices.empty() || shiftedFrom != SIZE_MAX || previous->Size() != objectCount;
+
+	// Every object after an insert or an erase moved, they keep the copies they had
+	for (size_t i = shiftedFrom; i < objectCount; i++)
+		indices.push_back(static_cast<uint32_t>(i));
+
+	// An edited object is copied again wherever it is now, objects removed since they were edited are skipped
+	for (const Object* object : changedObjects)
+	{
+		auto it = m_handles.find(object);
+		if (it == m_handles.end())
+			continue;
+
+		it->second.published = nullptr;
+		indices.push_back(static_cast<uint32_t>(m_objects.GetIndex(it->second.object)));
+	}
+	changedObjects.clear();
+
+	std::sort(indices.begin(), indices.end());
+	indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+	std::shared_ptr<SceneSnapshot> snapshot = std::make_shared<SceneSnapshot>();
+	snapshot->m_version = ++m_snapshotVersion;
+	snapshot->m_size = objectCount;
+
+	if (linksVersion != m_snapshotLinksVersion || (reordered && previous->m_parents))
+	{
+		std::vector<int32_t> parents;
+		m_sceneGraph.GetParentIndices(parents);
+		if (!parents.empty())
+			snapshot->m_parents = std::make_shared<const std::vector<int32_t>>(std::move(parents));
+		m_snapshotLinksVersion = linksVersion;
+	}
+	else
+	{
+		snapshot->m_parents = previous->m_parents;
+	}
+
+	const size_t chunkCount = (objectCount + SceneSnapshot::ChunkSize - 1) / SceneSnapshot::ChunkSize;
+	if (!reset)
+		snapshot->m_chunks.assign(previous->m_chunks.begin(), previous->m_chunks.begin() + std::min<size_t>(previous->m_chunks.size(), chunkCount));
+	snapshot->m_chunks.resize(chunkCount);
+
+	auto dirty = indices.begin();
+	for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+	{
+		const size_t first = chunkIndex * SceneSnapshot::ChunkSize;
+		const size_t length = std::min<size_t>(SceneSnapshot::ChunkSize, objectCount - first);
+		const std::shared_ptr<const SceneSnapshot::Chunk> shared = snapshot->m_chunks[chunkIndex];
+
+		// A chunk that grew or shrank (the last one, after an add or a remove) is rebuilt as well
+		const bool hasDirty = dirty != indices.end() && *dirty < first + length;
+		if (shared && shared->size() == length && !hasDirty)
+			continue;
+
+		std::shared_ptr<SceneSnapshot::Chunk> chunk = std::make_shared<SceneSnapshot::Chunk>();
+		chunk->reserve(length);
+		for (size_t i = first; i < first + length; i++)
+		{
+			const bool isDirty = dirty != indices.end() && *dirty == i;
+			if (isDirty)
+				++dirty;
+
+			if (shared && i - first < shared->size() && !isDirty)
+				chunk->push_back((*shared)[i - first]);
+			else
+				chunk->push_back(GetPublishedCopy(i));
+		}
+		snapshot->m_chunks[chunkIndex] = std::move(chunk);
+	}
+
+	indices.clear();
+	m_snapshot.store(std::move(snapshot));
+}
+
+void ObjectManager::MarkSnapshotIndex(size_t _objectIndex)
+{
+	std::lock_guard<std::mutex> lock(m_snapshotMutex);
+	m_snapshotIndices.push_back(static_cast<uint32_t>(_objectIndex));
+}
+
+void ObjectManager::MarkSnapshotShift(size_t _objectIndex)
+{
+	std::lock_guard<std::mutex> lock(m_snapshotMutex);
+	m_snapshotShiftedFrom = std::min(m_snapshotShiftedFrom, _objectIndex);
+}
+
+void ObjectManager::MarkSnapshotObject(const Object* _object)
+{
+	std::lock_guard<std::mutex> lock(m_snapshotMutex);
+
+	if (m_snapshotObjects.empty() || m_snapshotObjects.back() != _object)
+		m_snapshotObjects.push_back(_object);
+}
+
+const std::shared_ptr<Object>& ObjectManager::GetPublishedCopy(size_t _objectIndex)
+{
+	const std::shared_ptr<Object>& object = m_objects.GetValues()[_objectIndex];
+	ObjectSlots& slots = m_handles.find(object.get())->second;
+	if (!slots.published)
+		slots.published = SnapshotObject(object);
+	return slots.published;
+}
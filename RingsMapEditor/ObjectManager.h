@@ -2,7 +2,56 @@
 
 #include "Ring.h"
 #include "TriggerFunctions.h"
+#include "SlotMap.h"
+#include "TransformStore.h"
+#include "UndoStack.h"
+#include "NameIndex.h"
+#include "SceneGraph.h"
+#include "PrefabLibrary.h"
+#include "IdTable.h"
+#include "SceneSnapshot.h"
 
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+class EditJournal;
+
+//Stays valid while its object is in the scene, whatever is added or removed around it
+using ObjectHandle = SlotHandle;
+
+//State of an object captured when an edit starts, CommitEdit() journals whatever changed since
+struct ObjectEdit
+{
+    std::shared_ptr<Object> object;
+    std::shared_ptr<Object> before; // detached copy of the object when the edit started
+    uint64_t undoGeneration = 0;    // an edit started before an undo, a redo or a prefab save starts over instead of being recorded
+};
+
+struct ReconcileStats
+{
+    size_t kept = 0;    // identical, left untouched
+    size_t updated = 0; // same object, changed fields applied in place
+    size_t added = 0;
+    size_t removed = 0;
+};
+
+//What a map holds besides its objects, by index in the same object list. Filled in by the map readers, applied by LoadObjects()
+struct MapExtras
+{
+    std::vector<int32_t> parents; // parent of each object, -1 for none. Empty when no object has a parent
+    std::vector<std::shared_ptr<const RingPrefab>> prefabs; // user prefabs defined by the map, the rings made from them already point to them
+};
+
+//Moves a group of objects as one : scaled then rotated about the pivot, then translated
+struct GroupTransform
+{
+    Vector translation = { 0.f, 0.f, 0.f };
+    Rotator rotation = { 0, 0, 0 };
+    float scale = 1.f;                 // the objects' own scales are multiplied by it too
+    Vector pivot = { 0.f, 0.f, 0.f };
+    bool pivotAtCenter = true;         // pivot is ignored, the group turns and scales about the center of its objects
+};
 
 class ObjectManager
 {
@@ -11,17 +60,61 @@ public:
 	~ObjectManager();
 
     void AddObject(ObjectType _objectType);
-    void AddObject(const std::shared_ptr<Object>& _object);
-    void AddMesh(const std::shared_ptr<Mesh>& _mesh);
-    void AddTriggerVolume(const std::shared_ptr<TriggerVolume>& _triggerVolume);
-    void AddCheckpoint(const std::shared_ptr<Checkpoint>& _checkpoint);
-    void AddRing(const std::shared_ptr<Ring>& _ring);
+    ObjectHandle AddObject(const std::shared_ptr<Object>& _object);
     std::shared_ptr<Object> CopyObject(Object& _object);
-    void RemoveObject(const int& _objectIndex);
+    void RemoveObject(ObjectHandle _handle);
     void ClearObjects();
+    void LoadObjects(const std::vector<std::shared_ptr<Object>>& _objects, const MapExtras& _extras = {});
+    ReconcileStats ReconcileObjects(const std::vector<std::shared_ptr<Object>>& _objects, const MapExtras& _extras = {});
+    int FindObjectIndex(const Object* _object) const;
+
+    ObjectHandle GetHandle(const Object* _object) const;
+    ObjectHandle GetHandle(size_t _objectIndex) const;
+    std::shared_ptr<Object> FindObject(ObjectHandle _handle) const;
+    int GetObjectIndex(ObjectHandle _handle) const;
+
+    //Transform rows follow GetObjects(), an object edited in place must be marked so its row is copied again
+    const TransformStore& GetTransforms() const;
+    void MarkTransformDirty(ObjectHandle _handle); // any thread
+    void UpdateTransforms();                       // game thread
+
+    //Copy-on-write snapshot of the scene for readers on other threads (map saves), published again once per tick after something changed.
+    //Edits in progress in the properties panel show up once they're committed
+    std::shared_ptr<const SceneSnapshot> GetSnapshot() const; // any thread
+    void PublishSnapshot();                                   // game thread
+
+    //Parent / child links, children follow their parent when its transform is resolved in UpdateTransforms()
+    SceneGraph& GetSceneGraph();
+    //SceneGraph::SetParent() with the link journaled, links are saved with the map
+    bool SetParent(ObjectHandle _child, ObjectHandle _parent);
+
+    //Case insensitive search over the object names, renames are picked up when the edit is committed
+    void FindObjects(std::string_view _query, NameMatch _match, uint32_t _typeMask, std::vector<ObjectHandle>& _outHandles);
+
+    //Checkpoints and rings by id in constant time, id changes are picked up when the edit is committed.
+    //New ids are one past the highest id used in the scene, or the lowest free id once freed ids are reused
+    std::shared_ptr<Checkpoint> FindCheckpoint(int _checkpointId) const;
+    std::shared_ptr<Ring> FindRing(int _ringId) const;
+    //Races start at the checkpoint with the lowest id
+    std::shared_ptr<Checkpoint> FindStartCheckpoint() const;
+    int AllocateCheckpointId() const;
+    int AllocateRingId() const;
+    void SetReuseFreedIds(bool _reuseFreedIds);
+    bool GetReuseFreedIds() const;
 
     void ConvertTriggerVolume(std::shared_ptr<TriggerVolume> _triggerVolume, TriggerVolumeType _triggerVolumeType);
 
+    //Replaces the prefab _id with _ring and moves every ring made from it over in one pass, each keeps its transform and its overrides.
+    //Returns the number of rings updated. Changing a template isn't undoable, the rings' edits are journaled
+    size_t UpdatePrefab(const std::string& _id, const Ring& _ring);
+    //Registers _ring as the new prefab _id and links _ring to it, the link is one undo step. The definition is journaled ahead of the link
+    //so a recovered ring finds its template. Returns nullptr when _id is taken or _ring isn't in the scene. Game thread
+    std::shared_ptr<const RingPrefab> SavePrefab(const std::string& _id, const std::shared_ptr<Ring>& _ring);
+
+    //Applies _transform to every object in _handles in one pass over their transform rows, then pushes the new transforms to the objects,
+    //their actors and their trigger volumes. Children follow their parents rigidly. One undo step, returns the number of objects moved. Game thread
+    size_t TransformObjects(const std::vector<ObjectHandle>& _handles, const GroupTransform& _transform);
+
     std::vector<std::shared_ptr<Object>>& GetObjects();
     std::vector<std::shared_ptr<Mesh>>& GetMeshes();
     std::vector<std::shared_ptr<TriggerVolume>>& GetTriggerVolumes();
@@ -29,17 +122,87 @@ public:
     std::vector<std::shared_ptr<Ring>>& GetRings();
     std::map<std::string, std::shared_ptr<TriggerFunction>>& GetTriggerFunctionsMap();
 
-    std::vector<std::shared_ptr<Object>> m_objects;
-    std::vector<std::shared_ptr<Mesh>> m_meshes;
-    std::vector<std::shared_ptr<TriggerVolume>> m_triggerVolumes;
+    //Edit journal, every mutation above is recorded once a journal is set
+    void SetJournal(const std::shared_ptr<EditJournal>& _journal);
+    //Compactions start from GetSnapshot(), call it after PublishSnapshot() so every edit journaled so far is in the snapshot. Game thread
+    void UpdateJournal();
+    ObjectEdit BeginEdit(const std::shared_ptr<Object>& _object);
+    void CommitEdit(ObjectEdit& _edit);
+
+    //Undo history of every mutation above, undo and redo respawn or destroy mesh actors so they run on the game thread
+    bool Undo();
+    bool Redo();
+    UndoStack& GetUndoStack();
+
+    //Dense storage is iterated directly. m_objects keeps the order objects were added in, the one the object list and the saved maps show :
+    //a removal moves the objects after it down one place. The typed slot maps swap their last value into the freed place instead
+    SlotMap<std::shared_ptr<Object>> m_objects;
+    SlotMap<std::shared_ptr<Mesh>> m_meshes;
+    SlotMap<std::shared_ptr<TriggerVolume>> m_triggerVolumes;
+    SlotMap<std::shared_ptr<Checkpoint>> m_checkpoints;
     std::map<std::string, std::shared_ptr<TriggerFunction>> m_triggerFunctionsMap = {
-        { "Set Location", std::make_shared<SetLocation>()},
-        { "Set Rotation", std::make_shared<SetRotation>() },
-        { "Destroy", std::make_shared<Destroy>() },
-        { "Teleport To Checkpoint", std::make_shared<TeleportToCheckpoint>() }
+        { "Set Location", MakePooled<SetLocation>()},
+        { "Set Rotation", MakePooled<SetRotation>() },
+        { "Destroy", MakePooled<Destroy>() },
+        { "Teleport To Checkpoint", MakePooled<TeleportToCheckpoint>() }
     };
 
-    std::vector<std::shared_ptr<Ring>> m_rings;
+    SlotMap<std::shared_ptr<Ring>> m_rings;
 
 private:
+    //Where an object lives, in m_objects and in the slot map of its type
+    struct ObjectSlots
+    {
+        ObjectHandle object;
+        SlotHandle typed;
+        std::shared_ptr<Object> published; // copy of the object in the current snapshot, dropped when the object changes
+    };
+
+    // _objectIndex and _typedIndex put the object back where it was in the scene and in the slot map of its type, it goes last otherwise
+    ObjectHandle InsertObject(const std::shared_ptr<Object>& _object, size_t _objectIndex = SIZE_MAX, size_t _typedIndex = SIZE_MAX);
+    // Returns the index the object had in the slot map of its type
+    uint32_t EraseObject(size_t _objectIndex);
+    void ReplaceTriggerVolume(size_t _objectIndex, const std::shared_ptr<TriggerVolume>& _triggerVolume);
+    void JournalEdit(size_t _objectIndex, const Object& _object, uint64_t _fieldMask);
+    // Reads the checkpoint or ring id of the object again, a duplicate is reported
+    void IndexId(const Object& _object, ObjectHandle _handle);
+    // What the next PublishSnapshot() has to copy : a place that holds another object, every place from an insert or an erase on,
+    // an object whose fields changed (any thread)
+    void MarkSnapshotIndex(size_t _objectIndex);
+    void MarkSnapshotShift(size_t _objectIndex);
+    void MarkSnapshotObject(const Object* _object);
+    const std::shared_ptr<Object>& GetPublishedCopy(size_t _objectIndex);
+    bool ApplyCommand(UndoCommand& _command, bool _undo);
+    // Links of an object about to be erased, by the indices they have before it is
+    void SaveLinks(size_t _objectIndex, UndoCommand& _command);
+    void RestoreLinks(size_t _objectIndex, const UndoCommand& _command);
+    void ApplyParents(const std::vector<int32_t>& _parents);
+    void RegisterPrefabs(const std::vector<std::shared_ptr<const RingPrefab>>& _prefabs);
+    void RebaseJournal();
+
+    // Nodes come from a pool too, pasting or loading objects doesn't do a heap allocation per object for the map
+    std::unordered_map<const Object*, ObjectSlots, std::hash<const Object*>, std::equal_to<const Object*>,
+        PoolAllocator<std::pair<const Object* const, ObjectSlots>>> m_handles;
+    TransformStore m_transforms;
+    NameIndex m_nameIndex;
+    SceneGraph m_sceneGraph{ m_objects };
+    IdTable m_checkpointIds;
+    IdTable m_ringIds;
+    std::atomic<bool> m_reuseFreedIds = false;
+
+    std::mutex m_snapshotMutex;
+    std::vector<uint32_t> m_snapshotIndices;
+    std::vector<const Object*> m_snapshotObjects;
+    size_t m_snapshotShiftedFrom = SIZE_MAX;
+    bool m_snapshotReset = true; // every object is copied again
+    std::atomic<std::shared_ptr<const SceneSnapshot>> m_snapshot;
+    uint64_t m_snapshotVersion = 0;
+    uint64_t m_snapshotLinksVersion = 0;
+
+    std::mutex m_dirtyTransformsMutex;
+    std::vector<ObjectHandle> m_dirtyTransforms;
+
+    std::shared_ptr<EditJournal> m_journal;
+    UndoStack m_undoStack;
+    std::atomic<uint64_t> m_undoGeneration = 0;
 };
\ No newline at end of file
@@ -0,0 +1,222 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+//Fixed-size blocks carved out of slabs and recycled through a free list threaded in the freed blocks.
+//Slabs are never given back, a pool holds as many blocks as were ever alive at the same time.
+//Each thread keeps a small free list of its own and only takes the pool's lock to move a batch of blocks in or out of it,
+//so the JSON loader workers don't serialise on the pool while they build objects.
+template <size_t BlockSize, size_t BlockAlign>
+class BlockPool
+{
+public:
+	// Never destroyed : shared_ptrs held by globals can still release their blocks during static destruction
+	static BlockPool& Get()
+	{
+		static BlockPool* pool = new BlockPool();
+		return *pool;
+	}
+
+	// Objects are created on the game thread, the ImGui thread, the JSON loader workers and the save thread
+	void* Allocate()
+	{
+		ThreadCache& cache = t_cache;
+		if (cache.closed)
+			return AllocateShared();
+
+		if (!cache.freeList)
+		{
+			t_cacheFlusher.Touch();
+			Refill(cache);
+		}
+
+		FreeBlock* block = cache.freeList;
+		cache.freeList = block->next;
+		cache.count--;
+		return block;
+	}
+
+	void Deallocate(void* _block)
+	{
+		FreeBlock* block = static_cast<FreeBlock*>(_block);
+
+		ThreadCache& cache = t_cache;
+		if (cache.closed)
+		{
+			DeallocateShared(block);
+			return;
+		}
+
+		t_cacheFlusher.Touch();
+		block->next = cache.freeList;
+		cache.freeList = block;
+		if (++cache.count >= MaxCachedBlocks)
+			Release(cache, BatchBlocks);
+	}
+
+private:
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	// Trivially destructible, so blocks freed while the thread's destructors run still find it
+	struct ThreadCache
+	{
+		FreeBlock* freeList = nullptr;
+		size_t count = 0;
+		bool closed = false; // the thread is exiting, its blocks went back to the pool
+	};
+
+	// Gives a thread's cached blocks back to the pool when the thread exits
+	struct CacheFlusher
+	{
+		void Touch() {}
+		~CacheFlusher()
+		{
+			ThreadCache& cache = t_cache;
+			Get().Release(cache, cache.count);
+			cache.closed = true;
+		}
+	};
+
+	static constexpr size_t BatchBlocks = 32;
+	static constexpr size_t MaxCachedBlocks = BatchBlocks * 2;
+
+	static constexpr size_t Align = (BlockAlign > alignof(FreeBlock)) ? BlockAlign : alignof(FreeBlock);
+	static constexpr size_t Stride = (((BlockSize > sizeof(FreeBlock)) ? BlockSize : sizeof(FreeBlock)) + Align - 1) / Align * Align;
+	static constexpr size_t FirstSlabBlocks = 64;
+	static constexpr size_t MaxSlabBlocks = 4096;
+
+	BlockPool() = default;
+
+	void* AllocateShared()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_freeList)
+			AddSlab();
+
+		FreeBlock* block = m_freeList;
+		m_freeList = block->next;
+		return block;
+	}
+
+	void DeallocateShared(FreeBlock* _block)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		_block->next = m_freeList;
+		m_freeList = _block;
+	}
+
+	// Moves up to BatchBlocks blocks from the pool into the thread's list under one lock
+	void Refill(ThreadCache& _cache)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		for (size_t i = 0; i < BatchBlocks; i++)
+		{
+			if (!m_freeList)
+				AddSlab();
+
+			FreeBlock* block = m_freeList;
+			m_freeList = block->next;
+			block->next = _cache.freeList;
+			_cache.freeList = block;
+		}
+		_cache.count += BatchBlocks;
+	}
+
+	// Moves _blockCount blocks from the thread's list back to the pool under one lock
+	void Release(ThreadCache& _cache, size_t _blockCount)
+	{
+		if (_blockCount == 0)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		for (size_t i = 0; i < _blockCount && _cache.freeList; i++)
+		{
+			FreeBlock* block = _cache.freeList;
+			_cache.freeList = block->next;
+			block->next = m_freeList;
+			m_freeList = block;
+			_cache.count--;
+		}
+	}
+
+	void AddSlab()
+	{
+		// Slabs double in size so a 10k object paste only adds a handful of them
+		size_t blockCount = m_slabs.empty() ? FirstSlabBlocks : m_lastSlabBlocks * 2;
+		if (blockCount > MaxSlabBlocks)
+			blockCount = MaxSlabBlocks;
+
+		std::byte* slab = static_cast<std::byte*>(::operator new(Stride * blockCount, std::align_val_t(Align)));
+		m_slabs.push_back(slab);
+		m_lastSlabBlocks = blockCount;
+
+		// Threaded back to front so blocks are handed out in address order
+		for (size_t i = blockCount; i > 0; i--)
+		{
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * Stride);
+			block->next = m_freeList;
+			m_freeList = block;
+		}
+	}
+
+	std::mutex m_mutex;
+	FreeBlock* m_freeList = nullptr;
+	std::vector<std::byte*> m_slabs;
+	size_t m_lastSlabBlocks = 0;
+
+	static inline thread_local ThreadCache t_cache;
+	static inline thread_local CacheFlusher t_cacheFlusher;
+};
+
+//Stateless allocator for std::allocate_shared : the shared_ptr control block and the object share one pooled block.
+//Pools are per block size, so every type (rebound to its control block type) gets its own pool unless two types have the same size.
+template <typename T>
+class PoolAllocator
+{
+public:
+	using value_type = T;
+
+	PoolAllocator() noexcept = default;
+
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+	T* allocate(size_t _count)
+	{
+		if (_count != 1)
+			return static_cast<T*>(::operator new(_count * sizeof(T), std::align_val_t(alignof(T))));
+
+		return static_cast<T*>(BlockPool<sizeof(T), alignof(T)>::Get().Allocate());
+	}
+
+	void deallocate(T* _pointer, size_t _count) noexcept
+	{
+		if (_count != 1)
+		{
+			::operator delete(_pointer, std::align_val_t(alignof(T)));
+			return;
+		}
+
+		BlockPool<sizeof(T), alignof(T)>::Get().Deallocate(_pointer);
+	}
+
+	template <typename U>
+	bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+};
+
+//Replaces std::make_shared for editor objects and trigger functions
+template <typename T, typename... Args>
+std::shared_ptr<T> MakePooled(Args&&... _args)
+{
+	return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(_args)...);
+}
@@ -0,0 +1,118 @@
+#include "pch.h"
+#include <algorithm>
+#include "OverlayRenderer.h"
+
+
+OverlayRenderer::OverlayRenderer(std::shared_ptr<ObjectManager> _objectManager)
+{
+	m_objectManager = _objectManager;
+}
+
+
+
+void OverlayRenderer::Render(CanvasWrapper _canvas, CameraWrapper _camera)
+{
+	RT::Frustum frustum(_canvas, _camera);
+	Vector cameraLocation = _camera.GetLocation();
+
+	CollectVisibleObjects(frustum, cameraLocation);
+
+	//Partial sort, only the first m_budget items need to be the biggest ones, their order doesn't matter
+	size_t fullDetailCount = min(static_cast<size_t>(m_budget), m_visibleItems.size());
+	if (fullDetailCount > 0 && fullDetailCount < m_visibleItems.size())
+	{
+		std::nth_element(m_visibleItems.begin(), m_visibleItems.begin() + (fullDetailCount - 1), m_visibleItems.end(),
+			[](const OverlayRenderItem& a, const OverlayRenderItem& b) {
+				return a.score > b.score;
+			});
+	}
+
+	for (size_t i = 0; i < fullDetailCount; i++)
+	{
+		RenderFullDetail(_canvas, frustum, m_visibleItems[i].object);
+	}
+
+	_canvas.SetColor(180, 180, 180, 200);
+	for (size_t i = fullDetailCount; i < m_visibleItems.size(); i++)
+	{
+		RenderMarker(_canvas, m_visibleItems[i].location);
+	}
+
+	m_used = static_cast<int>(fullDetailCount);
+}
+
+void OverlayRenderer::RenderStats(CanvasWrapper _canvas, Vector2 _position)
+{
+	uint64_t key = HudText::Combine(HudText::Combine(m_used, m_budget), GetVisibleCount());
+	if (m_statsHud.Update(key))
+	{
+		m_statsHud.SetLine(0, "Overlays : {} / {} ({} visible)", m_used, m_budget, GetVisibleCount());
+	}
+
+	m_statsHud.SetPosition(_position);
+	m_statsHud.Render(_canvas);
+}
+
+int OverlayRenderer::GetBudget() const
+{
+	return m_budget;
+}
+
+void OverlayRenderer::SetBudget(int _budget)
+{
+	m_budget = max(_budget, 0);
+}
+
+int OverlayRenderer::GetUsed() const
+{
+	return m_used;
+}
+
+int OverlayRenderer::GetVisibleCount() const
+{
+	return static_cast<int>(m_visibleItems.size());
+}
+
+void OverlayRenderer::CollectVisibleObjects(RT::Frustum& _frustum, const Vector& _cameraLocation)
+{
+	m_visibleItems.clear();
+
+	//Culled on the transform arrays, only the visible objects are dereferenced
+	const TransformStore& transforms = m_objectManager->GetTransforms();
+	transforms.FindInFrustum(_frustum, m_visibleRows);
+
+	std::vector<std::shared_ptr<Object>>& objects = m_objectManager->GetObjects();
+	for (uint32_t row : m_visibleRows)
+	{
+		ObjectType objectType = transforms.GetObjectType(row);
+		if (objectType != ObjectType::TriggerVolume && objectType != ObjectType::Checkpoint && objectType != ObjectType::Ring)
+			continue;
+
+		Vector location = transforms.GetLocation(row);
+		Vector toObject = location - _cameraLocation;
+		float distance = max(toObject.magnitude(), 1.f);
+
+		OverlayRenderItem item;
+		item.object = objects[row].get();
+		item.location = location;
+		item.score = transforms.GetBoundingRadius(row) / distance;
+		m_visibleItems.emplace_back(item);
+	}
+}
+
+void OverlayRenderer::RenderFullDetail(CanvasWrapper _canvas, RT::Frustum& _frustum, Object* _object)
+{
+	if (_object->objectType == ObjectType::TriggerVolume)
+		static_cast<TriggerVolume*>(_object)->Render(_canvas, _frustum);
+	else if (_object->objectType == ObjectType::Checkpoint)
+		static_cast<Checkpoint*>(_object)->Render(_canvas, _frustum);
+	else if (_object->objectType == ObjectType::Ring)
+		static_cast<Ring*>(_object)->RenderTriggerVolumes(_canvas, _frustum);
+}
+
+void OverlayRenderer::RenderMarker(CanvasWrapper _canvas, const Vector& _location)
+{
+	Vector2F projected = _canvas.ProjectF(_location);
+	_canvas.SetPosition(Vector2F{ projected.X - (m_markerSize / 2.f), projected.Y - (m_markerSize / 2.f) });
+	_canvas.DrawBox(Vector2F{ m_markerSize, m_markerSize });
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ObjectManager.h"
+#include "HudText.h"
+
+struct OverlayRenderItem
+{
+	Object* object = nullptr;
+	Vector location;
+	float score = 0.f; // approximate on-screen size : bounding radius / distance to camera
+};
+
+//Draws the editor wireframes of trigger volumes, checkpoints and rings.
+//Only the m_budget biggest objects on screen get their full wireframe, the others get a cheap marker.
+class OverlayRenderer
+{
+public:
+	OverlayRenderer(std::shared_ptr<ObjectManager> _objectManager);
+	~OverlayRenderer() = default;
+
+	void Render(CanvasWrapper _canvas, CameraWrapper _camera);
+	void RenderStats(CanvasWrapper _canvas, Vector2 _position);
+
+	int GetBudget() const;
+	void SetBudget(int _budget);
+	int GetUsed() const;
+	int GetVisibleCount() const;
+
+private:
+	void CollectVisibleObjects(RT::Frustum& _frustum, const Vector& _cameraLocation);
+	void RenderFullDetail(CanvasWrapper _canvas, RT::Frustum& _frustum, Object* _object);
+	void RenderMarker(CanvasWrapper _canvas, const Vector& _location);
+
+	std::shared_ptr<ObjectManager> m_objectManager;
+	std::vector<OverlayRenderItem> m_visibleItems; //reused every frame to avoid reallocating
+	std::vector<uint32_t> m_visibleRows;
+
+	HudText m_statsHud = HudText(Vector2{ 20, 50 }, 1.5f, 1);
+
+	int m_budget = 64;
+	int m_used = 0;
+	float m_markerSize = 6.f;
+};
@@ -0,0 +1,160 @@
+#include "pch.h"
+#include <algorithm>
+#include "PrefabLibrary.h"
+#include "ObjectDiff.h"
+
+namespace
+{
+	constexpr uint64_t InstanceFields = GetFieldMask<Ring>({ "location", "name", "objectType", "prefab", "ringId", "rotation", "scale" });
+	constexpr uint64_t PartFields = GetFieldMask<Ring>({ "mesh", "triggerVolumeIn", "triggerVolumeIn_offset_location", "triggerVolumeIn_offset_rotation",
+		"triggerVolumeOut", "triggerVolumeOut_offset_location", "triggerVolumeOut_offset_rotation" });
+}
+
+
+
+PrefabLibrary& PrefabLibrary::Get()
+{
+	static PrefabLibrary* library = new PrefabLibrary();
+	return *library;
+}
+
+PrefabLibrary::PrefabLibrary()
+{
+	Register(RingSmallPrefab, Ring_Small(-1), true);
+}
+
+std::shared_ptr<const RingPrefab> PrefabLibrary::Find(const std::string& _id) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto it = m_prefabs.find(_id);
+	return it != m_prefabs.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<const RingPrefab> PrefabLibrary::Register(const std::string& _id, const Ring& _ring, bool _builtIn)
+{
+	return Register(MakePrefab(_id, _ring, _builtIn));
+}
+
+std::shared_ptr<const RingPrefab> PrefabLibrary::Register(const std::shared_ptr<const RingPrefab>& _prefab)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// A built-in template is never replaced by one loaded from a map
+	auto it = m_prefabs.find(_prefab->id);
+	if (it != m_prefabs.end() && it->second->builtIn && !_prefab->builtIn)
+	{
+		LOG("[ERROR]{} is a built-in prefab, it can't be replaced", _prefab->id);
+		return it->second;
+	}
+
+	m_prefabs[_prefab->id] = _prefab;
+	return _prefab;
+}
+
+void PrefabLibrary::GetIds(std::vector<std::string>& _outIds) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	_outIds.clear();
+	for (const auto& [id, prefab] : m_prefabs)
+		_outIds.push_back(id);
+}
+
+std::shared_ptr<const RingPrefab> PrefabLibrary::MakePrefab(const std::string& _id, const Ring& _ring, bool _builtIn)
+{
+	// Callbacks are cloned so the template doesn't share them with _ring
+	std::shared_ptr<RingParts> parts = std::make_shared<RingParts>(_ring.GetParts());
+	parts->ClearTransforms();
+	parts->triggerVolumeIn.onTouchCallback = CloneCallback(parts->triggerVolumeIn.onTouchCallback);
+	parts->triggerVolumeOut.onTouchCallback = CloneCallback(parts->triggerVolumeOut.onTouchCallback);
+
+	std::shared_ptr<RingPrefab> prefab = std::make_shared<RingPrefab>();
+	prefab->id = _id;
+	prefab->builtIn = _builtIn;
+	prefab->parts = parts;
+	prefab->ring = _ring; // a copy, the mesh actor stays _ring's
+	prefab->ring.ShareParts(parts);
+	prefab->ring.prefab = nullptr;
+	prefab->ring.ringId = -1;
+	prefab->ring.SetLocation(Vector(0));
+	prefab->ring.SetRotation(Rotator(0));
+	prefab->ring.UpdateChildren();
+	return prefab;
+}
+
+std::shared_ptr<Ring> PrefabLibrary::Instantiate(const std::string& _id, int _ringId) const
+{
+	std::shared_ptr<const RingPrefab> prefab = Find(_id);
+	if (!prefab)
+		return nullptr;
+
+	return Instantiate(prefab, _ringId);
+}
+
+std::shared_ptr<Ring> PrefabLibrary::Instantiate(const std::shared_ptr<const RingPrefab>& _prefab, int _ringId)
+{
+	// Shares the template's parts, callbacks included : they are only replaced along with the parts, never edited in place
+	std::shared_ptr<Ring> ring = MakePooled<Ring>(_prefab->ring);
+	ring->ringId = _ringId;
+	ring->prefab = _prefab;
+	return ring;
+}
+
+Ring PrefabLibrary::Place(const std::shared_ptr<const RingPrefab>& _prefab, const Ring& _ring)
+{
+	Ring placed = _prefab->ring;
+	placed.name = _ring.name;
+	placed.ringId = _ring.ringId;
+	placed.scale = _ring.scale;
+	placed.prefab = _prefab;
+	placed.SetLocation(_ring.location);
+	placed.SetRotation(_ring.rotation);
+	placed.UpdateChildren();
+	return placed;
+}
+
+uint64_t PrefabLibrary::GetOverrides(const Ring& _ring)
+{
+	if (!_ring.prefab)
+		return 0;
+
+	return ObjectDiff::Compare(Place(_ring.prefab, _ring), _ring) & ~InstanceFields;
+}
+
+void PrefabLibrary::ShareUnchangedParts(Ring& _ring)
+{
+	if (!_ring.prefab || !_ring.HasOwnParts())
+		return;
+
+	if (!(GetOverrides(_ring) & PartFields))
+		_ring.ShareParts(_ring.prefab->parts);
+}
+
+uint64_t PrefabLibrary::GetInstanceFields()
+{
+	return InstanceFields;
+}
+
+uint64_t PrefabLibrary::GetPartFields()
+{
+	return PartFields;
+}
+
+void PrefabLibrary::GetUserPrefabs(const std::vector<std::shared_ptr<Object>>& _objects, std::vector<std::shared_ptr<const RingPrefab>>& _outPrefabs)
+{
+	std::map<std::string, std::shared_ptr<const RingPrefab>> prefabs;
+	for (const std::shared_ptr<Object>& object : _objects)
+	{
+		if (!object || object->objectType != ObjectType::Ring)
+			continue;
+
+		const std::shared_ptr<const RingPrefab>& prefab = static_cast<const Ring&>(*object).prefab;
+		if (prefab && !prefab->builtIn)
+			prefabs.emplace(prefab->id, prefab);
+	}
+
+	_outPrefabs.clear();
+	for (auto& [id, prefab] : prefabs)
+		_outPrefabs.push_back(std::move(prefab));
+}
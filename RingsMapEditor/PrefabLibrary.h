@@ -0,0 +1,57 @@
+#pragma once
+#include "Ring.h"
+
+#include <map>
+#include <mutex>
+
+constexpr const char* RingSmallPrefab = "Ring Small";
+
+//Immutable ring template, shared by every ring made from it. Editing a template replaces it as a whole
+struct RingPrefab
+{
+	std::string id;
+	bool builtIn = false;                     // made in code, maps don't store it
+	std::shared_ptr<const RingParts> parts;   // mesh and trigger volumes, the rings made from the template read them until they override one
+	Ring ring;                                // at the origin, shares parts
+};
+
+//Ring templates by id : the built-in ring types, and the ones made in the editor which are stored in the maps using them.
+//A ring made from a template points to it, maps only store its transform, its id and the fields it overrides.
+class PrefabLibrary
+{
+public:
+	// Never destroyed, like the block pools : rings held by globals can still point to their template during static destruction
+	static PrefabLibrary& Get();
+
+	std::shared_ptr<const RingPrefab> Find(const std::string& _id) const;
+	// Replaces the template with the same id, the rings made from the old one keep it until they are moved over (ObjectManager::UpdatePrefab)
+	std::shared_ptr<const RingPrefab> Register(const std::string& _id, const Ring& _ring, bool _builtIn = false);
+	std::shared_ptr<const RingPrefab> Register(const std::shared_ptr<const RingPrefab>& _prefab);
+	void GetIds(std::vector<std::string>& _outIds) const;
+
+	// Template made from _ring without registering it, map readers hand theirs to ObjectManager which registers them with the scene
+	static std::shared_ptr<const RingPrefab> MakePrefab(const std::string& _id, const Ring& _ring, bool _builtIn = false);
+
+	// New ring made from the template, nullptr for an unknown id
+	std::shared_ptr<Ring> Instantiate(const std::string& _id, int _ringId) const;
+	static std::shared_ptr<Ring> Instantiate(const std::shared_ptr<const RingPrefab>& _prefab, int _ringId);
+
+	// The template with the transform, name and id of _ring : _ring as it would be without overrides
+	static Ring Place(const std::shared_ptr<const RingPrefab>& _prefab, const Ring& _ring);
+	// Fields of _ring that differ from its template (ObjectFields<Ring> mask), the instance fields aren't counted
+	static uint64_t GetOverrides(const Ring& _ring);
+	// Drops the own parts of a ring that doesn't override any of its template's, it shares them again
+	static void ShareUnchangedParts(Ring& _ring);
+	// Fields every instance stores itself
+	static uint64_t GetInstanceFields();
+	// Fields held in RingParts
+	static uint64_t GetPartFields();
+	// User prefabs the rings among _objects were made from, by id : the ones a map has to store
+	static void GetUserPrefabs(const std::vector<std::shared_ptr<Object>>& _objects, std::vector<std::shared_ptr<const RingPrefab>>& _outPrefabs);
+
+private:
+	PrefabLibrary();
+
+	mutable std::mutex m_mutex; // rings are made on the game thread, the ImGui thread and the JSON loader workers
+	std::map<std::string, std::shared_ptr<const RingPrefab>> m_prefabs;
+};
@@ -144,6 +144,15 @@
 //	return res;
 //}
 
+Quat RT::MultiplyQuats(const Quat& a, const Quat& b)
+{
+	return Quat(
+		a.W * b.W - a.X * b.X - a.Y * b.Y - a.Z * b.Z,
+		a.W * b.X + a.X * b.W + a.Y * b.Z - a.Z * b.Y,
+		a.W * b.Y - a.X * b.Z + a.Y * b.W + a.Z * b.X,
+		a.W * b.Z + a.X * b.Y - a.Y * b.X + a.Z * b.W);
+}
+
 Vector RT::VectorProjection(Vector vec1, Vector vec2)
 {
 	float dot = Vector::dot(vec1, vec2);
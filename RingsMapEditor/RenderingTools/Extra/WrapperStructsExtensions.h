@@ -15,6 +15,7 @@ namespace RT
 	//QUAT
 	//Quat Slerp(Quat q1, Quat q2, float percent);
 	//Quat NormalizeQuat(Quat q);
+	Quat MultiplyQuats(const Quat& a, const Quat& b); // rotates by b, then by a
 
 	//VECTOR
 	//Vector RotateVectorWithQuat(Vector v, Quat q, bool normalize=false);
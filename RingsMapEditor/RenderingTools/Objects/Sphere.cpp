@@ -4,6 +4,7 @@
 #include "Sphere.h"
 #include "Line.h"
 #include "Frustum.h"
+#include "Matrix3.h"
 #include "../Extra/RenderingMath.h"
 #include "../Extra/WrapperStructsExtensions.h"
 #include <vector>
@@ -115,6 +116,117 @@ void RT::Sphere::Draw(CanvasWrapper canvas, Frustum &frustum, Vector cameraLocat
 	}
 }
 
+void RT::Sphere::DrawSilhouette(CanvasWrapper canvas, Frustum &frustum, Vector cameraLocation, int32_t segments) const
+{
+	//Instead of testing every segment against the sphere, compute what is visible from the camera directly:
+	//  - the silhouette is the circle of tangent points seen from the camera
+	//  - a point Q of the sphere is visible when (Q - location) . (cameraLocation - location) > radius^2,
+	//    on a latitude circle that condition is A*cos(phi) + B*sin(phi) > K, which is a single arc
+
+	if(segments < 4)
+	{
+		segments = 4;
+	}
+
+	if(!frustum.IsInFrustum(location, radius))
+	{
+		return;
+	}
+
+	auto drawArc = [&](Vector center, Vector axisX, Vector axisY, float arcRadius, float startAngle, float arcAngle, int32_t arcSegments)
+	{
+		Vector previous = center + (axisX * cosf(startAngle) + axisY * sinf(startAngle)) * arcRadius;
+		bool previousInFrustum = frustum.IsInFrustum(previous);
+		for(int32_t i = 1; i <= arcSegments; ++i)
+		{
+			float angle = startAngle + arcAngle * i / arcSegments;
+			Vector current = center + (axisX * cosf(angle) + axisY * sinf(angle)) * arcRadius;
+			bool currentInFrustum = frustum.IsInFrustum(current);
+			if(previousInFrustum && currentInFrustum)
+			{
+				canvas.DrawLine(canvas.ProjectF(previous), canvas.ProjectF(current));
+			}
+			previous = current;
+			previousInFrustum = currentInFrustum;
+		}
+	};
+
+	Vector toCamera = cameraLocation - location;
+	float distance = toCamera.magnitude();
+
+	//Camera is inside the sphere, everything is visible from the inside
+	bool cameraInside = distance <= radius;
+
+	//Silhouette (horizon circle)
+	if(!cameraInside)
+	{
+		Vector viewDir = toCamera * (1.0f / distance);
+		Vector helperAxis = fabsf(viewDir.Z) < 0.99f ? Vector(0.0f,0.0f,1.0f) : Vector(1.0f,0.0f,0.0f);
+		Vector axisX = Vector::cross(viewDir, helperAxis);
+		axisX.normalize();
+		Vector axisY = Vector::cross(viewDir, axisX);
+
+		float centerOffset = (radius * radius) / distance;
+		float horizonRadius = sqrtf(radius * radius - centerOffset * centerOffset);
+		drawArc(location + viewDir * centerOffset, axisX, axisY, horizonRadius, 0.0f, 2.0f * CONST_PI_F, segments);
+	}
+
+	//Latitude arcs
+	Matrix3 matrix(orientation);
+	Vector poleAxis = matrix.up;
+	Vector equatorX = matrix.forward;
+	Vector equatorY = matrix.right;
+
+	float poleDot = Vector::dot(poleAxis, toCamera);
+	float equatorXDot = Vector::dot(equatorX, toCamera);
+	float equatorYDot = Vector::dot(equatorY, toCamera);
+
+	int32_t latitudes = segments / 2;
+	for(int32_t j = 1; j < latitudes; ++j)
+	{
+		float polarAngle = CONST_PI_F * j / latitudes;
+		float height = radius * cosf(polarAngle);
+		float latitudeRadius = radius * sinf(polarAngle);
+		Vector latitudeCenter = location + poleAxis * height;
+
+		if(cameraInside)
+		{
+			drawArc(latitudeCenter, equatorX, equatorY, latitudeRadius, 0.0f, 2.0f * CONST_PI_F, segments);
+			continue;
+		}
+
+		float A = latitudeRadius * equatorXDot;
+		float B = latitudeRadius * equatorYDot;
+		float K = radius * radius - height * poleDot;
+		float R = sqrtf(A * A + B * B);
+
+		if(R < 1e-4f)
+		{
+			//Camera is on the pole axis, the whole latitude is either visible or hidden
+			if(K < 0.0f)
+			{
+				drawArc(latitudeCenter, equatorX, equatorY, latitudeRadius, 0.0f, 2.0f * CONST_PI_F, segments);
+			}
+			continue;
+		}
+
+		float ratio = K / R;
+		if(ratio >= 1.0f)
+		{
+			continue;
+		}
+
+		float halfArc = ratio <= -1.0f ? CONST_PI_F : acosf(ratio);
+		float centerAngle = atan2f(B, A);
+		int32_t arcSegments = static_cast<int32_t>(ceilf(segments * halfArc / CONST_PI_F));
+		if(arcSegments < 1)
+		{
+			arcSegments = 1;
+		}
+		drawArc(latitudeCenter, equatorX, equatorY, latitudeRadius, centerAngle - halfArc, 2.0f * halfArc, arcSegments);
+	}
+}
+
 bool RT::Sphere::IsOccludingLine(Line &line) const
 {
 	//Checks if a line drawn from a point to the camera is occluded by the sphere
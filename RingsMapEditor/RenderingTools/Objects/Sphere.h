@@ -22,6 +22,7 @@ namespace RT
 
 		// FUNCTIONS
 		void Draw(CanvasWrapper canvas, Frustum &frustum, Vector cameraLocation, int32_t segments) const;
+		void DrawSilhouette(CanvasWrapper canvas, Frustum &frustum, Vector cameraLocation, int32_t segments) const; // Horizon circle + visible latitude arcs, no occlusion tests
 
 		bool IsOccludingLine(Line &line) const;
 	};
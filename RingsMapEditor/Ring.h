@@ -2,6 +2,38 @@
 #include "Mesh.h"
 #include "TriggerVolume.h"
 
+struct RingPrefab;
+
+//What a ring is made of besides its transform. The parts have no transform of their own :
+//the mesh sits at the ring's origin and the trigger volumes at their offsets from it.
+//Rings made from a prefab share its parts and only copy them once one of them is edited (an override)
+struct RingParts
+{
+	RingParts() {
+		mesh.enableCollisions = true;
+	}
+
+	// Readers of maps that stored the parts placed in the world put them back at the origin
+	void ClearTransforms() {
+		mesh.location = Vector(0);
+		mesh.rotation = Rotator(0);
+		triggerVolumeIn.location = Vector(0);
+		triggerVolumeIn.rotation = Rotator(0);
+		triggerVolumeOut.location = Vector(0);
+		triggerVolumeOut.rotation = Rotator(0);
+	}
+
+	Mesh mesh; // never spawned, see Ring::SpawnMesh()
+
+	TriggerVolume_Cylinder triggerVolumeIn;
+	Vector triggerVolumeIn_offset_location;
+	Rotator triggerVolumeIn_offset_rotation;
+
+	TriggerVolume_Box triggerVolumeOut;
+	Vector triggerVolumeOut_offset_location;
+	Rotator triggerVolumeOut_offset_rotation;
+};
+
 class Ring : public Object
 {
 public:
@@ -10,129 +42,211 @@ public:
 		name = "Ring";
 
 		ringId = -1;
-		mesh = Mesh();
-		mesh.enableCollisions = true;
-		triggerVolumeIn = TriggerVolume_Cylinder();
-		triggerVolumeOut = TriggerVolume_Box();
+		m_sharedParts = GetDefaultParts();
 
 		SetLocation(Vector(0));
 		SetRotation(Rotator(0));
 	}
 
-	Ring(int _id) {
-		objectType = ObjectType::Ring;
-		name = "Ring";
-
+	Ring(int _id) : Ring() {
 		ringId = _id;
-		mesh = Mesh("Ring Mesh");
-		mesh.enableCollisions = true;
-		triggerVolumeIn = TriggerVolume_Cylinder();
-		triggerVolumeOut = TriggerVolume_Box();
+		EditParts().mesh.name = "Ring Mesh";
+	}
 
-		SetLocation(Vector(0));
-		SetRotation(Rotator(0));
+	// Copies are never spawned, their own parts are copied
+	Ring(const Ring& _other) : Object(_other), ringId(_other.ringId), prefab(_other.prefab), m_sharedParts(_other.m_sharedParts),
+		m_ownParts(_other.m_ownParts ? std::make_unique<RingParts>(*_other.m_ownParts) : nullptr) {}
+
+	Ring& operator=(const Ring& _other) {
+		if (this == &_other)
+			return *this;
+
+		Object::operator=(_other);
+		ringId = _other.ringId;
+		prefab = _other.prefab;
+		m_sharedParts = _other.m_sharedParts;
+		m_ownParts = _other.m_ownParts ? std::make_unique<RingParts>(*_other.m_ownParts) : nullptr;
+		m_childrenDirty = true;
+		return *this;
 	}
 
 	virtual ~Ring() {}
 
+	// The mesh actor follows on UpdateChildren()
 	void SetLocation(const Vector& _newLocation) override {
 		location = _newLocation;
-		mesh.SetLocation(_newLocation);
-		UpdateTriggerVolumes();
+		m_childrenDirty = true;
 	}
 
 	void SetRotation(const Rotator& _newRotation) override {
 		rotation = _newRotation;
-		mesh.SetRotation(_newRotation);
-		UpdateTriggerVolumes();
-	}
-
-	void UpdateTriggerVolumes() {
-		// Rotate the offsets so they pivot around Ring's origin
-		Vector rotatedOffsetIn = RotateVectorWithQuat(triggerVolumeIn_offset_location, RotatorToQuat(rotation));
-		Vector rotatedOffsetOut = RotateVectorWithQuat(triggerVolumeOut_offset_location, RotatorToQuat(rotation));
-
-		// Compute the final world locations
-		Vector worldLocIn = location + rotatedOffsetIn;
-		Vector worldLocOut = location + rotatedOffsetOut;
-
-		triggerVolumeIn.SetLocation(worldLocIn);
-		triggerVolumeIn.SetRotation(triggerVolumeIn_offset_rotation + rotation);
-
-		triggerVolumeOut.SetLocation(worldLocOut);
-		triggerVolumeOut.SetRotation(triggerVolumeOut_offset_rotation + rotation);
-	}
-
-	void RenderTriggerVolumes(CanvasWrapper canvas, CameraWrapper camera) {
-		triggerVolumeIn.Render(canvas, camera);
-		triggerVolumeOut.Render(canvas, camera);
-	}
-
-    nlohmann::json to_json() const override {
-        return {
-            {"objectType", static_cast<uint8_t>(objectType)},
-            {"name", name},
-            {"location", location},
-            {"rotation", rotation},
-            {"scale", scale},
-            {"ringId", ringId},
-            {"mesh", mesh.to_json()},
-			{"triggerVolumeIn", triggerVolumeIn.to_json()},
-			{"triggerVolumeIn_offset_location", triggerVolumeIn_offset_location},
-			{"triggerVolumeIn_offset_rotation", triggerVolumeIn_offset_rotation},
-            {"triggerVolumeOut", triggerVolumeOut.to_json()},
-			{"triggerVolumeOut_offset_location", triggerVolumeOut_offset_location },
-			{"triggerVolumeOut_offset_rotation", triggerVolumeOut_offset_rotation}
-        };
-    }
-
-	//Would be better if I Clone() for mesh, triggerVolumeIn, triggerVolumeOut. But I would first need to store them as shared_ptr
-    std::shared_ptr<Object> Clone() override {
-        std::shared_ptr<Ring> clonedRing = std::make_shared<Ring>(*this);
-
-		//clonedRing->mesh = *std::static_pointer_cast<Mesh>(clonedRing->mesh.Clone());
-		if (clonedRing->mesh.instance)
+		m_childrenDirty = true;
+	}
+
+	void UpdateChildren() override {
+		if (!m_childrenDirty)
+			return;
+
+		m_childrenDirty = false;
+
+		if (m_meshActor)
 		{
-			clonedRing->mesh.SpawnInstance();
+			m_meshActor->SetLocation(location);
+			m_meshActor->SetRotation(rotation);
 		}
+	}
 
-		clonedRing->triggerVolumeIn.onTouchCallback = (clonedRing->triggerVolumeIn.onTouchCallback ? clonedRing->triggerVolumeIn.onTouchCallback->Clone() : nullptr);
-        clonedRing->triggerVolumeOut.onTouchCallback = (clonedRing->triggerVolumeOut.onTouchCallback ? clonedRing->triggerVolumeOut.onTouchCallback->Clone() : nullptr);
-		clonedRing->UpdateTriggerVolumes();
-        return clonedRing;
-    }
+	const RingParts& GetParts() const {
+		return m_ownParts ? *m_ownParts : *m_sharedParts;
+	}
 
-    int ringId = -1;
-	Mesh mesh;
+	// The shared parts are copied first, the prefab's stay untouched
+	RingParts& EditParts() {
+		if (!m_ownParts)
+			m_ownParts = std::make_unique<RingParts>(*m_sharedParts);
+		return *m_ownParts;
+	}
 
-	TriggerVolume_Cylinder triggerVolumeIn;
-	Vector triggerVolumeIn_offset_location;
-	Rotator triggerVolumeIn_offset_rotation;
+	void SetParts(RingParts _parts) {
+		EditParts() = std::move(_parts);
+	}
 
-	TriggerVolume_Box triggerVolumeOut;
-	Vector triggerVolumeOut_offset_location;
-	Rotator triggerVolumeOut_offset_rotation;
+	// Reads _parts from now on (a prefab's), the ring's own parts are dropped
+	void ShareParts(const std::shared_ptr<const RingParts>& _parts) {
+		m_sharedParts = _parts;
+		m_ownParts = nullptr;
+	}
+
+	const std::shared_ptr<const RingParts>& GetSharedParts() const {
+		return m_sharedParts;
+	}
+
+	bool HasOwnParts() const {
+		return m_ownParts != nullptr;
+	}
+
+	// See RingParts::ClearTransforms(), the shared parts never hold one
+	void ClearPartTransforms() {
+		if (m_ownParts)
+			m_ownParts->ClearTransforms();
+	}
+
+	// The actor is a copy of the parts' mesh, only held while it's spawned
+	bool IsMeshSpawned() const {
+		return m_meshActor != nullptr;
+	}
+
+	AKActor* GetMeshInstance() const {
+		return m_meshActor ? m_meshActor->instance : nullptr;
+	}
+
+	void SpawnMesh() {
+		m_meshActor = std::make_unique<Mesh>(GetParts().mesh);
+		m_meshActor->location = location;
+		m_meshActor->rotation = rotation;
+		m_meshActor->SpawnInstance();
+		if (!m_meshActor->IsSpawned())
+			m_meshActor = nullptr;
+	}
+
+	void DestroyMesh() {
+		m_meshActor = nullptr;
+	}
+
+	// World transforms of the trigger volumes : the offsets pivot around the ring's origin
+	Vector GetTriggerVolumeInLocation() const {
+		return location + RotateVectorWithQuat(GetParts().triggerVolumeIn_offset_location, RotatorToQuat(rotation));
+	}
+
+	Rotator GetTriggerVolumeInRotation() const {
+		return GetParts().triggerVolumeIn_offset_rotation + rotation;
+	}
+
+	Vector GetTriggerVolumeOutLocation() const {
+		return location + RotateVectorWithQuat(GetParts().triggerVolumeOut_offset_location, RotatorToQuat(rotation));
+	}
+
+	Rotator GetTriggerVolumeOutRotation() const {
+		return GetParts().triggerVolumeOut_offset_rotation + rotation;
+	}
+
+	bool IsInTriggerVolumeIn(const Vector& _point) const {
+		return GetParts().triggerVolumeIn.IsPointInside(_point, GetTriggerVolumeInLocation(), GetTriggerVolumeInRotation());
+	}
+
+	bool IsInTriggerVolumeOut(const Vector& _point) const {
+		return GetParts().triggerVolumeOut.IsPointInside(_point, GetTriggerVolumeOutLocation(), GetTriggerVolumeOutRotation());
+	}
+
+	void RenderTriggerVolumes(CanvasWrapper canvas, CameraWrapper camera) const {
+		RT::Frustum frustum(canvas, camera);
+		RenderTriggerVolumes(canvas, frustum);
+	}
+
+	void RenderTriggerVolumes(CanvasWrapper canvas, RT::Frustum& frustum) const {
+		const RingParts& parts = GetParts();
+		parts.triggerVolumeIn.Render(canvas, frustum, GetTriggerVolumeInLocation(), GetTriggerVolumeInRotation());
+		parts.triggerVolumeOut.Render(canvas, frustum, GetTriggerVolumeOutLocation(), GetTriggerVolumeOutRotation());
+	}
+
+	float GetBoundingRadius() const override {
+		const RingParts& parts = GetParts();
+		float radiusIn = parts.triggerVolumeIn_offset_location.magnitude() + parts.triggerVolumeIn.GetBoundingRadius();
+		float radiusOut = parts.triggerVolumeOut_offset_location.magnitude() + parts.triggerVolumeOut.GetBoundingRadius();
+		return max(radiusIn, radiusOut);
+	}
+
+	std::shared_ptr<Object> Clone() override {
+		std::shared_ptr<Ring> clonedRing = MakePooled<Ring>(*this);
+
+		// Callbacks of the shared parts are never edited in place, only the ring's own ones are cloned
+		if (clonedRing->m_ownParts)
+		{
+			clonedRing->m_ownParts->triggerVolumeIn.onTouchCallback = CloneCallback(clonedRing->m_ownParts->triggerVolumeIn.onTouchCallback);
+			clonedRing->m_ownParts->triggerVolumeOut.onTouchCallback = CloneCallback(clonedRing->m_ownParts->triggerVolumeOut.onTouchCallback);
+		}
+
+		if (m_meshActor)
+			clonedRing->SpawnMesh();
+		return clonedRing;
+	}
+
+	int ringId = -1;
+	std::shared_ptr<const RingPrefab> prefab; // template the ring was made from, see PrefabLibrary
+
+private:
+	// Parts of rings that aren't made from a prefab until they're edited, never destroyed like the prefab library
+	static const std::shared_ptr<const RingParts>& GetDefaultParts() {
+		static std::shared_ptr<const RingParts>* parts = new std::shared_ptr<const RingParts>(std::make_shared<RingParts>());
+		return *parts;
+	}
+
+	std::shared_ptr<const RingParts> m_sharedParts;
+	std::unique_ptr<RingParts> m_ownParts;  // sparse override block : only rings whose parts were edited have one
+	std::unique_ptr<Mesh> m_meshActor;      // spawned copy of the parts' mesh, destroying it destroys the actor
+
+protected:
+	bool m_childrenDirty = true; // moved since the mesh actor was last updated
 };
 
 class Ring_Small : public Ring
 {
 public:
 	Ring_Small(int _id) : Ring(_id) {
-		mesh.meshInfos.name = "Ring Small";
-		mesh.meshInfos.meshPath = "ringsmapeditor.prop_ring";
+		RingParts& parts = EditParts();
+		parts.mesh.meshInfos.name = "Ring Small";
+		parts.mesh.meshInfos.meshPath = "ringsmapeditor.prop_ring";
 
-		triggerVolumeIn_offset_location = Vector(0.f, -35.f, 0.f);
-		triggerVolumeIn_offset_rotation = Rotator(0, 0, 16400);
-		triggerVolumeIn.height = 15.f;
-		triggerVolumeIn.radius = 195.f;
+		parts.triggerVolumeIn_offset_location = Vector(0.f, -35.f, 0.f);
+		parts.triggerVolumeIn_offset_rotation = Rotator(0, 0, 16400);
+		parts.triggerVolumeIn.height = 15.f;
+		parts.triggerVolumeIn.radius = 195.f;
 
-		triggerVolumeOut_offset_location = Vector(0.f, -90.f, 0.f);
-		triggerVolumeOut.SetSize(Vector(640.f, 60.f, 640.f));
-
-		UpdateTriggerVolumes();
+		parts.triggerVolumeOut_offset_location = Vector(0.f, -90.f, 0.f);
+		parts.triggerVolumeOut.SetSize(Vector(640.f, 60.f, 640.f));
 	}
 	~Ring_Small() {}
 
 private:
 
-};
\ No newline at end of file
+};
@@ -1,8 +1,33 @@
 #include "pch.h"
 #include "RingsMapEditor.h"
 
+#include <charconv>
+#include <chrono>
 #include <fstream>
 
+namespace
+{
+	//Reads the numbers in _args from _first on into _out, false if one is missing or isn't a number
+	template <typename T>
+	bool ParseArgs(const std::vector<std::string>& _args, size_t _first, std::initializer_list<T*> _out)
+	{
+		if (_args.size() < _first + _out.size())
+			return false;
+
+		size_t i = _first;
+		for (T* value : _out)
+		{
+			const std::string& arg = _args[i++];
+			auto [end, error] = std::from_chars(arg.data(), arg.data() + arg.size(), *value);
+			if (error != std::errc() || end != arg.data() + arg.size())
+				return false;
+		}
+		return true;
+	}
+}
+
+
+
 BAKKESMOD_PLUGIN(RingsMapEditor, "RingsMapEditor", plugin_version, PLUGINTYPE_FREEPLAY)
 
 std::shared_ptr<CVarManagerWrapper> _globalCvarManager;
@@ -20,6 +45,12 @@ void RingsMapEditor::onLoad()
 	objectManager = std::make_shared<ObjectManager>();
 	buildMode = std::make_shared<BuildMode>(objectManager, AvailableMeshes);
 	editMode = std::make_shared<EditMode>(objectManager);
+	overlayRenderer = std::make_shared<OverlayRenderer>(objectManager);
+	mapSaver = std::make_shared<AsyncMapSaver>();
+	InitEditJournal();
+	coursePath = std::make_shared<CoursePath>();
+	labelLayer = std::make_shared<LabelLayer>(objectManager);
+	coursePathAnimationTimer.Start();
 
 	//cvarManager->registerNotifier("my_aweseome_notifier", [&](std::vector<std::string> args) {
 	//	LOG("Hello notifier!");
@@ -37,6 +68,77 @@ void RingsMapEditor::onLoad()
 		editMode->Toggle();
 		}, "", 0);
 
+	_globalCvarManager->registerNotifier("ringsmapeditor_convert_map", [&](std::vector<std::string> args) {
+		if (args.size() < 2)
+		{
+			LOG("[ERROR]Usage: ringsmapeditor_convert_map <file name with .json or .rme extension>");
+			return;
+		}
+		ConvertMap(DataFolderPath / args[1]);
+		}, "Convert a saved map between JSON and binary .rme", 0);
+
+	_globalCvarManager->registerNotifier("ringsmapeditor_rescan_meshes", [&](std::vector<std::string> args) {
+		RescanMeshes();
+		}, "Parse every mesh config again instead of trusting the mesh index", 0);
+
+	_globalCvarManager->registerNotifier("ringsmapeditor_recover_autosave", [&](std::vector<std::string> args) {
+		RecoverAutosave();
+		}, "Reload the scene from the previous session's autosave journal", 0);
+
+	_globalCvarManager->registerNotifier("ringsmapeditor_undo", [&](std::vector<std::string> args) {
+		objectManager->Undo();
+		}, "Undo the last change made to the scene", 0);
+
+	_globalCvarManager->registerNotifier("ringsmapeditor_redo", [&](std::vector<std::string> args) {
+		objectManager->Redo();
+		}, "Redo the last undone change", 0);
+
+	//Group transforms act on every object whose name contains the first argument, "" for every object
+	_globalCvarManager->registerNotifier("ringsmapeditor_group_move", [&](std::vector<std::string> args) {
+		GroupTransform transform;
+		if (!ParseArgs<float>(args, 2, { &transform.translation.X, &transform.translation.Y, &transform.translation.Z }))
+		{
+			LOG("[ERROR]Usage: ringsmapeditor_group_move <name> <x> <y> <z>");
+			return;
+		}
+		TransformNamedObjects(args[1], transform);
+		}, "Move every object whose name contains the given text", 0);
+
+	_globalCvarManager->registerNotifier("ringsmapeditor_group_rotate", [&](std::vector<std::string> args) {
+		GroupTransform transform;
+		if (!ParseArgs<int>(args, 2, { &transform.rotation.Pitch, &transform.rotation.Yaw, &transform.rotation.Roll }))
+		{
+			LOG("[ERROR]Usage: ringsmapeditor_group_rotate <name> <pitch> <yaw> <roll>");
+			return;
+		}
+		TransformNamedObjects(args[1], transform);
+		}, "Rotate every object whose name contains the given text about their center", 0);
+
+	_globalCvarManager->registerNotifier("ringsmapeditor_group_scale", [&](std::vector<std::string> args) {
+		GroupTransform transform;
+		if (!ParseArgs<float>(args, 2, { &transform.scale }))
+		{
+			LOG("[ERROR]Usage: ringsmapeditor_group_scale <name> <factor>");
+			return;
+		}
+		TransformNamedObjects(args[1], transform);
+		}, "Scale every object whose name contains the given text about their center", 0);
+
+	_globalCvarManager->registerCvar("ringsmapeditor_undo_memory", std::to_string(objectManager->GetUndoStack().GetMemoryCap() / (1024 * 1024)), "Memory in MB the undo history can use before its oldest changes are dropped", true, true, 1.f, true, 1024.f)
+		.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+			objectManager->GetUndoStack().SetMemoryCap(static_cast<size_t>(cvar.getIntValue()) * 1024 * 1024);
+			});
+
+	_globalCvarManager->registerCvar("ringsmapeditor_overlay_budget", std::to_string(overlayRenderer->GetBudget()), "Max number of objects drawn with full wireframes per frame in editor mode", true, true, 0.f, true, 4096.f)
+		.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+			overlayRenderer->SetBudget(cvar.getIntValue());
+			});
+
+	_globalCvarManager->registerCvar("ringsmapeditor_reuse_ids", "0", "Give new checkpoints and rings the lowest free id instead of one past the highest", true, true, 0.f, true, 1.f)
+		.addOnValueChanged([this](std::string oldValue, CVarWrapper cvar) {
+			objectManager->SetReuseFreedIds(cvar.getBoolValue());
+			});
+
 	gameWrapper->HookEventPost("Function TAGame.GameEvent_TA.PostBeginPlay", std::bind(&RingsMapEditor::OnGameCreated, this, std::placeholders::_1));
 	gameWrapper->HookEvent("Function TAGame.GameEvent_Soccar_TA.Destroyed", std::bind(&RingsMapEditor::OnGameDestroyed, this, std::placeholders::_1));
 
@@ -73,7 +175,7 @@ void RingsMapEditor::InitPaths()
 	}
 }
 
-bool RingsMapEditor::SaveConfig(const std::string& fileName)
+bool RingsMapEditor::SaveConfig(const std::string& fileName, MapFileFormat format)
 {
 	if (fileName.empty())
 	{
@@ -81,70 +183,153 @@ bool RingsMapEditor::SaveConfig(const std::string& fileName)
 		return false;
 	}
 
-	try
-	{
-		nlohmann::json objects_json = nlohmann::json::array();
-		for (const std::shared_ptr<Object>& object : objectManager->GetObjects()) {
-			if (object)
-			{
-				objects_json.push_back(object->to_json());
-			}
-		}
+	std::string extension = (format == MapFileFormat::Binary) ? RmeExtension : ".json";
 
-		std::filesystem::path filePath = DataFolderPath / std::string(fileName + ".json");
-		std::ofstream file = std::ofstream(filePath);
-		file << objects_json.dump(4);
+	MapSaveRequest request;
+	request.filePath = DataFolderPath / std::string(fileName + extension);
+	request.format = format;
+	request.prettyJson = !compactJson;
+	// The published snapshot is read without copying or locking the scene, whatever thread the save starts from
+	std::shared_ptr<const SceneSnapshot> snapshot = objectManager->GetSnapshot();
+	snapshot->GetObjects(request.snapshot);
+	snapshot->GetParents(request.parents);
 
-		LOG("Saved config successfully to: {}", filePath.string());
-		return true;
-	}
-	catch (const std::exception& e)
+	LOG("Saving {} objects to: {}", request.snapshot.size(), request.filePath.string());
+	mapSaver->Save(std::move(request));
+	return true;
+}
+
+void RingsMapEditor::PollSaveResults()
+{
+	MapSaveResult result;
+	while (mapSaver->PollResult(result))
 	{
-		LOG("[ERROR]Failed to save config: {}", e.what());
+		if (result.success)
+		{
+			LOG("Saved config successfully to: {} ({} objects, {:.1f} ms)", result.filePath.string(), result.objectCount, result.durationMs);
+			saveStatus = std::format("Saved {}", result.filePath.filename().string());
+		}
+		else
+		{
+			LOG("[ERROR]Failed to save config: {}", result.filePath.string());
+			saveStatus = std::format("Failed to save {}", result.filePath.filename().string());
+		}
 	}
 }
 
 void RingsMapEditor::LoadConfig(const std::filesystem::path& filePath)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::shared_ptr<Object>> loadedObjects;
+	MapExtras extras;
+	if (!ReadMapFile(filePath, loadedObjects, extras))
+		return;
+
+	double durationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// Parsing doesn't touch the game, only the scene swap runs on the game thread
+	gameWrapper->Execute([this, filePath, durationMs, loadedObjects = std::move(loadedObjects), extras = std::move(extras)](GameWrapper* gw) {
+		if (!reconcileOnLoad)
+		{
+			objectManager->LoadObjects(loadedObjects, extras);
+			selectedObject = ObjectHandle();
+			LOG("Loaded config successfully from: {} ({} objects, parsed in {:.1f} ms)", filePath.string(), loadedObjects.size(), durationMs);
+			return;
+		}
+
+		std::shared_ptr<Object> previousSelection = objectManager->FindObject(selectedObject);
+
+		ReconcileStats stats = objectManager->ReconcileObjects(loadedObjects, extras);
+
+		// The scene is rebuilt so every handle changes, the selection follows its object when it was kept or updated
+		selectedObject = previousSelection ? objectManager->GetHandle(previousSelection.get()) : ObjectHandle();
+
+		LOG("Loaded config successfully from: {} ({} objects, parsed in {:.1f} ms, {} kept, {} updated, {} added, {} removed)",
+			filePath.string(), loadedObjects.size(), durationMs, stats.kept, stats.updated, stats.added, stats.removed);
+		});
+}
+
+bool RingsMapEditor::ReadMapFile(const std::filesystem::path& filePath, std::vector<std::shared_ptr<Object>>& outObjects, MapExtras& outExtras)
 {
 	if (!std::filesystem::exists(filePath))
 	{
 		LOG("[ERROR]Config file does not exist: {}", filePath.string());
-		return;
+		return false;
 	}
 
-	std::ifstream file = std::ifstream(filePath);
-	if (!file.is_open())
-	{
-		LOG("[ERROR]Could not open config file: {}", filePath.string());
-		return;
-	}
+	if (BinaryMap::IsBinaryMap(filePath))
+		return BinaryMap::Load(filePath, objectManager->GetTriggerFunctionsMap(), outObjects, outExtras);
 
-	objectManager->ClearObjects();
+	return JsonMapReader::Load(filePath, objectManager->GetTriggerFunctionsMap(), outObjects, outExtras);
+}
 
-	try
-	{
-		nlohmann::json arr;
-		file >> arr;
-		
-		for (const auto& item : arr)
-		{
-			std::shared_ptr<Object> loadedObject = FromJson_Object(item);
-			if (!loadedObject)
-			{
-				LOG("[ERROR]Couldn't load object : {}", item.dump(4));
-				continue;
-			}
+bool RingsMapEditor::WriteMapFile(const std::filesystem::path& filePath, const std::vector<std::shared_ptr<Object>>& objects, const std::vector<int32_t>& parents, MapFileFormat format)
+{
+	if (format == MapFileFormat::Binary)
+		return BinaryMap::Save(filePath, objects, parents);
 
-			LOG("loaded object : {}", loadedObject->name);
-			objectManager->AddObject(loadedObject);
-		}
+	return JsonMapWriter::Save(filePath, objects, parents, !compactJson);
+}
+
+//Converts a map between JSON and .rme, the result is written next to the source with the other extension
+bool RingsMapEditor::ConvertMap(const std::filesystem::path& filePath)
+{
+	std::vector<std::shared_ptr<Object>> objects;
+	MapExtras extras;
+	if (!ReadMapFile(filePath, objects, extras))
+		return false;
+
+	MapFileFormat targetFormat = BinaryMap::IsBinaryMap(filePath) ? MapFileFormat::Json : MapFileFormat::Binary;
+	std::filesystem::path targetPath = filePath;
+	targetPath.replace_extension(targetFormat == MapFileFormat::Binary ? RmeExtension : ".json");
 
-		LOG("Loaded config successfully from: {}", filePath.string());
+	if (!WriteMapFile(targetPath, objects, extras.parents, targetFormat))
+		return false;
+
+	LOG("Converted {} ({} objects) to {}", filePath.string(), objects.size(), targetPath.string());
+	return true;
+}
+
+void RingsMapEditor::InitEditJournal()
+{
+	std::filesystem::path autosavePath = GetAutosavePath();
+	if (std::filesystem::exists(autosavePath))
+	{
+		std::error_code error;
+		std::filesystem::rename(autosavePath, GetAutosavePath(true), error);
+		if (error)
+			LOG("[ERROR]Could not keep the previous autosave journal: {}", error.message());
+		else
+			canRecoverAutosave = true;
 	}
-	catch (const nlohmann::json::exception& e)
+
+	editJournal = std::make_shared<EditJournal>(autosavePath);
+	objectManager->SetJournal(editJournal);
+}
+
+bool RingsMapEditor::RecoverAutosave()
+{
+	std::filesystem::path previousPath = GetAutosavePath(true);
+	if (!std::filesystem::exists(previousPath))
 	{
-		LOG("[ERROR]Failed to parse config: {}", e.what());
+		LOG("[ERROR]No autosave journal to recover: {}", previousPath.string());
+		return false;
 	}
+
+	std::vector<std::shared_ptr<Object>> recoveredObjects;
+	MapExtras extras;
+	if (!EditJournal::Recover(previousPath, objectManager->GetTriggerFunctionsMap(), recoveredObjects, extras))
+		return false;
+
+	objectManager->LoadObjects(recoveredObjects, extras);
+	selectedObject = ObjectHandle();
+	return true;
+}
+
+std::filesystem::path RingsMapEditor::GetAutosavePath(bool previousSession)
+{
+	return DataFolderPath / (std::string(previousSession ? "autosave.previous" : "autosave") + RmjExtension);
 }
 
 bool RingsMapEditor::IsInEditorMode()
@@ -205,7 +390,7 @@ void RingsMapEditor::OnGameFirstTick(std::string eventName)
 				}
 				else if (object->objectType == ObjectType::Ring)
 				{
-					std::static_pointer_cast<Ring>(object)->mesh.SpawnInstance();
+					std::static_pointer_cast<Ring>(object)->SpawnMesh();
 				}
 			}
 		}, 0.1f);
@@ -224,7 +409,8 @@ void RingsMapEditor::OnCarSpawn(CarWrapper caller, void* params, std::string eve
 	if (!isStartingRace)
 		return;
 
-	if (checkpoints.empty())
+	std::shared_ptr<Checkpoint> startCheckpoint = objectManager->FindStartCheckpoint();
+	if (!startCheckpoint)
 	{
 		LOG("[ERROR]No checkpoints set!");
 		return;
@@ -232,7 +418,7 @@ void RingsMapEditor::OnCarSpawn(CarWrapper caller, void* params, std::string eve
 
 	if (isStartingRace)
 	{
-		caller.SetLocation(checkpoints[0]->GetSpawnWorldLocation());
+		caller.SetLocation(startCheckpoint->GetSpawnWorldLocation());
 		isStartingRace = false;
 	}
 }
@@ -274,11 +460,11 @@ void RingsMapEditor::SelectLastObject()
 
 	if (!objects.empty())
 	{
-		selectedObjectIndex = objects.size() - 1;
+		selectedObject = objectManager->GetHandle(objects.size() - 1);
 	}
 	else
 	{
-		selectedObjectIndex = -1;
+		selectedObject = ObjectHandle();
 	}
 }
 
@@ -294,11 +480,21 @@ void RingsMapEditor::CheckTriggerVolumes()
 		return;
 	}
 
-	for (std::shared_ptr<TriggerVolume>& volume : objectManager->GetTriggerVolumes())
+	//Only the volumes whose bounding sphere holds the car run their exact test
+	Vector carLocation = localCar.GetLocation();
+	const TransformStore& transforms = objectManager->GetTransforms();
+	transforms.FindContaining(carLocation, nearbyRows);
+
+	std::vector<std::shared_ptr<Object>>& objects = objectManager->GetObjects();
+	for (uint32_t row : nearbyRows)
 	{
-		if (volume->IsPointInside(localCar.GetLocation()))
+		if (transforms.GetObjectType(row) != ObjectType::TriggerVolume)
+			continue;
+
+		TriggerVolume& volume = static_cast<TriggerVolume&>(*objects[row]);
+		if (volume.IsPointInside(carLocation))
 		{
-			volume->OnTouch(localCar);
+			volume.OnTouch(localCar);
 		}
 	}
 }
@@ -315,9 +511,19 @@ void RingsMapEditor::CheckCheckpoints()
 		return;
 	}
 
-	for (std::shared_ptr<Checkpoint>& checkpoint : checkpoints)
+	//The checkpoint bounding sphere holds its trigger volume
+	Vector carLocation = localCar.GetLocation();
+	const TransformStore& transforms = objectManager->GetTransforms();
+	transforms.FindContaining(carLocation, nearbyRows);
+
+	std::vector<std::shared_ptr<Object>>& objects = objectManager->GetObjects();
+	for (uint32_t row : nearbyRows)
 	{
-		if (checkpoint->triggerVolume.IsPointInside(localCar.GetLocation()))
+		if (transforms.GetObjectType(row) != ObjectType::Checkpoint)
+			continue;
+
+		std::shared_ptr<Checkpoint> checkpoint = std::static_pointer_cast<Checkpoint>(objects[row]);
+		if (checkpoint->triggerVolume.IsPointInside(carLocation))
 		{
 			if (SetCurrentCheckpoint(checkpoint))
 			{
@@ -348,17 +554,28 @@ void RingsMapEditor::CheckRings()
 		return;
 	}
 
-	for (std::shared_ptr<Ring>& ring : objectManager->GetRings())
+	//The ring bounding sphere holds both of its trigger volumes
+	Vector carLocation = localCar.GetLocation();
+	const TransformStore& transforms = objectManager->GetTransforms();
+	transforms.FindContaining(carLocation, nearbyRows);
+
+	std::vector<std::shared_ptr<Object>>& objects = objectManager->GetObjects();
+	for (uint32_t row : nearbyRows)
 	{
+		if (transforms.GetObjectType(row) != ObjectType::Ring)
+			continue;
+
+		Ring* ring = static_cast<Ring*>(objects[row].get());
+
 		//Car pass through the ring
-		if (ring->triggerVolumeIn.IsPointInside(localCar.GetLocation()))
+		if (ring->IsInTriggerVolumeIn(carLocation))
 		{
 			currentRingId = ring->ringId;
 			LOG("current ring : {}", currentRingId);
 		}
 
 		//Car pass behind the ring, checking if the car didn't pass through the ring
-		if (ring->triggerVolumeOut.IsPointInside(localCar.GetLocation()))
+		if (ring->IsInTriggerVolumeOut(carLocation))
 		{
 			if (currentRingId != ring->ringId)
 			{
@@ -371,6 +588,10 @@ void RingsMapEditor::CheckRings()
 
 void RingsMapEditor::OnTick(ActorWrapper caller, void* params, std::string eventName)
 {
+	objectManager->UpdateTransforms();
+	objectManager->PublishSnapshot();
+	objectManager->UpdateJournal();
+
 	if (!IsInGame())
 		return;
 
@@ -393,7 +614,7 @@ void RingsMapEditor::OnTick(ActorWrapper caller, void* params, std::string event
 	}
 }
 
-void RingsMapEditor::RenderTriggerVolumes(CanvasWrapper canvas)
+void RingsMapEditor::RenderOverlays(CanvasWrapper canvas)
 {
 	if (!IsInEditorMode())
 		return;
@@ -401,27 +622,25 @@ void RingsMapEditor::RenderTriggerVolumes(CanvasWrapper canvas)
 	CameraWrapper camera = gameWrapper->GetCamera();
 	if (!camera) return;
 
-	for (std::shared_ptr<TriggerVolume>& volume : objectManager->GetTriggerVolumes())
-	{
-		volume->Render(canvas, camera);
-	}
+	overlayRenderer->Render(canvas, camera);
+	overlayRenderer->RenderStats(canvas, Vector2{ 20, 50 });
 }
 
-void RingsMapEditor::RenderCheckpoints(CanvasWrapper canvas)
+void RingsMapEditor::RenderCoursePath(CanvasWrapper canvas)
 {
-	if (!IsInEditorMode())
+	if (!coursePath->IsEnabled())
 		return;
 
 	CameraWrapper camera = gameWrapper->GetCamera();
 	if (!camera) return;
 
-	for (std::shared_ptr<Checkpoint>& checkpoint : checkpoints)
-	{
-		checkpoint->Render(canvas, camera);
-	}
+	coursePath->Update(objectManager->GetRings());
+
+	RT::Frustum frustum(canvas, camera);
+	coursePath->Render(canvas, frustum, static_cast<float>(coursePathAnimationTimer.GetElapsedSeconds()));
 }
 
-void RingsMapEditor::RenderRings(CanvasWrapper canvas)
+void RingsMapEditor::RenderLabels(CanvasWrapper canvas)
 {
 	if (!IsInEditorMode())
 		return;
@@ -429,10 +648,9 @@ void RingsMapEditor::RenderRings(CanvasWrapper canvas)
 	CameraWrapper camera = gameWrapper->GetCamera();
 	if (!camera) return;
 
-	for (std::shared_ptr<Ring>& ring : objectManager->GetRings())
-	{
-		ring->RenderTriggerVolumes(canvas, camera);
-	}
+	std::shared_ptr<Object> object = objectManager->FindObject(selectedObject);
+
+	labelLayer->Render(canvas, camera, object.get());
 }
 
 void RingsMapEditor::RenderTimer(CanvasWrapper canvas)
@@ -443,14 +661,20 @@ void RingsMapEditor::RenderTimer(CanvasWrapper canvas)
 	CameraWrapper camera = gameWrapper->GetCamera();
 	if (!camera) return;
 
-	if (currentCheckpoint && currentCheckpoint->IsEndCheckpoint())
-		canvas.SetColor(255, 0, 0, 255); // Red color for end checkpoint
-	else
-		canvas.SetColor(0, 255, 0, 255); // Green color for active checkpoints
+	bool isOnEndCheckpoint = currentCheckpoint && currentCheckpoint->IsEndCheckpoint();
+	uint64_t elapsedMilliseconds = static_cast<uint64_t>(raceTimer.GetElapsedSeconds() * 1000.0);
 
-	canvas.SetPosition(Vector2{ 20, 50 });
-	std::string timerText = "Time: " + std::to_string(raceTimer.GetElapsedSeconds()) + " seconds";
-	canvas.DrawString(timerText, 2.f, 2.f);
+	if (raceTimerHud.Update(HudText::Combine(elapsedMilliseconds, isOnEndCheckpoint)))
+	{
+		if (isOnEndCheckpoint)
+			raceTimerHud.SetColor(255, 0, 0, 255); // Red color for end checkpoint
+		else
+			raceTimerHud.SetColor(0, 255, 0, 255); // Green color for active checkpoints
+
+		raceTimerHud.SetLine(0, "Time: {:.3f} seconds", elapsedMilliseconds / 1000.0);
+	}
+
+	raceTimerHud.Render(canvas);
 }
 
 void RingsMapEditor::RenderCanvas(CanvasWrapper canvas)
@@ -460,9 +684,9 @@ void RingsMapEditor::RenderCanvas(CanvasWrapper canvas)
 
 	if (IsInEditorMode())
 	{
-		RenderTriggerVolumes(canvas);
-		RenderCheckpoints(canvas);
-		RenderRings(canvas);
+		RenderOverlays(canvas);
+		RenderCoursePath(canvas);
+		RenderLabels(canvas);
 
 		if (buildMode->IsEnabled())
 		{
@@ -475,6 +699,7 @@ void RingsMapEditor::RenderCanvas(CanvasWrapper canvas)
 	}
 	else if (IsInRaceMode())
 	{
+		RenderCoursePath(canvas);
 		RenderTimer(canvas);
 	}
 }
@@ -483,155 +708,32 @@ void RingsMapEditor::RenderCanvas(CanvasWrapper canvas)
 
 std::vector<MeshInfos> RingsMapEditor::GetAvailableMeshes()
 {
-	std::vector<MeshInfos> availableMeshes;
-
-	for (const auto& entry : std::filesystem::directory_iterator(MeshesPath))
-	{
-		if (entry.path().extension() == ".json")
-		{
-			std::ifstream file = std::ifstream(entry.path());
-			if (!file.is_open())
-			{
-				LOG("[ERROR]Could not open mesh config file: {}", entry.path().string());
-				continue;
-			}
-
-			try
-			{
-				nlohmann::json meshInfos_json = nlohmann::json::parse(file);
-				MeshInfos meshInfos = meshInfos_json.get<MeshInfos>();
-				availableMeshes.push_back(meshInfos);
-			}
-			catch (const nlohmann::json::exception& e)
-			{
-				LOG("[ERROR]Failed to parse mesh config file: {}", e.what());
-			}
-		}
-	}
-
-	LOG("Found {} available meshes in {}", availableMeshes.size(), MeshesPath.string());
+	if (!meshCatalogue)
+		meshCatalogue = std::make_shared<MeshCatalogue>(MeshesPath, DataFolderPath / "meshes.index");
 
-	return availableMeshes;
+	return meshCatalogue->Scan();
 }
 
-std::shared_ptr<Object> RingsMapEditor::FromJson_Object(const nlohmann::json& j)
+void RingsMapEditor::RescanMeshes()
 {
-	std::shared_ptr<Object> object = nullptr;
-	ObjectType objectType = static_cast<ObjectType>(j.at("objectType").get<uint8_t>());
+	std::vector<MeshInfos> meshes = meshCatalogue->Scan(true);
+	buildMode->SetAvailableMeshes(meshes);
 
-	if (objectType == ObjectType::Mesh)
-		object = FromJson_Mesh(j);
-	else if (objectType == ObjectType::TriggerVolume)
-		object = FromJson_TriggerVolume(j);
-	else if (objectType == ObjectType::Checkpoint)
-		object = FromJson_Checkpoint(j);
-	else if (objectType == ObjectType::Ring)
-		object = FromJson_Ring(j);
-	else
-	{
-		LOG("[ERROR]Unknown object type: {}", std::to_string(static_cast<uint8_t>(objectType)));
-		return nullptr;
-	}
-
-	if (object)
-	{
-		object->objectType = static_cast<ObjectType>(j.at("objectType").get<uint8_t>());
-		object->name = j.at("name").get<std::string>();
-		object->location = j.at("location").get<Vector>();
-		object->rotation = j.at("rotation").get<Rotator>();
-		object->scale = j.at("scale").get<float>();
-	}
-
-	return object;
-}
-
-std::shared_ptr<Mesh> RingsMapEditor::FromJson_Mesh(const nlohmann::json& j)
-{
-	std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
-
-	mesh->meshInfos = j.at("meshInfos").get<MeshInfos>();
-	mesh->enableCollisions = j.at("enableCollisions").get<bool>();
-	mesh->enablePhysics = j.at("enablePhysics").get<bool>();
-	mesh->enableStickyWalls = j.at("enableStickyWalls").get<bool>();
-
-	return mesh;
-}
-
-std::shared_ptr<TriggerVolume> RingsMapEditor::FromJson_TriggerVolume(const nlohmann::json& j)
-{
-	std::shared_ptr<TriggerVolume> triggerVolume = nullptr;
-	TriggerVolumeType triggerVolumeType = static_cast<TriggerVolumeType>(j.at("triggerVolumeType").get<uint8_t>());
-
-	if (triggerVolumeType == TriggerVolumeType::Box)
-		triggerVolume = FromJson_TriggerVolume_Box(j);
-	else if (triggerVolumeType == TriggerVolumeType::Cylinder)
-		triggerVolume = FromJson_TriggerVolume_Cylinder(j);
-	else
-		throw std::runtime_error("Unknown trigger volume type: " + std::to_string(static_cast<uint8_t>(triggerVolumeType)));
-
-	if (triggerVolume)
-	{
-		triggerVolume->triggerVolumeType = static_cast<TriggerVolumeType>(j.at("triggerVolumeType").get<uint8_t>());
-
-		if (j.contains("onTouchCallback") && !j["onTouchCallback"].is_null())
-		{
-			if (j["onTouchCallback"].is_object())
-			{
-				std::string touchCallBackName = j["onTouchCallback"]["name"].get<std::string>();
-				triggerVolume->SetOnTouchCallback(objectManager->GetTriggerFunctionsMap()[touchCallBackName]->CloneFromJson(j["onTouchCallback"]));
-			}
-		}
-	}
-
-	return triggerVolume;
-}
-
-std::shared_ptr<TriggerVolume_Box> RingsMapEditor::FromJson_TriggerVolume_Box(const nlohmann::json& j)
-{
-	std::shared_ptr<TriggerVolume_Box> triggerVolumeBox = std::make_shared<TriggerVolume_Box>();
-
-	triggerVolumeBox->size = j.at("size").get<Vector>();
-
-	return triggerVolumeBox;
-}
-
-std::shared_ptr<TriggerVolume_Cylinder> RingsMapEditor::FromJson_TriggerVolume_Cylinder(const nlohmann::json& j)
-{
-	std::shared_ptr<TriggerVolume_Cylinder> triggerVolumeCylinder = std::make_shared<TriggerVolume_Cylinder>();
-
-	triggerVolumeCylinder->radius = j.at("radius").get<float>();
-	triggerVolumeCylinder->height = j.at("height").get<float>();
-
-	return triggerVolumeCylinder;
-}
-
-std::shared_ptr<Checkpoint> RingsMapEditor::FromJson_Checkpoint(const nlohmann::json& j)
-{
-	std::shared_ptr<Checkpoint> checkpoint = std::make_shared<Checkpoint>();
-
-	checkpoint->checkpointId = j.at("checkpointId").get<int>();
-	checkpoint->checkpointType = static_cast<CheckpointType>(j.at("checkpointType").get<uint8_t>());
-	checkpoint->triggerVolume = *static_pointer_cast<TriggerVolume_Box>(FromJson_Object(j["triggerVolume"]));
-	checkpoint->spawnLocation_offset = j.at("spawnLocation_offset").get<Vector>();
-	checkpoint->spawnRotation = j.at("spawnRotation").get<Rotator>();
-
-	return checkpoint;
+	//The ImGui thread may be iterating AvailableMeshes right now, it picks the new list up on its next frame
+	std::lock_guard<std::mutex> lock(rescannedMeshesMutex);
+	rescannedMeshes = std::move(meshes);
+	hasRescannedMeshes = true;
 }
 
-std::shared_ptr<Ring> RingsMapEditor::FromJson_Ring(const nlohmann::json& j)
+void RingsMapEditor::PollRescannedMeshes()
 {
-	LOG("creating ring");
-	std::shared_ptr<Ring> ring = std::make_shared<Ring>();
-	LOG("ring created");
-
-	ring->ringId = j.at("ringId").get<int>();
-	ring->mesh = *static_pointer_cast<Mesh>(FromJson_Object(j["mesh"]));
-	ring->triggerVolumeIn = *static_pointer_cast<TriggerVolume_Cylinder>(FromJson_Object(j["triggerVolumeIn"]));
-	ring->triggerVolumeOut = *static_pointer_cast<TriggerVolume_Box>(FromJson_Object(j["triggerVolumeOut"]));
-
-	LOG("triggervolumes created");
+	std::lock_guard<std::mutex> lock(rescannedMeshesMutex);
+	if (!hasRescannedMeshes)
+		return;
 
-	return ring;
+	AvailableMeshes = std::move(rescannedMeshes);
+	rescannedMeshes.clear();
+	hasRescannedMeshes = false;
 }
 
 void RingsMapEditor::DestroyAllMeshes()
@@ -648,15 +750,28 @@ void RingsMapEditor::AddObject(ObjectType _objectType)
 	SelectLastObject();
 }
 
-void RingsMapEditor::RemoveObject(const int& _objectIndex)
+void RingsMapEditor::RemoveObject(ObjectHandle _handle)
 {
-	objectManager->RemoveObject(_objectIndex);
+	int objectIndex = objectManager->GetObjectIndex(_handle);
+	objectManager->RemoveObject(_handle);
 
-	if (selectedObjectIndex == _objectIndex)
-		selectedObjectIndex--;
+	// Removing another object leaves the selection on the same object
+	if (selectedObject != _handle)
+		return;
+
+	if (objectIndex > 0)
+		selectedObject = objectManager->GetHandle(objectIndex - 1);
+	else
+		selectedObject = objectManager->GetHandle(0); // Select the first object if available
+}
+
+void RingsMapEditor::TransformNamedObjects(const std::string& _nameQuery, const GroupTransform& _transform)
+{
+	std::vector<ObjectHandle> handles;
+	objectManager->FindObjects(_nameQuery, NameMatch::Substring, AllObjectTypes, handles);
 
-	if (selectedObjectIndex < 0 && !objectManager->GetObjects().empty())
-		selectedObjectIndex = 0; // Select the first object if available
+	size_t movedCount = objectManager->TransformObjects(handles, _transform);
+	LOG("{} objects transformed", movedCount);
 }
 
 bool RingsMapEditor::IsInGame()
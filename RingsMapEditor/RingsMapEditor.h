@@ -13,6 +13,17 @@ constexpr auto plugin_version = stringify(VERSION_MAJOR) "." stringify(VERSION_M
 #include "Timer.h"
 #include "BuildMode.h"
 #include "EditMode.h"
+#include "OverlayRenderer.h"
+#include "CoursePath.h"
+#include "LabelLayer.h"
+#include "BinaryMap.h"
+#include "JsonMapReader.h"
+#include "JsonMapWriter.h"
+#include "AsyncMapSaver.h"
+#include "EditJournal.h"
+#include "MeshCatalogue.h"
+
+#include <mutex>
 
 enum Mode : uint8_t
 {
@@ -29,8 +40,21 @@ class RingsMapEditor: public BakkesMod::Plugin::BakkesModPlugin
     std::filesystem::path MeshesPath;
     void InitPaths();
 
-    bool SaveConfig(const std::string& fileName);
+    bool SaveConfig(const std::string& fileName, MapFileFormat format = MapFileFormat::Json);
     void LoadConfig(const std::filesystem::path& filePath);
+    bool ReadMapFile(const std::filesystem::path& filePath, std::vector<std::shared_ptr<Object>>& outObjects, MapExtras& outExtras);
+    bool WriteMapFile(const std::filesystem::path& filePath, const std::vector<std::shared_ptr<Object>>& objects, const std::vector<int32_t>& parents, MapFileFormat format);
+    bool ConvertMap(const std::filesystem::path& filePath);
+    bool compactJson = false;
+    bool reconcileOnLoad = true; // keep the objects a loaded map shares with the scene instead of rebuilding everything
+    void PollSaveResults();
+    std::string saveStatus;
+
+    //Autosave journal, the previous session's journal is kept aside until it's recovered or overwritten by the next launch
+    void InitEditJournal();
+    bool RecoverAutosave();
+    std::filesystem::path GetAutosavePath(bool previousSession = false);
+    bool canRecoverAutosave = false;
 
 	Mode currentMode = Mode::Editor;
     bool IsInEditorMode();
@@ -41,12 +65,27 @@ class RingsMapEditor: public BakkesMod::Plugin::BakkesModPlugin
     std::shared_ptr<ObjectManager> objectManager;
     std::shared_ptr<BuildMode> buildMode;
     std::shared_ptr<EditMode> editMode;
+    std::shared_ptr<OverlayRenderer> overlayRenderer;
+    std::shared_ptr<AsyncMapSaver> mapSaver;
+    std::shared_ptr<EditJournal> editJournal;
+    ObjectEdit propertiesEdit;
+    void CommitPropertiesEdit();
+    std::shared_ptr<CoursePath> coursePath;
+    std::shared_ptr<LabelLayer> labelLayer;
+    Timer coursePathAnimationTimer;
 
     Timer raceTimer;
+    HudText raceTimerHud = HudText(Vector2{ 20, 50 }, 2.f, 1);
     bool isStartingRace = false;
 
     int currentRingId = -1;
-    int selectedObjectIndex = -1;
+    std::vector<uint32_t> nearbyRows; // reused by the race checks every tick
+    ObjectHandle selectedObject;
+    std::string objectSearch;
+    int objectSearchType = 0; // 0 for every type, an ObjectType otherwise
+    bool objectSearchPrefix = false;
+    std::vector<ObjectHandle> objectSearchResults;
+    GroupTransform groupTransform; // values of the group transform popup, kept between uses
 
     void OnGameCreated(std::string eventName);
     void OnGameFirstTick(std::string eventName);
@@ -58,16 +97,14 @@ class RingsMapEditor: public BakkesMod::Plugin::BakkesModPlugin
 
 	void SelectLastObject();
 
-    std::vector<MeshInfos> AvailableMeshes;
+    std::vector<MeshInfos> AvailableMeshes; // iterated by the ImGui mesh combos, only replaced from the render thread
+    std::vector<MeshInfos> rescannedMeshes; // scanned on the game thread, waiting to be swapped into AvailableMeshes
+    bool hasRescannedMeshes = false;
+    std::mutex rescannedMeshesMutex;
     std::vector<MeshInfos> GetAvailableMeshes();
-
-    std::shared_ptr<Object> FromJson_Object(const nlohmann::json& j);
-    std::shared_ptr<Mesh> FromJson_Mesh(const nlohmann::json& j);
-    std::shared_ptr<TriggerVolume> FromJson_TriggerVolume(const nlohmann::json& j);
-    std::shared_ptr<TriggerVolume_Box> FromJson_TriggerVolume_Box(const nlohmann::json& j);
-    std::shared_ptr<TriggerVolume_Cylinder> FromJson_TriggerVolume_Cylinder(const nlohmann::json& j);
-    std::shared_ptr<Checkpoint> FromJson_Checkpoint(const nlohmann::json& j);
-    std::shared_ptr<Ring> FromJson_Ring(const nlohmann::json& j);
+    void RescanMeshes();
+    void PollRescannedMeshes();
+    std::shared_ptr<MeshCatalogue> meshCatalogue;
 
 
 	//Boilerplate
@@ -78,29 +115,31 @@ class RingsMapEditor: public BakkesMod::Plugin::BakkesModPlugin
     void CheckCheckpoints();
     void CheckRings();
     void OnTick(ActorWrapper caller, void* params, std::string eventName);
-    void RenderTriggerVolumes(CanvasWrapper canvas);
-    void RenderCheckpoints(CanvasWrapper canvas);
-    void RenderRings(CanvasWrapper canvas);
+    void RenderOverlays(CanvasWrapper canvas);
+    void RenderCoursePath(CanvasWrapper canvas);
+    void RenderLabels(CanvasWrapper canvas);
 	void RenderTimer(CanvasWrapper canvas);
     void RenderCanvas(CanvasWrapper canvas);
 
 
     void DestroyAllMeshes();
     void AddObject(ObjectType _objectType);
-    void RemoveObject(const int& _objectIndex);
+    void RemoveObject(ObjectHandle _handle);
+    void TransformNamedObjects(const std::string& _nameQuery, const GroupTransform& _transform);
 
     bool IsInGame();
 
-    void RenderProperties_Object(std::shared_ptr<Object>& _object);
-	void RenderProperties_Mesh(Mesh& _mesh);
-    void RenderProperties_TriggerVolume(std::shared_ptr<TriggerVolume>& _volume);
-    void RenderProperties_TriggerVolume_Box(TriggerVolume_Box& _volume);
-    void RenderProperties_TriggerVolume_Cylinder(TriggerVolume_Cylinder& _volume);
-    void RenderProperties_Checkpoint(Checkpoint& _checkpoint);
-    void RenderProperties_Ring(std::shared_ptr<Ring>& _ring);
-    void RenderInputText(std::string _label, std::string* _value, ImGuiInputTextFlags _flags = 0);
-    void CopyObject(Object& _object);
+    bool RenderProperties_Object(std::shared_ptr<Object>& _object);
+	bool RenderProperties_Mesh(Mesh& _mesh);
+    bool RenderProperties_TriggerVolume(std::shared_ptr<TriggerVolume>& _volume);
+    bool RenderProperties_TriggerVolume_Box(TriggerVolume_Box& _volume);
+    bool RenderProperties_TriggerVolume_Cylinder(TriggerVolume_Cylinder& _volume);
+    bool RenderProperties_Checkpoint(Checkpoint& _checkpoint);
+    bool RenderProperties_Ring(std::shared_ptr<Ring>& _ring);
+    bool RenderInputText(std::string _label, std::string* _value, ImGuiInputTextFlags _flags = 0);
+    void CopyObject(ObjectHandle _handle);
     void RenderAddObjectPopup();
+    void RenderGroupTransformPopup(bool _searching);
     void RenderSaveConfigPopup();
     void RenderLoadConfigPopup();
 
@@ -2,6 +2,9 @@
 #include "RingsMapEditor.h"
 
 #include "CustomWidgets.hpp"
+#include "ObjectDiff.h"
+
+#include <bit>
 
 
 void RingsMapEditor::RenderSettings()
@@ -16,6 +19,8 @@ void RingsMapEditor::RenderSettings()
 
 void RingsMapEditor::RenderWindow()
 {
+	PollSaveResults();
+	PollRescannedMeshes();
 	RenderSaveConfigPopup();
 	RenderLoadConfigPopup();
 
@@ -28,6 +33,45 @@ void RingsMapEditor::RenderWindow()
 	{
 		ImGui::OpenPopup("Load Config");
 	}
+	ImGui::SameLine();
+	if (ImGui::Button("Undo", ImVec2(50.f, 20.f)))
+	{
+		gameWrapper->Execute([this](GameWrapper* gw) {
+			objectManager->Undo();
+			});
+	}
+	ImGui::SameLine();
+	if (ImGui::Button("Redo", ImVec2(50.f, 20.f)))
+	{
+		gameWrapper->Execute([this](GameWrapper* gw) {
+			objectManager->Redo();
+			});
+	}
+	if (ImGui::IsItemHovered())
+	{
+		const UndoStack& undoStack = objectManager->GetUndoStack();
+		ImGui::BeginTooltip();
+		ImGui::Text("%zu changes to undo, %zu to redo (%zu KB)", undoStack.GetUndoCount(), undoStack.GetRedoCount(), undoStack.GetMemoryUsage() / 1024);
+		ImGui::EndTooltip();
+	}
+	if (canRecoverAutosave)
+	{
+		ImGui::SameLine();
+		if (ImGui::Button("Recover Autosave", ImVec2(120.f, 20.f)))
+		{
+			gameWrapper->Execute([this](GameWrapper* gw) {
+				RecoverAutosave();
+				});
+		}
+		if (ImGui::IsItemHovered())
+		{
+			ImGui::BeginTooltip();
+			ImGui::Text("Replace the scene with the last state of the previous session");
+			ImGui::EndTooltip();
+		}
+	}
+	ImGui::SameLine();
+	ImGui::TextDisabled("%s", mapSaver->IsBusy() ? "Saving..." : saveStatus.c_str());
 
 	if (ImGui::Button("Start Editor Mode", ImVec2(120.f, 25.f)))
 	{
@@ -41,6 +85,44 @@ void RingsMapEditor::RenderWindow()
 		StartRaceMode();
 	}
 
+	int overlayBudget = overlayRenderer->GetBudget();
+	ImGui::SetNextItemWidth(120.f);
+	if (ImGui::DragInt("Overlay Budget", &overlayBudget, 1.f, 0, 4096))
+	{
+		cvarManager->getCvar("ringsmapeditor_overlay_budget").setValue(overlayBudget);
+	}
+	if (ImGui::IsItemHovered())
+	{
+		ImGui::BeginTooltip();
+		ImGui::Text("Max number of objects drawn with full wireframes per frame, the others are drawn as markers");
+		ImGui::EndTooltip();
+	}
+
+	ImGui::SameLine();
+
+	bool showCoursePath = coursePath->IsEnabled();
+	if (ImGui::Checkbox("Show Course Path", &showCoursePath))
+	{
+		coursePath->SetEnabled(showCoursePath);
+	}
+
+	ImGui::SameLine();
+
+	bool showLabels = labelLayer->IsEnabled();
+	if (ImGui::Checkbox("Show Labels", &showLabels))
+	{
+		labelLayer->SetEnabled(showLabels);
+	}
+
+	ImGui::SameLine();
+
+	if (ImGui::Button("Rescan Meshes"))
+	{
+		gameWrapper->Execute([this](GameWrapper* gw) {
+			RescanMeshes();
+			});
+	}
+
 	std::vector<std::shared_ptr<Object>>& objects = objectManager->GetObjects();
 
 	if (ImGui::BeginChild("##Objects", ImVec2(250, 0), true))
@@ -49,33 +131,64 @@ void RingsMapEditor::RenderWindow()
 		ImGui::Text("Objects");
 		ImGui::Separator();
 
-		for (int n = 0; n < objects.size(); n++)
+		ImGui::SetNextItemWidth(-1.f);
+		ImGui::InputTextWithHint("##Object Search", "Search", &objectSearch);
+		ImGui::SetNextItemWidth(140.f);
+		ImGui::Combo("##Object Search Type", &objectSearchType, "All types\0Meshes\0Trigger volumes\0Checkpoints\0Rings\0");
+		ImGui::SameLine();
+		ImGui::Checkbox("Prefix", &objectSearchPrefix);
+
+		//Results come from the name index, repeating the same search every frame is free
+		const bool searching = !objectSearch.empty() || objectSearchType != 0;
+		if (searching)
 		{
-			Object& object = *objects[n];
+			uint32_t typeMask = (objectSearchType == 0) ? AllObjectTypes : GetObjectTypeBit(static_cast<ObjectType>(objectSearchType));
+			objectManager->FindObjects(objectSearch, objectSearchPrefix ? NameMatch::Prefix : NameMatch::Substring, typeMask, objectSearchResults);
+		}
 
-			ImGui::PushID(n);
-			if (ImGui::Selectable(object.name.c_str(), (selectedObjectIndex == n)))
+		ImGuiListClipper clipper(searching ? static_cast<int>(objectSearchResults.size()) : static_cast<int>(objects.size()));
+		while (clipper.Step())
+		{
+			for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
 			{
-				selectedObjectIndex = n;
-			}
+				int n = searching ? objectManager->GetObjectIndex(objectSearchResults[row]) : row;
+				if (n < 0)
+					continue;
 
-			if (ImGui::BeginPopupContextItem(std::string(object.name + "Context Menu").c_str()))
-			{
-				if (ImGui::Selectable("Copy"))
+				Object& object = *objects[n];
+				ObjectHandle handle = objectManager->GetHandle(n);
+
+				ImGui::PushID(n);
+				if (ImGui::Selectable(object.name.c_str(), (selectedObject == handle)))
 				{
-					CopyObject(object);
+					selectedObject = handle;
 				}
 
-				if (ImGui::Selectable("Remove"))
+				if (ImGui::BeginPopupContextItem(std::string(object.name + "Context Menu").c_str()))
 				{
-					gameWrapper->Execute([this, n](GameWrapper* gw) {
-						RemoveObject(n);
-						});
+					if (ImGui::Selectable("Copy"))
+					{
+						CopyObject(handle);
+					}
+
+					if (ImGui::Selectable("Remove"))
+					{
+						gameWrapper->Execute([this, handle](GameWrapper* gw) {
+							RemoveObject(handle);
+							});
+					}
+
+					if (selectedObject.IsValid() && selectedObject != handle && ImGui::Selectable("Parent Selected Object Here"))
+					{
+						gameWrapper->Execute([this, child = selectedObject, handle](GameWrapper* gw) {
+							objectManager->SetParent(child, handle);
+							});
+					}
+					ImGui::EndPopup();
 				}
-				ImGui::EndPopup();
-			}
-			ImGui::PopID();
+				ImGui::PopID();
 
+			}
 		}
 
 		ImGui::Separator();
@@ -86,6 +199,12 @@ void RingsMapEditor::RenderWindow()
 		}
 		RenderAddObjectPopup();
 
+		if (ImGui::Button(searching ? "Transform Listed Objects" : "Transform All Objects", ImVec2(ImGui::GetContentRegionAvailWidth(), 20.f)))
+		{
+			ImGui::OpenPopup("Group Transform");
+		}
+		RenderGroupTransformPopup(searching);
+
 		ImGui::EndChild();
 	}
 
@@ -97,36 +216,70 @@ void RingsMapEditor::RenderWindow()
 		ImGui::Text("Object Details");
 		ImGui::Separator();
 
-		if (selectedObjectIndex < objects.size())
+		int selectedIndex = objectManager->GetObjectIndex(selectedObject);
+		if (selectedIndex >= 0)
 		{
-			RenderProperties_Object(objects[selectedObjectIndex]);
+			if (propertiesEdit.object != objects[selectedIndex])
+			{
+				CommitPropertiesEdit();
+				propertiesEdit = objectManager->BeginEdit(objects[selectedIndex]);
+			}
+
+			//The panel edits the object in place, its transform row is copied again on the next tick
+			if (RenderProperties_Object(objects[selectedIndex]))
+				objectManager->MarkTransformDirty(selectedObject);
+
+			//A drag is journaled once, when it's released
+			if (!ImGui::IsAnyItemActive())
+				CommitPropertiesEdit();
 		}
 
 		ImGui::EndChild();
 	}
 }
 
-void RingsMapEditor::RenderProperties_Object(std::shared_ptr<Object>& _object)
+bool RingsMapEditor::RenderProperties_Object(std::shared_ptr<Object>& _object)
 {
-	RenderInputText("Name", &_object->name);
+	bool edited = RenderInputText("Name", &_object->name);
+
+	//Set from the context menu of the object list
+	SceneGraph& sceneGraph = objectManager->GetSceneGraph();
+	std::shared_ptr<Object> parent = objectManager->FindObject(sceneGraph.GetParent(selectedObject));
+	if (parent)
+	{
+		ImGui::Text("Parent : %s", parent->name.c_str());
+		ImGui::SameLine();
+		if (ImGui::Button("Unparent"))
+		{
+			gameWrapper->Execute([this, handle = selectedObject](GameWrapper* gw) {
+				objectManager->SetParent(handle, ObjectHandle());
+				});
+		}
+	}
+
+	size_t childCount = sceneGraph.GetChildCount(selectedObject);
+	if (childCount > 0)
+	{
+		ImGui::Text("%d children, they follow this object", static_cast<int>(childCount));
+	}
 
 	ImGui::NewLine();
 
 	if (_object->objectType == ObjectType::Mesh)
 	{
-		RenderProperties_Mesh(*std::static_pointer_cast<Mesh>(_object));
+		edited |= RenderProperties_Mesh(*std::static_pointer_cast<Mesh>(_object));
 	}
 	else if (_object->objectType == ObjectType::TriggerVolume)
 	{
-		RenderProperties_TriggerVolume(reinterpret_cast<std::shared_ptr<TriggerVolume>&>(_object)); //passing it by reference
+		edited |= RenderProperties_TriggerVolume(reinterpret_cast<std::shared_ptr<TriggerVolume>&>(_object)); //passing it by reference
 	}
 	else if (_object->objectType == ObjectType::Checkpoint)
 	{
-		RenderProperties_Checkpoint(*std::static_pointer_cast<Checkpoint>(_object));
+		edited |= RenderProperties_Checkpoint(*std::static_pointer_cast<Checkpoint>(_object));
 	}
 	else if (_object->objectType == ObjectType::Ring)
 	{
-		RenderProperties_Ring(reinterpret_cast<std::shared_ptr<Ring>&>(_object));
+		edited |= RenderProperties_Ring(reinterpret_cast<std::shared_ptr<Ring>&>(_object));
 	}
 	else
 	{
@@ -138,21 +291,25 @@ void RingsMapEditor::RenderProperties_Object(std::shared_ptr<Object>& _object)
 
 	if (ImGui::Button("Copy"))
 	{
-		CopyObject(*_object);
+		CopyObject(selectedObject);
 	}
 
 	ImGui::SameLine();
 
 	if (ImGui::Button("Remove"))
 	{
-		gameWrapper->Execute([this](GameWrapper* gw) {
-			RemoveObject(selectedObjectIndex);
+		gameWrapper->Execute([this, handle = selectedObject](GameWrapper* gw) {
+			RemoveObject(handle);
 			});
 	}
+
+	return edited;
 }
 
-void RingsMapEditor::RenderProperties_Mesh(Mesh& _mesh)
+bool RingsMapEditor::RenderProperties_Mesh(Mesh& _mesh)
 {
+	bool edited = false;
+
 	ImGui::Text("Mesh");
 	ImGui::SameLine();
 	if (ImGui::BeginCombo("##Mesh", _mesh.meshInfos.name.c_str()))
@@ -160,6 +317,7 @@ void RingsMapEditor::RenderProperties_Mesh(Mesh& _mesh)
 		if (ImGui::Selectable("", (_mesh.meshInfos.name == "")))
 		{
 			_mesh.meshInfos = MeshInfos();
+			edited = true;
 		}
 
 		for (const auto& mesh : AvailableMeshes)
@@ -167,6 +325,7 @@ void RingsMapEditor::RenderProperties_Mesh(Mesh& _mesh)
 			if (ImGui::Selectable(mesh.name.c_str(), (_mesh.meshInfos.name == mesh.name)))
 			{
 				_mesh.meshInfos = mesh;
+				edited = true;
 			}
 		}
 		ImGui::EndCombo();
@@ -184,6 +343,7 @@ void RingsMapEditor::RenderProperties_Mesh(Mesh& _mesh)
 	ImGui::NewLine();
 	if (ImGui::DragFloat3("Location", &_mesh.location.X))
 	{
+		edited = true;
 		if (_mesh.instance)
 		{
 			gameWrapper->Execute([this, &_mesh](GameWrapper* gw) {
@@ -193,6 +353,7 @@ void RingsMapEditor::RenderProperties_Mesh(Mesh& _mesh)
 	}
 	if (ImGui::DragInt3("Rotation", &_mesh.rotation.Pitch))
 	{
+		edited = true;
 		if (_mesh.instance)
 		{
 			gameWrapper->Execute([this, &_mesh](GameWrapper* gw) {
@@ -202,6 +363,7 @@ void RingsMapEditor::RenderProperties_Mesh(Mesh& _mesh)
 	}
 	if (ImGui::DragFloat("Scale", &_mesh.scale, 0.01f, 0.01f, 100.0f))
 	{
+		edited = true;
 		if (_mesh.instance)
 		{
 			gameWrapper->Execute([this, &_mesh](GameWrapper* gw) {
@@ -273,6 +435,7 @@ void RingsMapEditor::RenderProperties_Mesh(Mesh& _mesh)
 	{
 		if (ImGui::Checkbox("Enable Collisions", &_mesh.enableCollisions))
 		{
+			edited = true;
 			gameWrapper->Execute([this, &_mesh](GameWrapper* gw) {
 				if (_mesh.enableCollisions)
 					_mesh.EnableCollisions();
@@ -283,6 +446,7 @@ void RingsMapEditor::RenderProperties_Mesh(Mesh& _mesh)
 
 		if (ImGui::Checkbox("Enable Physics", &_mesh.enablePhysics))
 		{
+			edited = true;
 			gameWrapper->Execute([this, &_mesh](GameWrapper* gw) {
 				if (_mesh.enablePhysics)
 					_mesh.EnablePhysics();
@@ -293,6 +457,7 @@ void RingsMapEditor::RenderProperties_Mesh(Mesh& _mesh)
 
 		if (ImGui::Checkbox("Enable Sticky Walls", &_mesh.enableStickyWalls))
 		{
+			edited = true;
 			gameWrapper->Execute([this, &_mesh](GameWrapper* gw) {
 				if (_mesh.enableStickyWalls)
 					_mesh.EnableStickyWalls();
@@ -307,10 +472,14 @@ void RingsMapEditor::RenderProperties_Mesh(Mesh& _mesh)
 			ImGui::EndTooltip();
 		}
 	}
+
+	return edited;
 }
 
-void RingsMapEditor::RenderProperties_TriggerVolume(std::shared_ptr<TriggerVolume>& _volume)
+bool RingsMapEditor::RenderProperties_TriggerVolume(std::shared_ptr<TriggerVolume>& _volume)
 {
+	bool edited = false;
+
 	ImGui::Text("Type");
 	ImGui::SameLine();
 	std::string selectedTriggerVolumeType = triggerVolumeTypesMap[_volume->triggerVolumeType];
@@ -324,6 +493,7 @@ void RingsMapEditor::RenderProperties_TriggerVolume(std::shared_ptr<TriggerVolum
 				if (!isSelected)
 				{
 					objectManager->ConvertTriggerVolume(_volume, type.first);
+					edited = true;
 				}
 			}
 		}
@@ -335,11 +505,13 @@ void RingsMapEditor::RenderProperties_TriggerVolume(std::shared_ptr<TriggerVolum
 
 	if (ImGui::DragFloat3("Location", &_volume->location.X))
 	{
+		edited = true;
 		_volume->SetLocation(_volume->location);
 	}
 
 	if (ImGui::DragInt3("Rotation", &_volume->rotation.Pitch))
 	{
+		edited = true;
 		_volume->SetRotation(_volume->rotation);
 	}
 
@@ -351,6 +523,7 @@ void RingsMapEditor::RenderProperties_TriggerVolume(std::shared_ptr<TriggerVolum
 			if (ImGui::Selectable(func.second->name.c_str()))
 			{
 				_volume->SetOnTouchCallback(func.second->Clone());
+				edited = true;
 			}
 		}
 
@@ -360,47 +533,49 @@ void RingsMapEditor::RenderProperties_TriggerVolume(std::shared_ptr<TriggerVolum
 	if (_volume->onTouchCallback)
 	{
 		_volume->onTouchCallback->RenderParameters();
+		//The parameters don't report their edits, the active widget does
+		edited |= ImGui::GetCurrentContext()->ActiveIdHasBeenEditedThisFrame;
 	}
 
 	ImGui::NewLine();
 
 	if (_volume->triggerVolumeType == TriggerVolumeType::Box)
-		RenderProperties_TriggerVolume_Box(*std::static_pointer_cast<TriggerVolume_Box>(_volume));
+		edited |= RenderProperties_TriggerVolume_Box(*std::static_pointer_cast<TriggerVolume_Box>(_volume));
 	else if (_volume->triggerVolumeType == TriggerVolumeType::Cylinder)
-		RenderProperties_TriggerVolume_Cylinder(*std::static_pointer_cast<TriggerVolume_Cylinder>(_volume));
+		edited |= RenderProperties_TriggerVolume_Cylinder(*std::static_pointer_cast<TriggerVolume_Cylinder>(_volume));
+
+	return edited;
 }
 
-void RingsMapEditor::RenderProperties_TriggerVolume_Box(TriggerVolume_Box& _volume)
+bool RingsMapEditor::RenderProperties_TriggerVolume_Box(TriggerVolume_Box& _volume)
 {
 	if (ImGui::DragFloat3("Size", &_volume.size.X, 1.f, 0.01f, 1000.0f))
 	{
 		_volume.SetSize(_volume.size);
+		return true;
 	}
+
+	return false;
 }
 
-void RingsMapEditor::RenderProperties_TriggerVolume_Cylinder(TriggerVolume_Cylinder& _volume)
+bool RingsMapEditor::RenderProperties_TriggerVolume_Cylinder(TriggerVolume_Cylinder& _volume)
 {
-	ImGui::DragFloat("Radius", &_volume.radius, 0.5f, 0.01f, 1000.0f);
-	ImGui::DragFloat("Height", &_volume.height, 0.5f, 0.01f, 1000.0f);
+	bool edited = ImGui::DragFloat("Radius", &_volume.radius, 0.5f, 0.01f, 1000.0f);
+	edited |= ImGui::DragFloat("Height", &_volume.height, 0.5f, 0.01f, 1000.0f);
+
+	return edited;
 }
 
-void RingsMapEditor::RenderProperties_Checkpoint(Checkpoint& _checkpoint)
+bool RingsMapEditor::RenderProperties_Checkpoint(Checkpoint& _checkpoint)
 {
-	static bool idAlreadyInUse = false;
 	ImGui::Text("ID");
 	ImGui::SameLine();
 	ImGui::SetNextItemWidth(100.f);
-	if (ImGui::InputInt("##ID", &_checkpoint.checkpointId, 0, 100))
-	{
-		auto it = std::find_if(checkpoints.begin(), checkpoints.end(),
-			[_checkpoint](const std::shared_ptr<Checkpoint>& checkpoint) {
-				return checkpoint->checkpointId == _checkpoint.checkpointId;
-			});
+	bool edited = ImGui::InputInt("##ID", &_checkpoint.checkpointId, 0, 100);
 
-		idAlreadyInUse = (it != checkpoints.end());
-	}
-
-	if (idAlreadyInUse)
+	//Ids are indexed, the checkpoint itself is only found there under the id it had before this edit
+	std::shared_ptr<Checkpoint> idHolder = objectManager->FindCheckpoint(_checkpoint.checkpointId);
+	if (idHolder && idHolder.get() != &_checkpoint)
 	{
 		ImGui::SameLine();
 		ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "ID already in use!");
@@ -416,6 +591,7 @@ void RingsMapEditor::RenderProperties_Checkpoint(Checkpoint& _checkpoint)
 			if (ImGui::Selectable(checkpointType.second.c_str(), (_checkpoint.checkpointType == checkpointType.first)))
 			{
 				_checkpoint.checkpointType = checkpointType.first;
+				edited = true;
 			}
 		}
 
@@ -426,41 +602,39 @@ void RingsMapEditor::RenderProperties_Checkpoint(Checkpoint& _checkpoint)
 
 	if (ImGui::DragFloat3("Location", &_checkpoint.location.X))
 	{
+		edited = true;
 		_checkpoint.SetLocation(_checkpoint.location);
 	}
 
 	if (ImGui::DragInt3("Rotation", &_checkpoint.rotation.Pitch))
 	{
+		edited = true;
 		_checkpoint.SetRotation(_checkpoint.rotation);
 	}
 
 	if (ImGui::DragFloat3("Size", &_checkpoint.triggerVolume.size.X, 1.f, 0.01f, 1000.0f))
 	{
+		edited = true;
 		_checkpoint.SetSize(_checkpoint.triggerVolume.size);
 	}
 
 	ImGui::NewLine();
 
-	ImGui::DragFloat3("Spawn Location", &_checkpoint.spawnLocation_offset.X);
-	ImGui::DragInt3("Spawn Rotation", &_checkpoint.spawnRotation.Pitch);
+	edited |= ImGui::DragFloat3("Spawn Location", &_checkpoint.spawnLocation_offset.X);
+	edited |= ImGui::DragInt3("Spawn Rotation", &_checkpoint.spawnRotation.Pitch);
+
+	return edited;
 }
 
-void RingsMapEditor::RenderProperties_Ring(std::shared_ptr<Ring>& _ring)
+bool RingsMapEditor::RenderProperties_Ring(std::shared_ptr<Ring>& _ring)
 {
 	ImGui::Text("ID");
 	ImGui::SameLine();
 	ImGui::SetNextItemWidth(100.f);
-	ImGui::InputInt("##ID", &_ring->ringId, 0, 100);
-
-	std::vector<std::shared_ptr<Ring>>& rings = objectManager->GetRings();
-
-	auto it = std::find_if(rings.begin(), rings.end(),
-		[&_ring](const std::shared_ptr<Ring>& ring) {
-			return ring != _ring && ring->ringId == _ring->ringId;
-		});
+	bool edited = ImGui::InputInt("##ID", &_ring->ringId, 0, 100);
 
-	bool ringIdAlreadyInUse = (it != rings.end());
-	if (ringIdAlreadyInUse)
+	std::shared_ptr<Ring> idHolder = objectManager->FindRing(_ring->ringId);
+	if (idHolder && idHolder != _ring)
 	{
 		ImGui::SameLine();
 		ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "ID already in use!");
@@ -468,6 +642,7 @@ void RingsMapEditor::RenderProperties_Ring(std::shared_ptr<Ring>& _ring)
 
 	if (ImGui::DragFloat3("Location", &_ring->location.X))
 	{
+		edited = true;
 		gameWrapper->Execute([this, &_ring](GameWrapper* gw) {
 			_ring->SetLocation(_ring->location);
 			});
@@ -475,6 +650,7 @@ void RingsMapEditor::RenderProperties_Ring(std::shared_ptr<Ring>& _ring)
 
 	if (ImGui::DragInt3("Rotation", &_ring->rotation.Pitch))
 	{
+		edited = true;
 		gameWrapper->Execute([this, &_ring](GameWrapper* gw) {
 			_ring->SetRotation(_ring->rotation);
 			});
@@ -482,44 +658,94 @@ void RingsMapEditor::RenderProperties_Ring(std::shared_ptr<Ring>& _ring)
 
 	ImGui::NewLine();
 
+	//Linking and unlinking are ring edits, undone like any other
+	if (_ring->prefab)
+	{
+		int overrideCount = std::popcount(PrefabLibrary::GetOverrides(*_ring));
+		ImGui::Text("Prefab : %s (%d overridden fields)", _ring->prefab->id.c_str(), overrideCount);
+
+		if (!_ring->prefab->builtIn)
+		{
+			if (ImGui::Button("Apply To Prefab"))
+			{
+				gameWrapper->Execute([this, ring = _ring](GameWrapper* gw) {
+					if (ring->prefab)
+						objectManager->UpdatePrefab(ring->prefab->id, *ring);
+					});
+			}
+			ImGui::SameLine();
+		}
+
+		if (ImGui::Button("Unlink"))
+		{
+			_ring->prefab = nullptr;
+			edited = true;
+		}
+	}
+	else
+	{
+		static std::string prefabName = "";
+		RenderInputText("Prefab Name", &prefabName);
+
+		bool prefabNameInUse = PrefabLibrary::Get().Find(prefabName) != nullptr;
+		if (prefabNameInUse)
+		{
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Name already in use!");
+		}
+		else if (!prefabName.empty() && ImGui::Button("Save As Prefab"))
+		{
+			//Edits made so far are committed first, the template is made from them
+			CommitPropertiesEdit();
+			gameWrapper->Execute([this, ring = _ring, id = prefabName](GameWrapper* gw) {
+				objectManager->SavePrefab(id, ring);
+				});
+		}
+	}
+
+	ImGui::NewLine();
+
+	//The parts may be shared with the prefab, the ring only gets its own copy once they are edited
+	RingParts parts = _ring->GetParts();
+	bool partsEdited = false;
+
 	ImGui::Text("Mesh");
 	ImGui::SameLine();
-	if (ImGui::BeginCombo("##Mesh", _ring->mesh.meshInfos.name.c_str()))
+	if (ImGui::BeginCombo("##Mesh", parts.mesh.meshInfos.name.c_str()))
 	{
-		if (ImGui::Selectable("", (_ring->mesh.meshInfos.name == "")))
+		if (ImGui::Selectable("", (parts.mesh.meshInfos.name == "")))
 		{
-			_ring->mesh.meshInfos = MeshInfos();
+			parts.mesh.meshInfos = MeshInfos();
+			partsEdited = true;
 		}
 
 		for (const auto& mesh : AvailableMeshes)
 		{
-			if (ImGui::Selectable(mesh.name.c_str(), (_ring->mesh.meshInfos.name == mesh.name)))
+			if (ImGui::Selectable(mesh.name.c_str(), (parts.mesh.meshInfos.name == mesh.name)))
 			{
-				_ring->mesh.meshInfos = mesh;
+				parts.mesh.meshInfos = mesh;
+				partsEdited = true;
 			}
 		}
 		ImGui::EndCombo();
 	}
 
 	//check if the mesh of the selected object exist in the available meshes
-	if (std::find_if(AvailableMeshes.begin(), AvailableMeshes.end(), [&](const MeshInfos& m) { return m.meshPath == _ring->mesh.meshInfos.meshPath; }) == AvailableMeshes.end())
+	if (std::find_if(AvailableMeshes.begin(), AvailableMeshes.end(), [&](const MeshInfos& m) { return m.meshPath == parts.mesh.meshInfos.meshPath; }) == AvailableMeshes.end())
 	{
 		ImGui::SameLine();
 		ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Mesh not found!");
 	}
 
-	RenderInputText("Mesh Path", &_ring->mesh.meshInfos.meshPath, ImGuiInputTextFlags_ReadOnly);
+	RenderInputText("Mesh Path", &parts.mesh.meshInfos.meshPath, ImGuiInputTextFlags_ReadOnly);
 
 	ImGui::NewLine();
 
 	ImGui::PushID("In Trigger Volume");
 	ImGui::Text("In Trigger Volume");
 
-	if(ImGui::DragFloat3("Location ##In Trigger Volume", &_ring->triggerVolumeIn_offset_location.X))
-	{
-		_ring->UpdateTriggerVolumes();
-	}
-	RenderProperties_TriggerVolume_Cylinder(_ring->triggerVolumeIn);
+	partsEdited |= ImGui::DragFloat3("Location ##In Trigger Volume", &parts.triggerVolumeIn_offset_location.X);
+	partsEdited |= RenderProperties_TriggerVolume_Cylinder(parts.triggerVolumeIn);
 	ImGui::PopID();
 
 	ImGui::NewLine();
@@ -527,16 +753,19 @@ void RingsMapEditor::RenderProperties_Ring(std::shared_ptr<Ring>& _ring)
 	ImGui::PushID("Out Trigger Volume");
 	ImGui::Text("Out Trigger Volume");
 
-	if (ImGui::DragFloat3("Location ##Out Trigger Volume", &_ring->triggerVolumeOut_offset_location.X))
+	partsEdited |= ImGui::DragFloat3("Location ##Out Trigger Volume", &parts.triggerVolumeOut_offset_location.X);
+	partsEdited |= RenderProperties_TriggerVolume_Box(parts.triggerVolumeOut);
+	ImGui::PopID();
+
+	if (partsEdited)
 	{
-		_ring->UpdateTriggerVolumes();
+		_ring->SetParts(std::move(parts));
+		edited = true;
 	}
-	RenderProperties_TriggerVolume_Box(_ring->triggerVolumeOut);
-	ImGui::PopID();
 
 	ImGui::NewLine();
 
-	bool CantSpawnObject = !IsInGame() || _ring->mesh.IsMeshPathEmpty() || _ring->mesh.IsSpawned();
+	bool CantSpawnObject = !IsInGame() || _ring->GetParts().mesh.IsMeshPathEmpty() || _ring->IsMeshSpawned();
 	std::string errorMessage = "";
 
 	if (CantSpawnObject)
@@ -547,15 +776,15 @@ void RingsMapEditor::RenderProperties_Ring(std::shared_ptr<Ring>& _ring)
 
 	if (!IsInGame())
 		errorMessage = "You must be in a game";
-	else if (_ring->mesh.IsMeshPathEmpty())
+	else if (_ring->GetParts().mesh.IsMeshPathEmpty())
 		errorMessage = "Object path is empty";
-	else if (_ring->mesh.IsSpawned())
+	else if (_ring->IsMeshSpawned())
 		errorMessage = "Object is already spawned";
 
 	if (ImGui::Button("Spawn Object"))
 	{
 		gameWrapper->Execute([this, &_ring](GameWrapper* gw) {
-			_ring->mesh.SpawnInstance();
+			_ring->SpawnMesh();
 			});
 	}
 
@@ -571,46 +800,75 @@ void RingsMapEditor::RenderProperties_Ring(std::shared_ptr<Ring>& _ring)
 			ImGui::EndTooltip();
 		}
 	}
+
+	return edited;
 }
 
-void RingsMapEditor::RenderInputText(std::string _label, std::string* _value, ImGuiInputTextFlags _flags)
+bool RingsMapEditor::RenderInputText(std::string _label, std::string* _value, ImGuiInputTextFlags _flags)
 {
 	ImGui::Text(_label.c_str());
 	ImGui::SameLine();
-	ImGui::InputText(std::string("##" + _label).c_str(), _value, _flags);
+	return ImGui::InputText(std::string("##" + _label).c_str(), _value, _flags);
 }
 
-void RingsMapEditor::CopyObject(Object& _object)
+void RingsMapEditor::CommitPropertiesEdit()
 {
-	objectManager->CopyObject(_object);
-	SelectLastObject();
+	if (!propertiesEdit.object || !propertiesEdit.before || ObjectDiff::Compare(*propertiesEdit.before, *propertiesEdit.object) == 0)
+		return;
+
+	//The object index is resolved on the game thread, so removes and undos can't reorder the scene between the undo command and the journal record
+	gameWrapper->Execute([this, edit = propertiesEdit](GameWrapper* gw) mutable {
+		objectManager->CommitEdit(edit);
+		});
+
+	propertiesEdit = objectManager->BeginEdit(propertiesEdit.object);
+}
+
+//Inserting may reallocate the object lists the render thread is reading, the copy is made on the game thread
+void RingsMapEditor::CopyObject(ObjectHandle _handle)
+{
+	gameWrapper->Execute([this, _handle](GameWrapper* gw) {
+		std::shared_ptr<Object> object = objectManager->FindObject(_handle);
+		if (!object)
+			return;
+
+		objectManager->CopyObject(*object);
+		SelectLastObject();
+		});
 }
 
 void RingsMapEditor::RenderAddObjectPopup()
 {
 	if (ImGui::BeginPopupModal("Add Object", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
 	{
+		//Added on the game thread, like a copy
+		auto addObject = [this](ObjectType _objectType) {
+			gameWrapper->Execute([this, _objectType](GameWrapper* gw) {
+				AddObject(_objectType);
+				});
+			};
+
 		if (ImGui::Button("Mesh", ImVec2(150.f, 40.f)))
 		{
-			AddObject(ObjectType::Mesh);
+			addObject(ObjectType::Mesh);
 			ImGui::CloseCurrentPopup();
 		}
 		ImGui::SameLine();
 		if (ImGui::Button("Trigger Volume", ImVec2(150.f, 40.f)))
 		{
-			AddObject(ObjectType::TriggerVolume);
+			addObject(ObjectType::TriggerVolume);
 			ImGui::CloseCurrentPopup();
 		}
 		ImGui::SameLine();
 		if (ImGui::Button("Checkpoint", ImVec2(150.f, 40.f)))
 		{
-			AddObject(ObjectType::Checkpoint);
+			addObject(ObjectType::Checkpoint);
 			ImGui::CloseCurrentPopup();
 		}
 		ImGui::SameLine();
 		if (ImGui::Button("Ring", ImVec2(150.f, 40.f)))
 		{
-			AddObject(ObjectType::Ring);
+			addObject(ObjectType::Ring);
 			ImGui::CloseCurrentPopup();
 		}
 
@@ -624,18 +882,69 @@ void RingsMapEditor::RenderAddObjectPopup()
 	}
 }
 
+//Moves the objects listed by the search, or every object, in one undoable step
+void RingsMapEditor::RenderGroupTransformPopup(bool _searching)
+{
+	if (ImGui::BeginPopupModal("Group Transform", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+	{
+		ImGui::Text("%d objects", static_cast<int>(_searching ? objectSearchResults.size() : objectManager->GetObjects().size()));
+
+		ImGui::DragFloat3("Translation", &groupTransform.translation.X);
+		ImGui::DragInt3("Rotation", &groupTransform.rotation.Pitch);
+		ImGui::DragFloat("Scale", &groupTransform.scale, 0.01f, 0.01f, 100.f);
+		ImGui::Checkbox("Pivot At Center", &groupTransform.pivotAtCenter);
+		if (!groupTransform.pivotAtCenter)
+		{
+			ImGui::DragFloat3("Pivot", &groupTransform.pivot.X);
+		}
+
+		if (ImGui::Button("Apply", ImVec2(100.f, 25.f)))
+		{
+			// An empty list stands for every object, gathered on the game thread where the scene can't change under it
+			std::vector<ObjectHandle> handles = _searching ? objectSearchResults : std::vector<ObjectHandle>();
+			gameWrapper->Execute([this, handles, transform = groupTransform, all = !_searching](GameWrapper* gw) mutable {
+				if (all)
+				{
+					objectManager->FindObjects("", NameMatch::Substring, AllObjectTypes, handles);
+				}
+				objectManager->TransformObjects(handles, transform);
+				});
+			ImGui::CloseCurrentPopup();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Reset", ImVec2(100.f, 25.f)))
+		{
+			groupTransform = GroupTransform();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Cancel", ImVec2(100.f, 25.f)))
+		{
+			ImGui::CloseCurrentPopup();
+		}
+
+		ImGui::EndPopup();
+	}
+}
+
 void RingsMapEditor::RenderSaveConfigPopup()
 {
 	if (ImGui::BeginPopupModal("Save Config", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
 	{
 		static std::string fileName = "";
+		static bool saveAsBinary = false;
 		RenderInputText("File Name", &fileName);
+		ImGui::Checkbox("Binary (.rme)", &saveAsBinary);
+		if (!saveAsBinary)
+		{
+			ImGui::SameLine();
+			ImGui::Checkbox("Compact JSON", &compactJson);
+		}
 
 		CustomWidget::CenterNexIMGUItItem(208.f);
 
 		if (ImGui::Button("Save", ImVec2(100.f, 25.f)))
 		{
-			if (SaveConfig(fileName))
+			if (SaveConfig(fileName, saveAsBinary ? MapFileFormat::Binary : MapFileFormat::Json))
 			{
 				ImGui::CloseCurrentPopup();
 			}
@@ -667,13 +976,21 @@ void RingsMapEditor::RenderLoadConfigPopup()
 			return;
 		}
 
+		ImGui::Checkbox("Keep unchanged objects", &reconcileOnLoad);
+		if (ImGui::IsItemHovered())
+		{
+			ImGui::BeginTooltip();
+			ImGui::Text("Only objects that differ from the current scene are updated, added or removed");
+			ImGui::EndTooltip();
+		}
+
 		ImGui::BeginChild("##Config List", ImVec2(200, 250), true);
 
 		for (const auto& entry : std::filesystem::directory_iterator(DataFolderPath))
 		{
-			if (entry.path().extension() == ".json")
+			if (entry.path().extension() == ".json" || BinaryMap::IsBinaryMap(entry.path()))
 			{
-				std::string fileName = entry.path().stem().string();
+				std::string fileName = BinaryMap::IsBinaryMap(entry.path()) ? entry.path().filename().string() : entry.path().stem().string();
 				if (ImGui::Selectable(fileName.c_str(), false, ImGuiSelectableFlags_AllowDoubleClick))
 				{
 					if (ImGui::IsMouseDoubleClicked(0))
@@ -0,0 +1,354 @@
+#include "pch.h"
+#include <algorithm>
+#include "SceneGraph.h"
+#include "RenderingTools/Extra/WrapperStructsExtensions.h"
+
+namespace
+{
+	Quat Conjugate(const Quat& _quat)
+	{
+		return Quat(_quat.W, -_quat.X, -_quat.Y, -_quat.Z);
+	}
+
+	bool SameLocation(const Vector& _a, const Vector& _b)
+	{
+		return _a.X == _b.X && _a.Y == _b.Y && _a.Z == _b.Z;
+	}
+
+	bool SameRotation(const Rotator& _a, const Rotator& _b)
+	{
+		return _a.Pitch == _b.Pitch && _a.Yaw == _b.Yaw && _a.Roll == _b.Roll;
+	}
+}
+
+
+
+SceneGraph::SceneGraph(SlotMap<std::shared_ptr<Object>>& _objects) : m_objects(_objects)
+{
+}
+
+bool SceneGraph::SetParent(SlotHandle _child, SlotHandle _parent)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	Object* childObject = GetObject(_child);
+	Object* parentObject = _parent.IsValid() ? GetObject(_parent) : nullptr;
+	if (!childObject || (_parent.IsValid() && !parentObject))
+	{
+		LOG("[ERROR]Tried to parent an object that isn't in the scene anymore");
+		return false;
+	}
+
+	for (const Node* ancestor = FindNode(_parent); ancestor; ancestor = FindNode(ancestor->parent))
+	{
+		if (ancestor->handle == _child)
+		{
+			LOG("[ERROR]{} can't be parented to {}, it's one of its children", childObject->name, parentObject->name);
+			return false;
+		}
+	}
+
+	if (_parent == _child)
+	{
+		LOG("[ERROR]{} can't be its own parent", childObject->name);
+		return false;
+	}
+
+	m_linksVersion++;
+
+	if (Node* child = FindNode(_child))
+	{
+		Detach(*child);
+		ReleaseNodeIfUnused(*child);
+	}
+
+	if (!parentObject)
+		return true;
+
+	// Acquiring may grow m_nodes, the parent is looked up again once both exist
+	AcquireNode(_parent, *parentObject);
+	Node& child = AcquireNode(_child, *childObject);
+	Node& parent = *FindNode(_parent);
+
+	child.parent = _parent;
+	parent.children.push_back(_child);
+
+	child.worldLocation = childObject->location;
+	child.worldRotation = childObject->rotation;
+	parent.worldLocation = parentObject->location;
+	parent.worldRotation = parentObject->rotation;
+	Bind(child, parent);
+	return true;
+}
+
+SlotHandle SceneGraph::GetParent(SlotHandle _handle) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const Node* node = FindNode(_handle);
+	return node ? node->parent : SlotHandle();
+}
+
+size_t SceneGraph::GetChildCount(SlotHandle _handle) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const Node* node = FindNode(_handle);
+	return node ? node->children.size() : 0;
+}
+
+void SceneGraph::GetSubtree(SlotHandle _root, std::vector<SlotHandle>& _outHandles) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const size_t first = _outHandles.size();
+	_outHandles.push_back(_root);
+
+	// Breadth first : the handles appended so far are the queue
+	for (size_t i = first; i < _outHandles.size(); i++)
+	{
+		if (const Node* node = FindNode(_outHandles[i]))
+			_outHandles.insert(_outHandles.end(), node->children.begin(), node->children.end());
+	}
+}
+
+void SceneGraph::GetChildren(SlotHandle _handle, std::vector<SlotHandle>& _outHandles) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (const Node* node = FindNode(_handle))
+		_outHandles.insert(_outHandles.end(), node->children.begin(), node->children.end());
+}
+
+void SceneGraph::GetParentIndices(std::vector<int32_t>& _outParents) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	_outParents.clear();
+	for (const Node& node : m_nodes)
+	{
+		if (!node.handle.IsValid() || !node.parent.IsValid())
+			continue;
+
+		const int childIndex = m_objects.GetIndex(node.handle);
+		const int parentIndex = m_objects.GetIndex(node.parent);
+		if (childIndex < 0 || parentIndex < 0)
+			continue;
+
+		if (_outParents.empty())
+			_outParents.resize(m_objects.Size(), -1);
+		_outParents[childIndex] = parentIndex;
+	}
+}
+
+uint64_t SceneGraph::GetLinksVersion() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_linksVersion;
+}
+
+void SceneGraph::OnRemoved(SlotHandle _handle)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	Node* node = FindNode(_handle);
+	if (!node)
+		return;
+
+	m_linksVersion++;
+	Detach(*node);
+
+	for (SlotHandle childHandle : node->children)
+	{
+		if (Node* child = FindNode(childHandle))
+		{
+			child->parent = SlotHandle();
+			ReleaseNodeIfUnused(*child);
+		}
+	}
+	node->children.clear();
+
+	ReleaseNodeIfUnused(*node);
+}
+
+void SceneGraph::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_nodes.clear();
+	m_moved.clear();
+	m_linksVersion++;
+}
+
+void SceneGraph::MarkMoved(SlotHandle _handle)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	MarkMovedLocked(_handle);
+}
+
+//A child marked before its parent would be bound to the transform its parent had before the move
+void SceneGraph::MarkMoved(const std::vector<SlotHandle>& _handles)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::vector<std::pair<size_t, SlotHandle>> byDepth;
+	byDepth.reserve(_handles.size());
+	for (SlotHandle handle : _handles)
+	{
+		size_t depth = 0;
+		for (const Node* node = FindNode(handle); node && node->parent.IsValid(); node = FindNode(node->parent))
+			depth++;
+		byDepth.emplace_back(depth, handle);
+	}
+
+	std::stable_sort(byDepth.begin(), byDepth.end(), [](const auto& _a, const auto& _b) { return _a.first < _b.first; });
+
+	for (const auto& [depth, handle] : byDepth)
+		MarkMovedLocked(handle);
+}
+
+void SceneGraph::MarkMovedLocked(SlotHandle _handle)
+{
+	Node* node = FindNode(_handle);
+	Object* object = node ? GetObject(_handle) : nullptr;
+	if (!object)
+		return;
+
+	if (SameLocation(object->location, node->worldLocation) && SameRotation(object->rotation, node->worldRotation))
+		return;
+
+	node->worldLocation = object->location;
+	node->worldRotation = object->rotation;
+	node->resolvePass = m_resolvePass + 1; // the next Resolve() doesn't move it back from its parent's transform
+
+	// Moved on its own : it stays where it was put relative to its parent
+	if (const Node* parent = FindNode(node->parent))
+		Bind(*node, *parent);
+
+	if (!node->children.empty())
+		m_moved.push_back(_handle);
+}
+
+//Every subtree is walked once per pass, even when an object and one of its ancestors were both moved
+void SceneGraph::Resolve(std::vector<SlotHandle>& _outMoved)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_moved.empty())
+		return;
+
+	m_resolvePass++;
+
+	std::vector<SlotHandle> parents;
+	for (SlotHandle moved : m_moved)
+	{
+		parents.push_back(moved);
+		while (!parents.empty())
+		{
+			const Node* parent = FindNode(parents.back());
+			parents.pop_back();
+			if (!parent)
+				continue;
+
+			const Quat parentRotation = RotatorToQuat(parent->worldRotation);
+			for (SlotHandle childHandle : parent->children)
+			{
+				Node* child = FindNode(childHandle);
+				Object* object = child ? GetObject(childHandle) : nullptr;
+				if (!object || child->resolvePass == m_resolvePass)
+					continue;
+
+				child->resolvePass = m_resolvePass;
+
+				Vector location = parent->worldLocation + RotateVectorWithQuat(child->localLocation, parentRotation);
+
+				// Translating a parent doesn't round its children's rotations through a quaternion
+				Rotator rotation = child->worldRotation;
+				if (!SameRotation(parent->worldRotation, child->parentRotation))
+				{
+					rotation = QuatToRotator(RT::MultiplyQuats(parentRotation, child->localRotation));
+					child->parentRotation = parent->worldRotation;
+				}
+
+				if (SameLocation(location, object->location) && SameRotation(rotation, object->rotation))
+					continue;
+
+				object->SetLocation(location);
+				object->SetRotation(rotation);
+				object->UpdateChildren();
+				child->worldLocation = location;
+				child->worldRotation = rotation;
+				_outMoved.push_back(childHandle);
+
+				if (!child->children.empty())
+					parents.push_back(childHandle);
+			}
+		}
+	}
+
+	m_moved.clear();
+}
+
+SceneGraph::Node* SceneGraph::FindNode(SlotHandle _handle)
+{
+	return (_handle.IsValid() && _handle.index < m_nodes.size() && m_nodes[_handle.index].handle == _handle) ? &m_nodes[_handle.index] : nullptr;
+}
+
+const SceneGraph::Node* SceneGraph::FindNode(SlotHandle _handle) const
+{
+	return (_handle.IsValid() && _handle.index < m_nodes.size() && m_nodes[_handle.index].handle == _handle) ? &m_nodes[_handle.index] : nullptr;
+}
+
+SceneGraph::Node& SceneGraph::AcquireNode(SlotHandle _handle, const Object& _object)
+{
+	if (Node* node = FindNode(_handle))
+		return *node;
+
+	if (_handle.index >= m_nodes.size())
+		m_nodes.resize(_handle.index + 1);
+
+	// A node left by a removed object in the same slot is reset
+	Node& node = m_nodes[_handle.index];
+	node = Node();
+	node.handle = _handle;
+	node.worldLocation = _object.location;
+	node.worldRotation = _object.rotation;
+	return node;
+}
+
+void SceneGraph::ReleaseNodeIfUnused(Node& _node)
+{
+	if (!_node.parent.IsValid() && _node.children.empty())
+		_node.handle = SlotHandle();
+}
+
+void SceneGraph::Detach(Node& _node)
+{
+	Node* parent = FindNode(_node.parent);
+	_node.parent = SlotHandle();
+	if (!parent)
+		return;
+
+	auto it = std::find(parent->children.begin(), parent->children.end(), _node.handle);
+	if (it != parent->children.end())
+		parent->children.erase(it);
+
+	ReleaseNodeIfUnused(*parent);
+}
+
+//Local transform of _child from both world transforms
+void SceneGraph::Bind(Node& _child, const Node& _parent)
+{
+	const Quat inverseParentRotation = Conjugate(RotatorToQuat(_parent.worldRotation));
+
+	_child.localLocation = RotateVectorWithQuat(_child.worldLocation - _parent.worldLocation, inverseParentRotation);
+	_child.localRotation = RT::MultiplyQuats(inverseParentRotation, RotatorToQuat(_child.worldRotation));
+	_child.parentRotation = _parent.worldRotation;
+}
+
+Object* SceneGraph::GetObject(SlotHandle _handle) const
+{
+	const std::shared_ptr<Object>* object = m_objects.Get(_handle);
+	return object ? object->get() : nullptr;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "Object.h"
+#include "SlotMap.h"
+
+#include <mutex>
+
+//Parent / child links between scene objects, any object can own any other (a group is an object with children).
+//A child keeps its transform relative to its parent, objects still hold their world transform in their own fields.
+//Moving an object only marks it, the world transforms under it are recomputed once per tick by Resolve(),
+//one quaternion per moved parent, and only the objects whose transform really changed are written to.
+class SceneGraph
+{
+public:
+	explicit SceneGraph(SlotMap<std::shared_ptr<Object>>& _objects);
+
+	// An invalid _parent detaches _child, which keeps its world transform either way. Fails if it would make a cycle
+	bool SetParent(SlotHandle _child, SlotHandle _parent);
+	SlotHandle GetParent(SlotHandle _handle) const;
+	size_t GetChildCount(SlotHandle _handle) const;
+	// Appends _root then every object under it, parents before their children
+	void GetSubtree(SlotHandle _root, std::vector<SlotHandle>& _outHandles) const;
+	// Appends the direct children of _handle
+	void GetChildren(SlotHandle _handle, std::vector<SlotHandle>& _outHandles) const;
+	// Replaces _outParents with the parent of every object as an index in the object list, -1 for none. Left empty when there are no links
+	void GetParentIndices(std::vector<int32_t>& _outParents) const;
+	// Changes whenever a link is made or broken, the parent indices only have to be read again then or when the object order changes
+	uint64_t GetLinksVersion() const;
+	// Children of a removed object are detached where they are
+	void OnRemoved(SlotHandle _handle);
+	void Clear();
+
+	// The world transform of the object may have been set directly, nothing happens if it didn't change
+	void MarkMoved(SlotHandle _handle);
+	// Same for objects moved together, parents are marked before their children whatever the order of _handles
+	void MarkMoved(const std::vector<SlotHandle>& _handles);
+	// Moves every object under the objects marked since the last call, appends the ones it moved to _outMoved
+	void Resolve(std::vector<SlotHandle>& _outMoved);
+
+private:
+	struct Node
+	{
+		SlotHandle handle; // invalid while the object has neither a parent nor children
+		SlotHandle parent;
+		std::vector<SlotHandle> children;
+		Vector localLocation;
+		Quat localRotation;
+		Vector worldLocation;  // last world transform seen or written by the graph
+		Rotator worldRotation;
+		Rotator parentRotation; // parent world rotation worldRotation was derived from
+		uint64_t resolvePass = 0;
+	};
+
+	Node* FindNode(SlotHandle _handle);
+	const Node* FindNode(SlotHandle _handle) const;
+	Node& AcquireNode(SlotHandle _handle, const Object& _object);
+	void ReleaseNodeIfUnused(Node& _node);
+	void Detach(Node& _node);
+	void Bind(Node& _child, const Node& _parent);
+	Object* GetObject(SlotHandle _handle) const;
+	void MarkMovedLocked(SlotHandle _handle);
+
+	SlotMap<std::shared_ptr<Object>>& m_objects;
+
+	mutable std::mutex m_mutex; // links are changed and resolved on the game thread, shown from the ImGui render thread
+
+	std::vector<Node> m_nodes; // indexed by slot index, the handle tells whether the node belongs to the current object
+	std::vector<SlotHandle> m_moved;
+	uint64_t m_resolvePass = 0;
+	uint64_t m_linksVersion = 0;
+};
@@ -0,0 +1,55 @@
+#include "pch.h"
+#include <algorithm>
+#include "SceneSnapshot.h"
+
+uint64_t SceneSnapshot::GetVersion() const
+{
+	return m_version;
+}
+
+size_t SceneSnapshot::Size() const
+{
+	return m_size;
+}
+
+const std::shared_ptr<Object>& SceneSnapshot::Get(size_t _objectIndex) const
+{
+	return (*m_chunks[_objectIndex / ChunkSize])[_objectIndex % ChunkSize];
+}
+
+void SceneSnapshot::GetObjects(std::vector<std::shared_ptr<Object>>& _outObjects) const
+{
+	_outObjects.clear();
+	_outObjects.reserve(m_size);
+	for (const std::shared_ptr<const Chunk>& chunk : m_chunks)
+	{
+		for (const std::shared_ptr<Object>& object : *chunk)
+		{
+			if (object)
+				_outObjects.push_back(object);
+		}
+	}
+}
+
+void SceneSnapshot::GetParents(std::vector<int32_t>& _outParents) const
+{
+	_outParents.clear();
+	if (!m_parents)
+		return;
+
+	// Objects that couldn't be copied are left out of GetObjects(), the ones after them move down
+	std::vector<int32_t> indices(m_size, -1);
+	int32_t index = 0;
+	for (size_t i = 0; i < m_size; i++)
+	{
+		if (Get(i))
+			indices[i] = index++;
+	}
+
+	_outParents.reserve(index);
+	for (size_t i = 0; i < m_size; i++)
+	{
+		if (indices[i] >= 0)
+			_outParents.push_back((*m_parents)[i] >= 0 ? indices[(*m_parents)[i]] : -1);
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "Object.h"
+
+//Immutable copy of the scene published by ObjectManager, readers on any thread hold it without locking.
+//Objects are detached copies (no actor) in the order of ObjectManager::GetObjects(), never edited once published.
+//They are stored in fixed size chunks shared between consecutive snapshots : publishing copies only the objects that
+//changed and the chunks holding them, every other chunk is the previous snapshot's.
+class SceneSnapshot
+{
+public:
+	static constexpr size_t ChunkSize = 64;
+
+	uint64_t GetVersion() const;
+	size_t Size() const;
+	// nullptr for an object of a type that can't be copied
+	const std::shared_ptr<Object>& Get(size_t _objectIndex) const;
+
+	// Replaces _outObjects with every object, for the map writers
+	void GetObjects(std::vector<std::shared_ptr<Object>>& _outObjects) const;
+	// Replaces _outParents with the parent of every object as an index in GetObjects(), -1 for none. Left empty when there are no links
+	void GetParents(std::vector<int32_t>& _outParents) const;
+
+private:
+	friend class ObjectManager;
+	using Chunk = std::vector<std::shared_ptr<Object>>;
+
+	uint64_t m_version = 0;
+	size_t m_size = 0;
+	std::vector<std::shared_ptr<const Chunk>> m_chunks;
+	std::shared_ptr<const std::vector<int32_t>> m_parents; // by object index, null without links
+};
@@ -0,0 +1,180 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//Slot index plus the generation the slot was in when the handle was made.
+//A handle to a removed value stays invalid, even once its slot is reused.
+struct SlotHandle
+{
+	static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+	uint32_t index = InvalidIndex;
+	uint32_t generation = 0;
+
+	bool IsValid() const { return index != InvalidIndex; }
+	bool operator==(const SlotHandle& _other) const = default;
+};
+
+//Values kept in one dense vector for iteration, addressed through generational handles.
+//Insert, Remove and Get are O(1) : a removal moves the last value into the freed place,
+//so the dense order is insertion order only until something is removed.
+//InsertAt and Erase keep the dense order instead, the values after the place move by one without any search.
+template <typename T>
+class SlotMap
+{
+public:
+	SlotHandle Insert(T _value)
+	{
+		uint32_t slotIndex = m_freeSlot;
+		if (slotIndex != SlotHandle::InvalidIndex)
+		{
+			m_freeSlot = m_slots[slotIndex].nextFree;
+		}
+		else
+		{
+			slotIndex = static_cast<uint32_t>(m_slots.size());
+			m_slots.push_back(Slot{});
+		}
+
+		Slot& slot = m_slots[slotIndex];
+		slot.denseIndex = static_cast<uint32_t>(m_values.size());
+		slot.nextFree = SlotHandle::InvalidIndex;
+
+		m_values.push_back(std::move(_value));
+		m_denseToSlot.push_back(slotIndex);
+
+		return SlotHandle{ slotIndex, slot.generation };
+	}
+
+	// Inserts at _index, the values from there move up one place. Past the end appends
+	SlotHandle InsertAt(T _value, size_t _index)
+	{
+		SlotHandle handle = Insert(std::move(_value));
+		const size_t lastIndex = m_values.size() - 1;
+		if (_index >= lastIndex)
+			return handle;
+
+		std::rotate(m_values.begin() + _index, m_values.begin() + lastIndex, m_values.end());
+		std::rotate(m_denseToSlot.begin() + _index, m_denseToSlot.begin() + lastIndex, m_denseToSlot.end());
+		for (size_t i = _index; i < m_denseToSlot.size(); i++)
+			m_slots[m_denseToSlot[i]].denseIndex = static_cast<uint32_t>(i);
+		return handle;
+	}
+
+	// Removes the value, the values after it move down one place
+	bool Erase(SlotHandle _handle)
+	{
+		if (!Contains(_handle))
+			return false;
+
+		const uint32_t denseIndex = m_slots[_handle.index].denseIndex;
+		m_values.erase(m_values.begin() + denseIndex);
+		m_denseToSlot.erase(m_denseToSlot.begin() + denseIndex);
+		for (size_t i = denseIndex; i < m_denseToSlot.size(); i++)
+			m_slots[m_denseToSlot[i]].denseIndex = static_cast<uint32_t>(i);
+
+		Release(_handle.index);
+		return true;
+	}
+
+	bool Remove(SlotHandle _handle)
+	{
+		if (!Contains(_handle))
+			return false;
+
+		const uint32_t denseIndex = m_slots[_handle.index].denseIndex;
+		const uint32_t lastIndex = static_cast<uint32_t>(m_values.size() - 1);
+		if (denseIndex != lastIndex)
+		{
+			m_values[denseIndex] = std::move(m_values[lastIndex]);
+			m_denseToSlot[denseIndex] = m_denseToSlot[lastIndex];
+			m_slots[m_denseToSlot[denseIndex]].denseIndex = denseIndex;
+		}
+		m_values.pop_back();
+		m_denseToSlot.pop_back();
+
+		Release(_handle.index);
+		return true;
+	}
+
+	// Exchanges the dense positions of two values, their handles stay valid
+	bool Swap(size_t _indexA, size_t _indexB)
+	{
+		if (_indexA >= m_values.size() || _indexB >= m_values.size())
+			return false;
+
+		std::swap(m_values[_indexA], m_values[_indexB]);
+		std::swap(m_denseToSlot[_indexA], m_denseToSlot[_indexB]);
+		m_slots[m_denseToSlot[_indexA]].denseIndex = static_cast<uint32_t>(_indexA);
+		m_slots[m_denseToSlot[_indexB]].denseIndex = static_cast<uint32_t>(_indexB);
+		return true;
+	}
+
+	// Every handle given out so far becomes invalid
+	void Clear()
+	{
+		for (uint32_t slotIndex : m_denseToSlot)
+			Release(slotIndex);
+
+		m_values.clear();
+		m_denseToSlot.clear();
+	}
+
+	void Reserve(size_t _capacity)
+	{
+		m_values.reserve(_capacity);
+		m_denseToSlot.reserve(_capacity);
+		m_slots.reserve(_capacity);
+	}
+
+	bool Contains(SlotHandle _handle) const
+	{
+		return _handle.index < m_slots.size() && m_slots[_handle.index].generation == _handle.generation
+			&& m_slots[_handle.index].denseIndex != SlotHandle::InvalidIndex;
+	}
+
+	T* Get(SlotHandle _handle) { return Contains(_handle) ? &m_values[m_slots[_handle.index].denseIndex] : nullptr; }
+	const T* Get(SlotHandle _handle) const { return Contains(_handle) ? &m_values[m_slots[_handle.index].denseIndex] : nullptr; }
+
+	// Position of the value in the dense vector, -1 for a stale handle
+	int GetIndex(SlotHandle _handle) const { return Contains(_handle) ? static_cast<int>(m_slots[_handle.index].denseIndex) : -1; }
+
+	SlotHandle GetHandle(size_t _index) const
+	{
+		if (_index >= m_denseToSlot.size())
+			return SlotHandle();
+
+		uint32_t slotIndex = m_denseToSlot[_index];
+		return SlotHandle{ slotIndex, m_slots[slotIndex].generation };
+	}
+
+	// Values can be modified or replaced in place, the map itself must only be changed through its insert, remove and swap functions
+	std::vector<T>& GetValues() { return m_values; }
+	const std::vector<T>& GetValues() const { return m_values; }
+	size_t Size() const { return m_values.size(); }
+	bool Empty() const { return m_values.empty(); }
+
+private:
+	struct Slot
+	{
+		uint32_t denseIndex = SlotHandle::InvalidIndex; // InvalidIndex while the slot is free
+		uint32_t generation = 0;
+		uint32_t nextFree = SlotHandle::InvalidIndex;
+	};
+
+	void Release(uint32_t _slotIndex)
+	{
+		Slot& slot = m_slots[_slotIndex];
+		slot.denseIndex = SlotHandle::InvalidIndex;
+		slot.generation++;
+		slot.nextFree = m_freeSlot;
+		m_freeSlot = _slotIndex;
+	}
+
+	std::vector<T> m_values;
+	std::vector<uint32_t> m_denseToSlot;
+	std::vector<Slot> m_slots;
+	uint32_t m_freeSlot = SlotHandle::InvalidIndex;
+};
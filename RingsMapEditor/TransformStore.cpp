@@ -0,0 +1,272 @@
+#include "pch.h"
+#include <algorithm>
+#include "TransformStore.h"
+#include "RenderingTools/Extra/WrapperStructsExtensions.h"
+
+namespace
+{
+	template <typename T>
+	void InsertRow(std::vector<T>& _column, size_t _row, T _value)
+	{
+		_column.insert(_column.begin() + _row, _value);
+	}
+
+	template <typename T>
+	void EraseRow(std::vector<T>& _column, size_t _row)
+	{
+		_column.erase(_column.begin() + _row);
+	}
+}
+
+
+
+void TransformStore::Append(const Object& _object)
+{
+	m_locationX.push_back(0.f);
+	m_locationY.push_back(0.f);
+	m_locationZ.push_back(0.f);
+	m_pitch.push_back(0);
+	m_yaw.push_back(0);
+	m_roll.push_back(0);
+	m_scale.push_back(1.f);
+	m_boundingRadius.push_back(0.f);
+	m_objectType.push_back(ObjectType::Unknown);
+
+	Write(m_locationX.size() - 1, _object);
+}
+
+void TransformStore::Update(size_t _row, const Object& _object)
+{
+	if (_row >= Size())
+	{
+		LOG("[ERROR]Transform row {} is out of range ({} rows)", _row, Size());
+		return;
+	}
+
+	Write(_row, _object);
+}
+
+void TransformStore::Insert(size_t _row, const Object& _object)
+{
+	if (_row >= Size())
+	{
+		Append(_object);
+		return;
+	}
+
+	InsertRow(m_locationX, _row, 0.f);
+	InsertRow(m_locationY, _row, 0.f);
+	InsertRow(m_locationZ, _row, 0.f);
+	InsertRow(m_pitch, _row, 0);
+	InsertRow(m_yaw, _row, 0);
+	InsertRow(m_roll, _row, 0);
+	InsertRow(m_scale, _row, 1.f);
+	InsertRow(m_boundingRadius, _row, 0.f);
+	InsertRow(m_objectType, _row, ObjectType::Unknown);
+
+	Write(_row, _object);
+}
+
+void TransformStore::Erase(size_t _row)
+{
+	if (_row >= Size())
+		return;
+
+	EraseRow(m_locationX, _row);
+	EraseRow(m_locationY, _row);
+	EraseRow(m_locationZ, _row);
+	EraseRow(m_pitch, _row);
+	EraseRow(m_yaw, _row);
+	EraseRow(m_roll, _row);
+	EraseRow(m_scale, _row);
+	EraseRow(m_boundingRadius, _row);
+	EraseRow(m_objectType, _row);
+}
+
+void TransformStore::Clear()
+{
+	m_locationX.clear();
+	m_locationY.clear();
+	m_locationZ.clear();
+	m_pitch.clear();
+	m_yaw.clear();
+	m_roll.clear();
+	m_scale.clear();
+	m_boundingRadius.clear();
+	m_objectType.clear();
+}
+
+void TransformStore::Reserve(size_t _capacity)
+{
+	m_locationX.reserve(_capacity);
+	m_locationY.reserve(_capacity);
+	m_locationZ.reserve(_capacity);
+	m_pitch.reserve(_capacity);
+	m_yaw.reserve(_capacity);
+	m_roll.reserve(_capacity);
+	m_scale.reserve(_capacity);
+	m_boundingRadius.reserve(_capacity);
+	m_objectType.reserve(_capacity);
+}
+
+size_t TransformStore::Size() const
+{
+	return m_locationX.size();
+}
+
+//Same test as RT::Frustum::IsInFrustum, one plane at a time over every row so the inner loop has no branch
+void TransformStore::FindInFrustum(const RT::Frustum& _frustum, std::vector<uint32_t>& _outRows) const
+{
+	const size_t count = Size();
+	const float* x = m_locationX.data();
+	const float* y = m_locationY.data();
+	const float* z = m_locationZ.data();
+	const float* radius = m_boundingRadius.data();
+
+	thread_local std::vector<uint8_t> inside;
+	inside.assign(count, 1);
+	uint8_t* mask = inside.data();
+
+	for (const RT::Plane& plane : _frustum.planes)
+	{
+		const Vector normal = plane.direction();
+		const float d = plane.d;
+
+		for (size_t i = 0; i < count; i++)
+			mask[i] &= static_cast<uint8_t>(x[i] * normal.X + y[i] * normal.Y + z[i] * normal.Z + d + radius[i] > 0.f);
+	}
+
+	CompactRows(inside, _outRows);
+}
+
+void TransformStore::FindContaining(const Vector& _point, std::vector<uint32_t>& _outRows) const
+{
+	const size_t count = Size();
+	const float* x = m_locationX.data();
+	const float* y = m_locationY.data();
+	const float* z = m_locationZ.data();
+	const float* radius = m_boundingRadius.data();
+
+	thread_local std::vector<uint8_t> inside;
+	inside.resize(count);
+	uint8_t* mask = inside.data();
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const float dx = x[i] - _point.X;
+		const float dy = y[i] - _point.Y;
+		const float dz = z[i] - _point.Z;
+		mask[i] = static_cast<uint8_t>(dx * dx + dy * dy + dz * dz <= radius[i] * radius[i]);
+	}
+
+	CompactRows(inside, _outRows);
+}
+
+//Locations go through one matrix built once from _rotation and _scale, the loop over the rows makes no call.
+//Rotations are only rebuilt through a quaternion when _rotation isn't zero, a translation keeps them exact
+void TransformStore::TransformRows(const std::vector<uint32_t>& _rows, const Vector& _pivot, float _scale, const Rotator& _rotation, const Vector& _translation)
+{
+	const bool rotated = _rotation.Pitch != 0 || _rotation.Yaw != 0 || _rotation.Roll != 0;
+	const Quat rotation = RotatorToQuat(_rotation);
+
+	// Columns of the matrix, taken from RotateVectorWithQuat so they follow its conventions
+	Vector axisX(_scale, 0.f, 0.f);
+	Vector axisY(0.f, _scale, 0.f);
+	Vector axisZ(0.f, 0.f, _scale);
+	if (rotated)
+	{
+		axisX = RotateVectorWithQuat(axisX, rotation);
+		axisY = RotateVectorWithQuat(axisY, rotation);
+		axisZ = RotateVectorWithQuat(axisZ, rotation);
+	}
+
+	// Without a rotation or a scale the pivot cancels out, leaving it out keeps translated locations exact
+	const Vector pivot = (rotated || _scale != 1.f) ? _pivot : Vector(0.f, 0.f, 0.f);
+	const Vector offset = pivot + _translation;
+
+	const size_t count = _rows.size();
+	const uint32_t* rows = _rows.data();
+	float* x = m_locationX.data();
+	float* y = m_locationY.data();
+	float* z = m_locationZ.data();
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const uint32_t row = rows[i];
+		const float localX = x[row] - pivot.X;
+		const float localY = y[row] - pivot.Y;
+		const float localZ = z[row] - pivot.Z;
+		x[row] = localX * axisX.X + localY * axisY.X + localZ * axisZ.X + offset.X;
+		y[row] = localX * axisX.Y + localY * axisY.Y + localZ * axisZ.Y + offset.Y;
+		z[row] = localX * axisX.Z + localY * axisY.Z + localZ * axisZ.Z + offset.Z;
+	}
+
+	if (_scale != 1.f)
+	{
+		for (size_t i = 0; i < count; i++)
+			m_scale[rows[i]] *= _scale;
+	}
+
+	if (!rotated)
+		return;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const uint32_t row = rows[i];
+		const Rotator newRotation = QuatToRotator(RT::MultiplyQuats(rotation, RotatorToQuat(GetRotation(row))));
+		m_pitch[row] = newRotation.Pitch;
+		m_yaw[row] = newRotation.Yaw;
+		m_roll[row] = newRotation.Roll;
+	}
+}
+
+Vector TransformStore::GetLocation(size_t _row) const
+{
+	return Vector(m_locationX[_row], m_locationY[_row], m_locationZ[_row]);
+}
+
+Rotator TransformStore::GetRotation(size_t _row) const
+{
+	return Rotator(m_pitch[_row], m_yaw[_row], m_roll[_row]);
+}
+
+float TransformStore::GetScale(size_t _row) const
+{
+	return m_scale[_row];
+}
+
+float TransformStore::GetBoundingRadius(size_t _row) const
+{
+	return m_boundingRadius[_row];
+}
+
+ObjectType TransformStore::GetObjectType(size_t _row) const
+{
+	return m_objectType[_row];
+}
+
+void TransformStore::Write(size_t _row, const Object& _object)
+{
+	Vector location = _object.GetLocation();
+	Rotator rotation = _object.GetRotation();
+
+	m_locationX[_row] = location.X;
+	m_locationY[_row] = location.Y;
+	m_locationZ[_row] = location.Z;
+	m_pitch[_row] = rotation.Pitch;
+	m_yaw[_row] = rotation.Yaw;
+	m_roll[_row] = rotation.Roll;
+	m_scale[_row] = _object.scale;
+	m_boundingRadius[_row] = _object.GetBoundingRadius();
+	m_objectType[_row] = _object.objectType;
+}
+
+void TransformStore::CompactRows(const std::vector<uint8_t>& _mask, std::vector<uint32_t>& _outRows)
+{
+	_outRows.clear();
+	for (size_t i = 0; i < _mask.size(); i++)
+	{
+		if (_mask[i])
+			_outRows.push_back(static_cast<uint32_t>(i));
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "Ring.h"
+
+//Transforms of the scene objects in structure-of-arrays form, row i is the object at index i in ObjectManager::GetObjects().
+//Objects keep their own fields for editing, ObjectManager copies them in here when an object is added or edited,
+//so bulk passes (culling, race checks) scan contiguous floats instead of following a pointer per object.
+class TransformStore
+{
+public:
+	void Append(const Object& _object);
+	// The rows from _row on move up one place, the same way SlotMap::InsertAt moves the objects
+	void Insert(size_t _row, const Object& _object);
+	void Update(size_t _row, const Object& _object);
+	// The rows after _row move down one place, the same way SlotMap::Erase moves the objects
+	void Erase(size_t _row);
+	void Clear();
+	void Reserve(size_t _capacity);
+	size_t Size() const;
+
+	// Replace _outRows with the rows whose bounding sphere is at least partly inside _frustum
+	void FindInFrustum(const RT::Frustum& _frustum, std::vector<uint32_t>& _outRows) const;
+	// Replace _outRows with the rows whose bounding sphere contains _point
+	void FindContaining(const Vector& _point, std::vector<uint32_t>& _outRows) const;
+
+	// Scales _rows by _scale and rotates them by _rotation about _pivot, then translates them by _translation.
+	// Their rotations and scales follow, bounding radii are left to Update()
+	void TransformRows(const std::vector<uint32_t>& _rows, const Vector& _pivot, float _scale, const Rotator& _rotation, const Vector& _translation);
+
+	Vector GetLocation(size_t _row) const;
+	Rotator GetRotation(size_t _row) const;
+	float GetScale(size_t _row) const;
+	float GetBoundingRadius(size_t _row) const;
+	ObjectType GetObjectType(size_t _row) const;
+
+private:
+	void Write(size_t _row, const Object& _object);
+	static void CompactRows(const std::vector<uint8_t>& _mask, std::vector<uint32_t>& _outRows);
+
+	std::vector<float> m_locationX;
+	std::vector<float> m_locationY;
+	std::vector<float> m_locationZ;
+	std::vector<int32_t> m_pitch;
+	std::vector<int32_t> m_yaw;
+	std::vector<int32_t> m_roll;
+	std::vector<float> m_scale;
+	std::vector<float> m_boundingRadius;
+	std::vector<ObjectType> m_objectType;
+};
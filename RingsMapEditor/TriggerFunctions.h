@@ -1,5 +1,6 @@
 #pragma once
 #include "Checkpoint.h"
+#include "JsonMapWriter.h"
 
 
 #define PARAMETERS_IMPL_VECTOR(class_name, parameter_vector, parameter_label) \
@@ -20,7 +21,7 @@ void RenderParameters() override { \
 
 #define TriggerFunction_Clone(class_name) \
 std::shared_ptr<TriggerFunction> Clone() override { \
-    return std::make_shared<class_name>(*this); \
+    return MakePooled<class_name>(*this); \
 } \
 
 class SetLocation : public TriggerFunction
@@ -49,11 +50,29 @@ public:
     TriggerFunction_Clone(SetLocation);
 
     std::shared_ptr<TriggerFunction> CloneFromJson(const nlohmann::json& j) override {
-        std::shared_ptr<SetLocation> cloned = std::make_shared<SetLocation>(*this);
+        std::shared_ptr<SetLocation> cloned = MakePooled<SetLocation>(*this);
         cloned->location = j["location"].get<Vector>();
         return cloned;
     }
 
+    void WriteParams(TriggerFunctionParams& _params) const override {
+        _params.floats[0] = location.X;
+        _params.floats[1] = location.Y;
+        _params.floats[2] = location.Z;
+    }
+
+    void ReadParams(const TriggerFunctionParams& _params) override {
+        location = Vector(_params.floats[0], _params.floats[1], _params.floats[2]);
+    }
+
+    void WriteJson(JsonMapWriter& _writer) const override {
+        _writer.BeginObject();
+        _writer.Field("description", description);
+        _writer.Field("location", location);
+        _writer.Field("name", name);
+        _writer.EndObject();
+    }
+
 private:
     Vector location;
 };
@@ -97,11 +116,29 @@ public:
     TriggerFunction_Clone(SetRotation);
 
     std::shared_ptr<TriggerFunction> CloneFromJson(const nlohmann::json& j) override {
-        std::shared_ptr<SetRotation> cloned = std::make_shared<SetRotation>(*this);
+        std::shared_ptr<SetRotation> cloned = MakePooled<SetRotation>(*this);
         cloned->rotation = j["rotation"].get<Rotator>();
         return cloned;
     }
 
+    void WriteParams(TriggerFunctionParams& _params) const override {
+        _params.ints[0] = rotation.Pitch;
+        _params.ints[1] = rotation.Yaw;
+        _params.ints[2] = rotation.Roll;
+    }
+
+    void ReadParams(const TriggerFunctionParams& _params) override {
+        rotation = Rotator(_params.ints[0], _params.ints[1], _params.ints[2]);
+    }
+
+    void WriteJson(JsonMapWriter& _writer) const override {
+        _writer.BeginObject();
+        _writer.Field("description", description);
+        _writer.Field("name", name);
+        _writer.Field("rotation", rotation);
+        _writer.EndObject();
+    }
+
 private:
     Rotator rotation;
 };
@@ -133,14 +170,15 @@ public:
     TriggerFunction_Clone(Destroy);
 
     std::shared_ptr<TriggerFunction> CloneFromJson(const nlohmann::json& j) override {
-        return std::make_shared<Destroy>(*this);
+        return MakePooled<Destroy>(*this);
     }
 
 private:
 };
 
-inline std::vector<std::shared_ptr<Checkpoint>> checkpoints;
 inline std::shared_ptr<Checkpoint> currentCheckpoint = nullptr;
+// Checkpoint with the given id or nullptr, set by ObjectManager which keeps them indexed by id
+inline std::function<std::shared_ptr<Checkpoint>(int)> findCheckpoint;
 
 class TeleportToCheckpoint : public TriggerFunction
 {
@@ -161,20 +199,13 @@ public:
         }
         else
         {
-            std::shared_ptr<Checkpoint> checkpoint = nullptr;
-
-            auto it = std::find_if(checkpoints.begin(), checkpoints.end(),
-                [this](const std::shared_ptr<Checkpoint>& checkpoint) {
-                    return checkpoint->checkpointId == checkpointId;
-                });
-
-            if (it == checkpoints.end())
+            std::shared_ptr<Checkpoint> checkpoint = findCheckpoint ? findCheckpoint(checkpointId) : nullptr;
+            if (!checkpoint)
             {
                 LOG("[ERROR] Invalid checkpoint ID: {}", checkpointId);
                 return;
             }
 
-            checkpoint = *it;
             actor.SetLocation(checkpoint->GetSpawnWorldLocation());
             actor.SetRotation(checkpoint->spawnRotation);
             actor.SetVelocity(Vector(0.f, 0.f, 0.f));
@@ -204,12 +235,31 @@ public:
     TriggerFunction_Clone(TeleportToCheckpoint);
 
     std::shared_ptr<TriggerFunction> CloneFromJson(const nlohmann::json& j) override {
-        std::shared_ptr<TeleportToCheckpoint> cloned = std::make_shared<TeleportToCheckpoint>(*this);
+        std::shared_ptr<TeleportToCheckpoint> cloned = MakePooled<TeleportToCheckpoint>(*this);
         cloned->useCurrentCheckpoint = j["useCurrentCheckpoint"].get<bool>();
         cloned->checkpointId = j["checkpointId"].get<int>();
         return cloned;
     }
 
+    void WriteParams(TriggerFunctionParams& _params) const override {
+        _params.flag = useCurrentCheckpoint;
+        _params.ints[0] = checkpointId;
+    }
+
+    void ReadParams(const TriggerFunctionParams& _params) override {
+        useCurrentCheckpoint = _params.flag;
+        checkpointId = _params.ints[0];
+    }
+
+    void WriteJson(JsonMapWriter& _writer) const override {
+        _writer.BeginObject();
+        _writer.Field("checkpointId", checkpointId);
+        _writer.Field("description", description);
+        _writer.Field("name", name);
+        _writer.Field("useCurrentCheckpoint", useCurrentCheckpoint);
+        _writer.EndObject();
+    }
+
 private:
 	bool useCurrentCheckpoint = false; // Use current checkpoint if true, otherwise use checkpointId
     int checkpointId = 0;
@@ -11,6 +11,16 @@
 #define max(a,b)            (((a) > (b)) ? (a) : (b))
 #define min(a,b)            (((a) < (b)) ? (a) : (b))
 
+class JsonMapWriter;
+
+// Flat parameter block used by fixed-size serializers (see BinaryMap). Each function picks the slots it needs
+struct TriggerFunctionParams
+{
+    float floats[3] = { 0.f, 0.f, 0.f };
+    int32_t ints[3] = { 0, 0, 0 };
+    bool flag = false;
+};
+
 class TriggerFunction
 {
 public:
@@ -24,10 +34,20 @@ public:
     virtual std::shared_ptr<TriggerFunction> Clone() = 0;
     virtual std::shared_ptr<TriggerFunction> CloneFromJson(const nlohmann::json& j) = 0;
 
+    virtual void WriteParams(TriggerFunctionParams& _params) const {}
+    virtual void ReadParams(const TriggerFunctionParams& _params) {}
+    virtual void WriteJson(JsonMapWriter& _writer) const; // Streaming to_json(), keys in alphabetical order
+
     std::string name;
     std::string description;
 };
 
+// Copies of an object get their own callback, a null one stays null
+inline std::shared_ptr<TriggerFunction> CloneCallback(const std::shared_ptr<TriggerFunction>& _callback)
+{
+    return _callback ? _callback->Clone() : nullptr;
+}
+
 enum class TriggerVolumeType : uint8_t
 {
     Unknown = 0,
@@ -65,9 +85,13 @@ public:
 
     virtual bool IsPointInside(const Vector& point) const = 0;
     virtual bool RayIntersects(const Vector& rayOrigin, const Vector& rayDir, float maxDist, float& tHit) const = 0;
-    virtual void Render(CanvasWrapper canvas, CameraWrapper camera) = 0;
+    virtual void Render(CanvasWrapper canvas, RT::Frustum& frustum) = 0;
+
+    void Render(CanvasWrapper canvas, CameraWrapper camera) {
+        RT::Frustum frustum(canvas, camera);
+        Render(canvas, frustum);
+    }
 
-    virtual nlohmann::json to_json() const override = 0;
     virtual std::shared_ptr<Object> Clone() override = 0;
 
     TriggerVolumeType triggerVolumeType = TriggerVolumeType::Unknown;
@@ -158,7 +182,12 @@ public:
 
     // Check if a point is inside the box
     bool IsPointInside(const Vector& point) const override {
-        RT::Box box(location, RotatorToQuat(rotation), size, 1.f);
+        return IsPointInside(point, location, rotation);
+    }
+
+    // Same test with the box placed at _location / _rotation instead of its own transform (see Ring)
+    bool IsPointInside(const Vector& point, const Vector& _location, const Rotator& _rotation) const {
+        RT::Box box(_location, RotatorToQuat(_rotation), size, 1.f);
         return box.IsInBox(point);
     }
 
@@ -235,34 +264,23 @@ public:
         return false;
     }
 
-    void Render(CanvasWrapper canvas, CameraWrapper camera) override {
-        RT::Frustum frustum(canvas, camera);
-        canvas.SetColor(255, 255, 255, 255);
-        RT::Box box(location, RotatorToQuat(rotation), size, 1.f);
-        box.Draw(canvas, frustum);
+    float GetBoundingRadius() const override {
+        return (size * 0.5f).magnitude();
     }
 
-    nlohmann::json to_json() const override {
-        nlohmann::json triggerVolumeBoxJson{
-            {"objectType", static_cast<uint8_t>(objectType)},
-            {"name", name},
-            {"location", location},
-            {"rotation", rotation},
-            {"scale", scale},
-            {"triggerVolumeType", static_cast<uint8_t>(triggerVolumeType)},
-            {"size", size}
-        };
-
-        if (onTouchCallback)
-            triggerVolumeBoxJson["onTouchCallback"] = onTouchCallback->to_json();
-        else
-            triggerVolumeBoxJson["onTouchCallback"] = nullptr;
+    using TriggerVolume::Render;
+    void Render(CanvasWrapper canvas, RT::Frustum& frustum) override {
+        Render(canvas, frustum, location, rotation);
+    }
 
-        return triggerVolumeBoxJson;
+    void Render(CanvasWrapper canvas, RT::Frustum& frustum, const Vector& _location, const Rotator& _rotation) const {
+        canvas.SetColor(255, 255, 255, 255);
+        RT::Box box(_location, RotatorToQuat(_rotation), size, 1.f);
+        box.Draw(canvas, frustum);
     }
 
     std::shared_ptr<Object> Clone() override {
-        std::shared_ptr<TriggerVolume_Box> clonedVolume = std::make_shared<TriggerVolume_Box>(*this);
+        std::shared_ptr<TriggerVolume_Box> clonedVolume = MakePooled<TriggerVolume_Box>(*this);
         clonedVolume->onTouchCallback = (onTouchCallback ? onTouchCallback->Clone() : nullptr);
         return clonedVolume;
     }
@@ -322,7 +340,12 @@ public:
     ~TriggerVolume_Cylinder() {}
 
     bool IsPointInside(const Vector& point) const override {
-        RT::Cylinder cylinder(location, RotatorToQuat(rotation), radius, height);
+        return IsPointInside(point, location, rotation);
+    }
+
+    // Same test with the cylinder placed at _location / _rotation instead of its own transform (see Ring)
+    bool IsPointInside(const Vector& point, const Vector& _location, const Rotator& _rotation) const {
+        RT::Cylinder cylinder(_location, RotatorToQuat(_rotation), radius, height);
         return cylinder.IsInCylinder(point);
     }
 
@@ -419,35 +442,24 @@ public:
         return false;
     }
 
-    void Render(CanvasWrapper canvas, CameraWrapper camera) override {
-        RT::Frustum frustum(canvas, camera);
-        canvas.SetColor(255, 255, 255, 255);
-        RT::Cylinder cylinder(location, RotatorToQuat(rotation), radius, height);
-        cylinder.Draw(canvas, frustum);
+    float GetBoundingRadius() const override {
+        float halfHeight = height * 0.5f;
+        return sqrtf(radius * radius + halfHeight * halfHeight);
     }
 
-    nlohmann::json to_json() const override {
-        nlohmann::json triggerVolumeBoxJson{
-            {"objectType", static_cast<uint8_t>(objectType)},
-            {"name", name},
-            {"location", location},
-            {"rotation", rotation},
-            {"scale", scale},
-            {"triggerVolumeType", static_cast<uint8_t>(triggerVolumeType)},
-            {"radius", radius},
-            {"height", height}
-        };
-
-        if (onTouchCallback)
-            triggerVolumeBoxJson["onTouchCallback"] = onTouchCallback->to_json();
-        else
-            triggerVolumeBoxJson["onTouchCallback"] = nullptr;
+    using TriggerVolume::Render;
+    void Render(CanvasWrapper canvas, RT::Frustum& frustum) override {
+        Render(canvas, frustum, location, rotation);
+    }
 
-        return triggerVolumeBoxJson;
+    void Render(CanvasWrapper canvas, RT::Frustum& frustum, const Vector& _location, const Rotator& _rotation) const {
+        canvas.SetColor(255, 255, 255, 255);
+        RT::Cylinder cylinder(_location, RotatorToQuat(_rotation), radius, height);
+        cylinder.Draw(canvas, frustum);
     }
 
     std::shared_ptr<Object> Clone() override {
-        std::shared_ptr<TriggerVolume_Cylinder> clonedVolume = std::make_shared<TriggerVolume_Cylinder>(*this);
+        std::shared_ptr<TriggerVolume_Cylinder> clonedVolume = MakePooled<TriggerVolume_Cylinder>(*this);
         clonedVolume->onTouchCallback = (onTouchCallback ? onTouchCallback->Clone() : nullptr);
         return clonedVolume;
     }
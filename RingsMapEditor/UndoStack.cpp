@@ -0,0 +1,174 @@
+#include "pch.h"
+#include <algorithm>
+#include "UndoStack.h"
+
+namespace
+{
+	// Rough footprint of a detached object, its fields aren't walked just to be measured
+	constexpr size_t DetachedObjectSize = 512;
+}
+
+
+
+bool ObjectTransform::operator==(const ObjectTransform& _other) const
+{
+	return location.X == _other.location.X && location.Y == _other.location.Y && location.Z == _other.location.Z
+		&& rotation.Pitch == _other.rotation.Pitch && rotation.Yaw == _other.rotation.Yaw && rotation.Roll == _other.rotation.Roll
+		&& scale == _other.scale;
+}
+
+size_t UndoCommand::GetMemoryUsage() const
+{
+	return sizeof(UndoCommand) + before.capacity() + after.capacity() + (detached ? DetachedObjectSize : 0)
+		+ (objectIndices.capacity() + childIndices.capacity()) * sizeof(uint32_t) + (transformsBefore.capacity() + transformsAfter.capacity()) * sizeof(ObjectTransform);
+}
+
+UndoStack::UndoStack(size_t _memoryCap) : m_memoryCap(_memoryCap)
+{
+}
+
+void UndoStack::Push(UndoCommand&& _command)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// An edit made right after an undo starts a new command
+	const bool undone = !m_redo.empty();
+	for (const UndoCommand& command : m_redo)
+		m_memoryUsage -= command.GetMemoryUsage();
+	m_redo.clear();
+
+	if (!undone && TryMerge(_command))
+		return;
+
+	m_memoryUsage += _command.GetMemoryUsage();
+	m_undo.push_back(std::move(_command));
+	Trim();
+}
+
+bool UndoStack::PopUndo(UndoCommand& _outCommand)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_undo.empty())
+		return false;
+
+	_outCommand = std::move(m_undo.back());
+	m_undo.pop_back();
+	m_memoryUsage -= _outCommand.GetMemoryUsage();
+	return true;
+}
+
+bool UndoStack::PopRedo(UndoCommand& _outCommand)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_redo.empty())
+		return false;
+
+	_outCommand = std::move(m_redo.back());
+	m_redo.pop_back();
+	m_memoryUsage -= _outCommand.GetMemoryUsage();
+	return true;
+}
+
+void UndoStack::PushUndo(UndoCommand&& _command)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_memoryUsage += _command.GetMemoryUsage();
+	m_undo.push_back(std::move(_command));
+	Trim();
+}
+
+void UndoStack::PushRedo(UndoCommand&& _command)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_memoryUsage += _command.GetMemoryUsage();
+	m_redo.push_back(std::move(_command));
+	Trim();
+}
+
+void UndoStack::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_undo.clear();
+	m_redo.clear();
+	m_memoryUsage = 0;
+}
+
+void UndoStack::SetMemoryCap(size_t _memoryCap)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_memoryCap = _memoryCap;
+	Trim();
+}
+
+size_t UndoStack::GetMemoryCap() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_memoryCap;
+}
+
+size_t UndoStack::GetMemoryUsage() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_memoryUsage;
+}
+
+size_t UndoStack::GetUndoCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_undo.size();
+}
+
+size_t UndoStack::GetRedoCount() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_redo.size();
+}
+
+//An edit of the same fields of the same object (or a transform of the same objects) shortly after the previous one extends it : the first before, the last after
+bool UndoStack::TryMerge(UndoCommand& _command)
+{
+	if ((_command.op != UndoOp::Edit && _command.op != UndoOp::Transform) || m_undo.empty())
+		return false;
+
+	UndoCommand& last = m_undo.back();
+	if (last.op != _command.op || last.objectIndex != _command.objectIndex || last.fieldMask != _command.fieldMask
+		|| last.objectIndices != _command.objectIndices || _command.time - last.time > MergeWindow)
+		return false;
+
+	m_memoryUsage -= last.GetMemoryUsage();
+
+	// Edited back to where it started, nothing left to undo
+	if (last.before == _command.after && last.transformsBefore == _command.transformsAfter)
+	{
+		m_undo.pop_back();
+		return true;
+	}
+
+	last.after = std::move(_command.after);
+	last.transformsAfter = std::move(_command.transformsAfter);
+	last.time = _command.time;
+	m_memoryUsage += last.GetMemoryUsage();
+	return true;
+}
+
+//Called with m_mutex held, the most recent command is always kept
+void UndoStack::Trim()
+{
+	while (m_memoryUsage > m_memoryCap && m_undo.size() > 1)
+	{
+		m_memoryUsage -= m_undo.front().GetMemoryUsage();
+		m_undo.pop_front();
+	}
+
+	while (m_memoryUsage > m_memoryCap && !m_redo.empty())
+	{
+		m_memoryUsage -= m_redo.front().GetMemoryUsage();
+		m_redo.pop_front();
+	}
+}
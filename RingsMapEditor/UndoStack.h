@@ -0,0 +1,84 @@
+#pragma once
+#include "Object.h"
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+enum class UndoOp : uint8_t
+{
+	Add = 1,     // detached : the added object while it's undone, copies are recorded as adds
+	Remove = 2,  // detached : the removed object while it's removed
+	Edit = 3,    // before / after : ObjectDiff of the fields in fieldMask
+	Convert = 4, // detached : the trigger volume that isn't in the scene right now
+	Transform = 5 // objectIndices, transformsBefore / transformsAfter : objects moved together by ObjectManager::TransformObjects
+};
+
+//What a group transform changes on each object
+struct ObjectTransform
+{
+	Vector location;
+	Rotator rotation;
+	float scale = 1.f;
+
+	bool operator==(const ObjectTransform& _other) const;
+};
+
+//One undoable change, as small as the change itself.
+//objectIndex is the index in ObjectManager::m_objects when the change was made : undo and redo are strictly last in first out,
+//so the scene is back in that exact order whenever the command is applied.
+struct UndoCommand
+{
+	UndoOp op = UndoOp::Edit;
+	uint32_t objectIndex = 0;
+	uint32_t typedIndex = 0; // Remove : index in the slot map of the object's type
+	uint64_t fieldMask = 0;
+	std::vector<uint8_t> before;
+	std::vector<uint8_t> after;
+	std::shared_ptr<Object> detached; // kept alive instead of encoded, its mesh actor is destroyed while it's out of the scene
+	int32_t parentIndex = -1;            // Add / Remove : links the detached object had, made again when it's back in the scene
+	std::vector<uint32_t> childIndices;
+	std::vector<uint32_t> objectIndices; // Transform : sorted, objectIndex is the first of them
+	std::vector<ObjectTransform> transformsBefore;
+	std::vector<ObjectTransform> transformsAfter;
+	std::chrono::steady_clock::time_point time;
+
+	size_t GetMemoryUsage() const;
+};
+
+//Undo and redo stacks of UndoCommands, ObjectManager records and applies them.
+//Consecutive edits of the same fields of an object (or transforms of the same group) are merged into one command, so holding a button or
+//clicking a step button several times is undone at once. Past the memory cap the oldest commands are dropped,
+//then the redo commands furthest from the current state.
+class UndoStack
+{
+public:
+	UndoStack(size_t _memoryCap = 16 * 1024 * 1024);
+
+	// Clears the redo stack
+	void Push(UndoCommand&& _command);
+
+	bool PopUndo(UndoCommand& _outCommand);
+	bool PopRedo(UndoCommand& _outCommand);
+	void PushUndo(UndoCommand&& _command); // after a redo, keeps the redo stack
+	void PushRedo(UndoCommand&& _command); // after an undo
+	void Clear();
+
+	void SetMemoryCap(size_t _memoryCap);
+	size_t GetMemoryCap() const;
+	size_t GetMemoryUsage() const;
+	size_t GetUndoCount() const;
+	size_t GetRedoCount() const;
+
+private:
+	bool TryMerge(UndoCommand& _command);
+	void Trim();
+
+	static constexpr std::chrono::milliseconds MergeWindow = std::chrono::milliseconds(750);
+
+	mutable std::mutex m_mutex; // recorded from the ImGui render thread, applied on the game thread
+	std::deque<UndoCommand> m_undo;
+	std::deque<UndoCommand> m_redo;
+	size_t m_memoryUsage = 0;
+	size_t m_memoryCap;
+};